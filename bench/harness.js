@@ -0,0 +1,75 @@
+"use strict";
+
+// Minimal benchmark harness: runs each case's async op repeatedly for a
+// fixed duration after a warmup, then reports ops/sec and latency
+// percentiles as one JSON object per line so results can be diffed and
+// bisected between releases by machine.
+
+function hrtime_ms() {
+    var t = process.hrtime();
+    return t[0] * 1e3 + t[1] / 1e6;
+}
+
+function percentile(sorted, p) {
+    if (sorted.length === 0) return 0;
+    var idx = Math.min(sorted.length - 1, Math.floor(sorted.length * p));
+    return sorted[idx];
+}
+
+// cases: [{name: str, fn: function(done)}]
+// options: {duration_ms, warmup_ms}
+function run(cases, options, finished) {
+    options = options || {};
+    var duration_ms = options.duration_ms || 2000;
+    var warmup_ms = options.warmup_ms || 250;
+    var results = [];
+    var idx = 0;
+
+    function run_case() {
+        if (idx >= cases.length) {
+            return finished(null, results);
+        }
+        var bench = cases[idx++];
+        var latencies = [];
+        var phase_end = hrtime_ms() + warmup_ms;
+        var warming = true;
+
+        function iterate() {
+            var started = hrtime_ms();
+            bench.fn(function(err) {
+                if (err) {
+                    return finished(new Error(bench.name + ': ' + err.message));
+                }
+                var now = hrtime_ms();
+                if (!warming) {
+                    latencies.push(now - started);
+                }
+                if (now < phase_end) {
+                    return iterate();
+                }
+                if (warming) {
+                    warming = false;
+                    phase_end = now + duration_ms;
+                    return iterate();
+                }
+                latencies.sort(function(a, b) { return a - b; });
+                var total_ms = latencies.reduce(function(a, b) { return a + b; }, 0);
+                var result = {
+                    name: bench.name,
+                    iterations: latencies.length,
+                    ops_per_sec: +(latencies.length / (total_ms / 1e3)).toFixed(2),
+                    p50_ms: +percentile(latencies, 0.50).toFixed(3),
+                    p99_ms: +percentile(latencies, 0.99).toFixed(3),
+                    max_ms: +percentile(latencies, 1.0).toFixed(3)
+                };
+                results.push(result);
+                console.log(JSON.stringify(result));
+                run_case();
+            });
+        }
+        iterate();
+    }
+    run_case();
+}
+
+module.exports = { run: run };
@@ -0,0 +1,121 @@
+#!/usr/bin/env node
+"use strict";
+
+// Micro and macro benchmarks over the checked-in tile/image corpus in
+// test/data. Run with `npm run bench` (or `node bench/run.js [filter]`);
+// each case prints a JSON line with ops/sec and latency percentiles.
+
+var mapnik = require('../');
+var fs = require('fs');
+var path = require('path');
+var zlib = require('zlib');
+var harness = require('./harness');
+
+mapnik.register_datasource(path.join(mapnik.settings.paths.input_plugins, 'shape.input'));
+mapnik.register_datasource(path.join(mapnik.settings.paths.input_plugins, 'geojson.input'));
+
+var data_dir = path.join(__dirname, '..', 'test');
+var tile0 = fs.readFileSync(path.join(data_dir, 'data', 'vector_tile', 'tile0.mvt'));
+var tile1 = fs.readFileSync(path.join(data_dir, 'data', 'vector_tile', 'tile1.vector.pbf'));
+var tile3 = fs.readFileSync(path.join(data_dir, 'data', 'vector_tile', 'tile3.mvt'));
+var tile1_gz = zlib.gzipSync(tile1);
+var png_10x10 = fs.readFileSync(path.join(data_dir, 'data', 'images', '10x10.png'));
+
+var map = new mapnik.Map(256, 256);
+map.loadSync(path.join(data_dir, 'stylesheet.xml'));
+map.extent = [-20037508.34, -20037508.34, 20037508.34, 20037508.34];
+
+var render_tile = new mapnik.VectorTile(0, 0, 0);
+render_tile.setData(tile0);
+
+var query_tile = new mapnik.VectorTile(5, 28, 12);
+query_tile.setData(tile3);
+
+var composite_source = new mapnik.VectorTile(0, 0, 0);
+composite_source.setData(tile0);
+
+var encode_image = new mapnik.Image(256, 256);
+encode_image.fill(new mapnik.Color('steelblue'));
+
+var cases = [
+    {
+        name: 'vtile.render 256px image',
+        fn: function(done) {
+            render_tile.render(map, new mapnik.Image(256, 256), function(err, im) {
+                done(err);
+            });
+        }
+    },
+    {
+        name: 'vtile.setData gzip 1MB-class tile',
+        fn: function(done) {
+            var vt = new mapnik.VectorTile(9, 112, 195);
+            vt.setData(tile1_gz, function(err) {
+                done(err);
+            });
+        }
+    },
+    {
+        name: 'vtile.composite single source',
+        fn: function(done) {
+            var target = new mapnik.VectorTile(0, 0, 0);
+            target.composite([composite_source], {}, function(err) {
+                done(err);
+            });
+        }
+    },
+    {
+        name: 'vtile.query point (linear)',
+        fn: function(done) {
+            query_tile.query(139.6142578125, 37.17782559332976, {tolerance: 0}, function(err, features) {
+                done(err);
+            });
+        }
+    },
+    {
+        name: 'vtile.query point (indexed)',
+        fn: function(done) {
+            query_tile.query(139.6142578125, 37.17782559332976, {tolerance: 0, index: true}, function(err, features) {
+                done(err);
+            });
+        }
+    },
+    {
+        name: 'image.encode png',
+        fn: function(done) {
+            encode_image.encode('png', function(err, buffer) {
+                done(err);
+            });
+        }
+    },
+    {
+        name: 'blend 2 images',
+        fn: function(done) {
+            mapnik.blend([png_10x10, png_10x10], function(err, buffer) {
+                done(err);
+            });
+        }
+    },
+    {
+        name: 'vtile.toGeoJSON layer',
+        fn: function(done) {
+            query_tile.toGeoJSON('world', function(err, geojson) {
+                done(err);
+            });
+        }
+    }
+];
+
+var filter = process.argv[2];
+if (filter) {
+    cases = cases.filter(function(c) { return c.name.indexOf(filter) !== -1; });
+}
+
+harness.run(cases, {duration_ms: +(process.env.BENCH_DURATION_MS || 2000)}, function(err, results) {
+    if (err) throw err;
+    console.log(JSON.stringify({
+        node: process.version,
+        mapnik: mapnik.versions.mapnik,
+        cases: results.length
+    }));
+});
@@ -32,6 +32,7 @@
         "src/node_mapnik.cpp",
         "src/blend.cpp",
         "src/mapnik_map.cpp",
+        "src/mapnik_map_pool.cpp",
         "src/mapnik_color.cpp",
         "src/mapnik_geometry.cpp",
         "src/mapnik_feature.cpp",
@@ -101,6 +102,11 @@
               '-lmapnik-json',
               '<!@(mapnik-config --ldflags)',
             ],
+            'conditions': [
+              ['OS=="linux"', {
+                'libraries': ['-lrt']
+              }]
+            ],
             'xcode_settings': {
               'OTHER_CPLUSPLUSFLAGS':[
                 '<!@(mapnik-config --cflags)',
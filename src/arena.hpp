@@ -0,0 +1,105 @@
+#ifndef __NODE_MAPNIK_ARENA_H__
+#define __NODE_MAPNIK_ARENA_H__
+
+// stl
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace node_mapnik {
+
+// Per-operation monotonic bump arena: allocations are pointer bumps in
+// growing blocks and everything is freed wholesale when the arena goes
+// out of scope with the baton. Used for the short-lived containers the
+// query pipelines churn through, so their allocation traffic stops
+// hitting the shared allocator under concurrent load.
+class monotonic_arena
+{
+public:
+    explicit monotonic_arena(std::size_t initial_block_size = 16 * 1024) :
+        blocks_(),
+        current_(nullptr),
+        space_(0),
+        next_block_size_(initial_block_size) {}
+
+    monotonic_arena(monotonic_arena const&) = delete;
+    monotonic_arena& operator=(monotonic_arena const&) = delete;
+
+    void * allocate(std::size_t size, std::size_t align)
+    {
+        std::size_t padding = (align - (reinterpret_cast<std::size_t>(current_) & (align - 1))) & (align - 1);
+        if (space_ < size + padding)
+        {
+            grow(size + align);
+            padding = (align - (reinterpret_cast<std::size_t>(current_) & (align - 1))) & (align - 1);
+        }
+        char * result = current_ + padding;
+        current_ = result + size;
+        space_ -= size + padding;
+        return result;
+    }
+
+private:
+    void grow(std::size_t at_least)
+    {
+        std::size_t block_size = next_block_size_;
+        if (block_size < at_least) block_size = at_least;
+        blocks_.emplace_back(new char[block_size]);
+        current_ = blocks_.back().get();
+        space_ = block_size;
+        next_block_size_ = block_size * 2;
+    }
+
+    std::vector<std::unique_ptr<char[]> > blocks_;
+    char * current_;
+    std::size_t space_;
+    std::size_t next_block_size_;
+};
+
+// Minimal C++11 allocator over a monotonic_arena. Deallocation is a
+// no-op - memory is reclaimed when the arena dies.
+template <typename T>
+class arena_allocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef T const* const_pointer;
+    typedef T& reference;
+    typedef T const& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind { typedef arena_allocator<U> other; };
+
+    explicit arena_allocator(monotonic_arena & arena) : arena_(&arena) {}
+
+    template <typename U>
+    arena_allocator(arena_allocator<U> const& other) : arena_(other.arena_) {}
+
+    T * allocate(std::size_t n)
+    {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, std::size_t) {}
+
+    template <typename U, typename... Args>
+    void construct(U * p, Args&&... args)
+    {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    void destroy(U * p) { p->~U(); }
+
+    bool operator==(arena_allocator const& other) const { return arena_ == other.arena_; }
+    bool operator!=(arena_allocator const& other) const { return arena_ != other.arena_; }
+
+    monotonic_arena * arena_;
+};
+
+} // end ns
+
+#endif // __NODE_MAPNIK_ARENA_H__
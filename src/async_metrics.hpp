@@ -0,0 +1,108 @@
+#ifndef __NODE_MAPNIK_ASYNC_METRICS_H__
+#define __NODE_MAPNIK_ASYNC_METRICS_H__
+
+// stl
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace node_mapnik {
+
+// Aggregate queue/execution timing for the async operations, keyed by
+// operation name and readable from JS through mapnik.metrics(). Queue
+// time is how long a baton waited between being queued and its worker
+// starting (threadpool saturation), execution time is the worker body
+// itself (genuinely slow work) - the split the tracing request is after.
+class async_metrics
+{
+public:
+    struct op_stats
+    {
+        std::uint64_t count = 0;
+        std::uint64_t queue_ns_total = 0;
+        std::uint64_t queue_ns_max = 0;
+        std::uint64_t exec_ns_total = 0;
+        std::uint64_t exec_ns_max = 0;
+    };
+
+    static async_metrics& instance()
+    {
+        static async_metrics metrics;
+        return metrics;
+    }
+
+    static std::uint64_t now_ns()
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void record(const char * op, std::uint64_t queue_ns, std::uint64_t exec_ns)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        op_stats & stats = stats_[op];
+        ++stats.count;
+        stats.queue_ns_total += queue_ns;
+        if (queue_ns > stats.queue_ns_max) stats.queue_ns_max = queue_ns;
+        stats.exec_ns_total += exec_ns;
+        if (exec_ns > stats.exec_ns_max) stats.exec_ns_max = exec_ns;
+    }
+
+    std::map<std::string, op_stats> snapshot(bool reset)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::map<std::string, op_stats> copy = stats_;
+        if (reset)
+        {
+            stats_.clear();
+        }
+        return copy;
+    }
+
+private:
+    async_metrics() = default;
+    std::mutex mutex_;
+    std::map<std::string, op_stats> stats_;
+};
+
+// Stamp carried in a baton: construction (at queue time) records the
+// enqueue timestamp; a trace_scope in the worker records start and end.
+struct async_trace
+{
+    async_trace() :
+        enqueue_ns(async_metrics::now_ns()),
+        start_ns(0) {}
+
+    std::uint64_t enqueue_ns;
+    std::uint64_t start_ns;
+};
+
+// RAII worker-side scope: declare one at the top of an EIO worker and
+// every exit path records queue and execution time for the operation.
+struct trace_scope
+{
+    trace_scope(async_trace & trace, const char * op) :
+        trace_(trace),
+        op_(op)
+    {
+        trace_.start_ns = async_metrics::now_ns();
+    }
+
+    ~trace_scope()
+    {
+        std::uint64_t end_ns = async_metrics::now_ns();
+        async_metrics::instance().record(op_,
+                                         trace_.start_ns - trace_.enqueue_ns,
+                                         end_ns - trace_.start_ns);
+    }
+
+    async_trace & trace_;
+    const char * op_;
+};
+
+} // end ns
+
+#endif // __NODE_MAPNIK_ASYNC_METRICS_H__
@@ -21,10 +21,12 @@
 
 #include "mapnik_palette.hpp"
 #include "blend.hpp"
+#include "output_buffer_pool.hpp"
 #include "tint.hpp"
 
 #include <sstream>
 #include <cstring>
+#include <future>
 #include <cstdlib>
 #include <memory>
 
@@ -172,27 +174,6 @@ static inline void Blend_CompositePixel(unsigned int& target, unsigned int const
     }
 }
 
-static inline void TintPixel(unsigned & r,
-                      unsigned & g,
-                      unsigned & b,
-                      Tinter const& tint) {
-    double h;
-    double s;
-    double l;
-    rgb_to_hsl(r,g,b,h,s,l);
-    double h2 = tint.h0 + (h * (tint.h1 - tint.h0));
-    double s2 = tint.s0 + (s * (tint.s1 - tint.s0));
-    double l2 = tint.l0 + (l * (tint.l1 - tint.l0));
-    if (h2 > 1) h2 = 1;
-    if (h2 < 0) h2 = 0;
-    if (s2 > 1) s2 = 1;
-    if (s2 < 0) s2 = 0;
-    if (l2 > 1) l2 = 1;
-    if (l2 < 0) l2 = 0;
-    hsl_to_rgb(h2,s2,l2,r,g,b);
-}
-
-
 static void Blend_Composite(unsigned int *target, BlendBaton *baton, BImage *image) {
     const unsigned int *source = image->im_ptr->data();
 
@@ -277,7 +258,15 @@ static void Blend_Encode(mapnik::image_rgba8 const& image, BlendBaton* baton, bo
             mapnik::png_options opts;
             opts.compression = baton->compression;
             if (baton->palette && baton->palette->valid()) {
-                mapnik::save_as_png8_pal(baton->stream, image, *baton->palette, opts);
+                if (baton->palette_cache) {
+                    // same encoder as save_as_png8_pal, but quantizing
+                    // through the palette's persistent lookup cache
+                    mapnik::save_as_png8<std::ostringstream, mapnik::image_rgba8, palette_quantize_cache>(
+                        baton->stream, image, *baton->palette_cache,
+                        baton->palette->palette(), baton->palette->alphaTable(), opts);
+                } else {
+                    mapnik::save_as_png8_pal(baton->stream, image, *baton->palette, opts);
+                }
             } else if (baton->quality > 0) {
                 opts.colors = baton->quality;
                 // Paletted PNG.
@@ -368,16 +357,6 @@ void Work_Blend(uv_work_t* req)
             return;
         }
 
-        // allocate image for decoded pixels
-        std::unique_ptr<mapnik::image_rgba8> im_ptr(new mapnik::image_rgba8(layer_width,layer_height));
-        // actually decode pixels now
-        try {
-            image_reader->read(0,0,*im_ptr);
-        } catch (std::exception const&) {
-            baton->message = "Could not decode image";
-            return;
-        }
-
         bool coversWidth = image->x <= 0 && visibleWidth >= baton->width;
         bool coversHeight = image->y <= 0 && visibleHeight >= baton->height;
         if (!layer_has_alpha && coversWidth && coversHeight && image->tint.is_alpha_identity()) {
@@ -385,14 +364,74 @@ void Work_Blend(uv_work_t* req)
             alpha = false;
         }
 
-        // Convenience aliases.
+        // Convenience aliases. Pixel decoding is deferred so all retained
+        // layers can be decoded in parallel below; the reader is kept so
+        // the decode stage does not re-parse the image header.
         image->width = layer_width;
         image->height = layer_height;
-        image->im_ptr = std::move(im_ptr);
+        image->reader = std::move(image_reader);
         ++size;
 
     }
 
+    // Decode the retained layers, in parallel when there is more than one.
+    {
+        std::vector<ImagePtr> to_decode;
+        for (auto const& image_ptr : baton->images)
+        {
+            if (image_ptr && image_ptr->reader)
+            {
+                to_decode.push_back(image_ptr);
+            }
+        }
+        auto decode_one = [](ImagePtr image) -> std::string
+        {
+            std::unique_ptr<mapnik::image_rgba8> im_ptr(new mapnik::image_rgba8(image->width,image->height));
+            try {
+                image->reader->read(0,0,*im_ptr);
+            } catch (std::exception const&) {
+                return std::string("Could not decode image");
+            }
+            // apply tinting here, in the (parallel) decode stage, with the
+            // memoized batch kernel so the composite loop below can take
+            // the cheap untinted path
+            tint_image_pixels(im_ptr->data(),
+                              static_cast<std::size_t>(image->width) * image->height,
+                              image->tint);
+            image->tint = Tinter();
+            image->im_ptr = std::move(im_ptr);
+            image->reader.reset();
+            return std::string();
+        };
+        if (to_decode.size() > 1)
+        {
+            std::vector<std::future<std::string> > futures;
+            futures.reserve(to_decode.size());
+            for (auto const& image_ptr : to_decode)
+            {
+                futures.push_back(std::async(std::launch::async, decode_one, image_ptr));
+            }
+            for (auto & future : futures)
+            {
+                std::string error = future.get();
+                if (!error.empty() && baton->message.empty())
+                {
+                    baton->message = error;
+                }
+            }
+            if (!baton->message.empty()) return;
+        }
+        else if (!to_decode.empty())
+        {
+            std::string error = decode_one(to_decode.front());
+            if (!error.empty())
+            {
+                baton->message = error;
+                return;
+            }
+        }
+    }
+
     // Now blend images.
     int pixels = baton->width * baton->height;
     if (pixels <= 0) {
@@ -425,7 +464,7 @@ void Work_AfterBlend(uv_work_t* req) {
         std::string result = baton->stream.str();
         v8::Local<v8::Value> argv[] = {
             Nan::Null(),
-            Nan::CopyBuffer((char *)result.data(), mapnik::safe_cast<std::uint32_t>(result.length())).ToLocalChecked(),
+            node_mapnik::pooled_buffer_to_v8(std::move(result)),
         };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(baton->callback), 2, argv);
     } else {
@@ -542,7 +581,9 @@ NAN_METHOD(Blend) {
 
         v8::Local<v8::Value> palette_val = options->Get(Nan::New("palette").ToLocalChecked());
         if (!palette_val.IsEmpty() && palette_val->IsObject()) {
-            baton->palette = Nan::ObjectWrap::Unwrap<Palette>(palette_val->ToObject())->palette();
+            Palette* palette_obj = Nan::ObjectWrap::Unwrap<Palette>(palette_val->ToObject());
+            baton->palette = palette_obj->palette();
+            baton->palette_cache = palette_obj->quantize_cache();
         }
 
         v8::Local<v8::Value> mode_val = options->Get(Nan::New("mode").ToLocalChecked());
@@ -15,6 +15,8 @@
 #include "mapnik_palette.hpp"
 #include "tint.hpp"
 
+#include <mapnik/image_reader.hpp>
+
 namespace node_mapnik {
 
 struct BImage {
@@ -35,6 +37,9 @@ struct BImage {
     int width, height;
     Tinter tint;
     std::unique_ptr<mapnik::image_rgba8> im_ptr;
+    // reader kept from the sizing pass so the decode stage can run later
+    // (possibly on another thread) without re-parsing the image header
+    std::unique_ptr<mapnik::image_reader> reader;
 };
 
 typedef std::shared_ptr<BImage> ImagePtr;
@@ -68,6 +73,7 @@ struct BlendBaton {
     int width;
     int height;
     palette_ptr palette;
+    palette_cache_ptr palette_cache;
     unsigned int matte;
     int compression;
     AlphaMode mode;
@@ -0,0 +1,132 @@
+#ifndef __NODE_MAPNIK_DEFLATE_POOL_H__
+#define __NODE_MAPNIK_DEFLATE_POOL_H__
+
+// zlib
+#include <zlib.h>
+
+// stl
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace node_mapnik {
+
+// A reusable gzip deflate stream. Repeated compression calls pay one
+// deflateInit2 per context and a cheap deflateReset afterwards, and the
+// output buffer is pre-sized with deflateBound so a single deflate call
+// with Z_FINISH suffices - no per-call z_stream setup or incremental
+// output growth.
+class deflate_context
+{
+public:
+    deflate_context() :
+        stream_(),
+        initialized_(false),
+        level_(Z_DEFAULT_COMPRESSION),
+        strategy_(Z_DEFAULT_STRATEGY) {}
+
+    ~deflate_context()
+    {
+        if (initialized_)
+        {
+            deflateEnd(&stream_);
+        }
+    }
+
+    deflate_context(deflate_context const&) = delete;
+    deflate_context& operator=(deflate_context const&) = delete;
+
+    void compress(const char * data, std::size_t size, std::string & output, int level, int strategy)
+    {
+        if (!initialized_)
+        {
+            stream_.zalloc = Z_NULL;
+            stream_.zfree = Z_NULL;
+            stream_.opaque = Z_NULL;
+            // 15 + 16 selects a gzip wrapper, matching zlib_compress(gzip=true)
+            if (deflateInit2(&stream_, level, Z_DEFLATED, 15 + 16, 8, strategy) != Z_OK)
+            {
+                throw std::runtime_error("deflate: could not initialize compression stream");
+            }
+            initialized_ = true;
+            level_ = level;
+            strategy_ = strategy;
+        }
+        else
+        {
+            deflateReset(&stream_);
+            if (level != level_ || strategy != strategy_)
+            {
+                if (deflateParams(&stream_, level, strategy) != Z_OK)
+                {
+                    throw std::runtime_error("deflate: could not update compression parameters");
+                }
+                level_ = level;
+                strategy_ = strategy;
+            }
+        }
+        output.resize(deflateBound(&stream_, size));
+        stream_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        stream_.avail_in = size;
+        stream_.next_out = reinterpret_cast<Bytef *>(&output[0]);
+        stream_.avail_out = output.size();
+        if (deflate(&stream_, Z_FINISH) != Z_STREAM_END)
+        {
+            throw std::runtime_error("deflate: compression failed");
+        }
+        output.resize(stream_.total_out);
+    }
+
+private:
+    z_stream stream_;
+    bool initialized_;
+    int level_;
+    int strategy_;
+};
+
+// Process-wide pool of deflate contexts shared across threads. acquire()
+// hands out an idle context or creates one; release() returns it for
+// reuse (a bounded number are kept idle). Contexts that failed mid
+// compression should simply be dropped instead of released.
+class deflate_context_pool
+{
+public:
+    static deflate_context_pool& instance()
+    {
+        static deflate_context_pool pool;
+        return pool;
+    }
+
+    std::unique_ptr<deflate_context> acquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty())
+        {
+            std::unique_ptr<deflate_context> ctx = std::move(idle_.back());
+            idle_.pop_back();
+            return ctx;
+        }
+        return std::unique_ptr<deflate_context>(new deflate_context());
+    }
+
+    void release(std::unique_ptr<deflate_context> ctx)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() < max_idle)
+        {
+            idle_.push_back(std::move(ctx));
+        }
+    }
+
+private:
+    deflate_context_pool() = default;
+    static constexpr std::size_t max_idle = 8;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<deflate_context> > idle_;
+};
+
+} // end ns
+
+#endif // __NODE_MAPNIK_DEFLATE_POOL_H__
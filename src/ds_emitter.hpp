@@ -20,10 +20,37 @@
 
 namespace node_mapnik {
 
-static void get_fields(v8::Local<v8::Object> fields, mapnik::datasource_ptr ds)
+// Native snapshot of everything describe()/fields() need, so wrappers
+// can capture it once and serve later calls without re-running the
+// datasource introspection (which for database sources is a round trip).
+struct datasource_description
+{
+    datasource_description() :
+        valid(false),
+        raster(false),
+        descriptor("",""),
+        geometry_type() {}
+
+    bool valid;
+    bool raster;
+    mapnik::layer_descriptor descriptor;
+    boost::optional<mapnik::datasource_geometry_t> geometry_type;
+};
+
+static inline void capture_description(datasource_description & snapshot, mapnik::datasource_ptr ds)
+{
+    snapshot.raster = ds->type() == mapnik::datasource::Raster;
+    snapshot.descriptor = ds->get_descriptor();
+    if (!snapshot.raster)
+    {
+        snapshot.geometry_type = ds->get_geometry_type();
+    }
+    snapshot.valid = true;
+}
+
+static inline void get_fields(v8::Local<v8::Object> fields, mapnik::layer_descriptor const& ld)
 {
     Nan::HandleScope scope;
-    mapnik::layer_descriptor ld = ds->get_descriptor();
     // field names and types
     auto const& desc = ld.get_descriptors();
     for (auto const& attr_info : desc)
@@ -48,12 +75,17 @@ static void get_fields(v8::Local<v8::Object> fields, mapnik::datasource_ptr ds)
     }
 }
 
-static void describe_datasource(v8::Local<v8::Object> description, mapnik::datasource_ptr ds)
+static inline void get_fields(v8::Local<v8::Object> fields, mapnik::datasource_ptr ds)
+{
+    get_fields(fields, ds->get_descriptor());
+}
+
+static inline void describe_datasource(v8::Local<v8::Object> description, datasource_description const& snapshot)
 {
     Nan::HandleScope scope;
-    
+
     // type
-    if (ds->type() == mapnik::datasource::Raster)
+    if (snapshot.raster)
     {
         description->Set(Nan::New("type").ToLocalChecked(), Nan::New<v8::String>("raster").ToLocalChecked());
     }
@@ -62,24 +94,24 @@ static void describe_datasource(v8::Local<v8::Object> description, mapnik::datas
         description->Set(Nan::New("type").ToLocalChecked(), Nan::New<v8::String>("vector").ToLocalChecked());
     }
 
-    mapnik::layer_descriptor ld = ds->get_descriptor();
+    mapnik::layer_descriptor const& ld = snapshot.descriptor;
 
     // encoding
     description->Set(Nan::New("encoding").ToLocalChecked(), Nan::New<v8::String>(ld.get_encoding().c_str()).ToLocalChecked());
 
     // field names and types
     v8::Local<v8::Object> fields = Nan::New<v8::Object>();
-    node_mapnik::get_fields(fields, ds);
+    node_mapnik::get_fields(fields, ld);
     description->Set(Nan::New("fields").ToLocalChecked(), fields);
 
     v8::Local<v8::String> js_type = Nan::New<v8::String>("unknown").ToLocalChecked();
-    if (ds->type() == mapnik::datasource::Raster)
+    if (snapshot.raster)
     {
         js_type = Nan::New<v8::String>("raster").ToLocalChecked();
     }
     else
     {
-        boost::optional<mapnik::datasource_geometry_t> geom_type = ds->get_geometry_type();
+        boost::optional<mapnik::datasource_geometry_t> const& geom_type = snapshot.geometry_type;
         if (geom_type)
         {
             mapnik::datasource_geometry_t g_type = *geom_type;
@@ -119,6 +151,13 @@ static void describe_datasource(v8::Local<v8::Object> description, mapnik::datas
     }
 }
 
+static inline void describe_datasource(v8::Local<v8::Object> description, mapnik::datasource_ptr ds)
+{
+    datasource_description snapshot;
+    capture_description(snapshot, ds);
+    describe_datasource(description, snapshot);
+}
+
 }
 
 #endif
@@ -0,0 +1,186 @@
+#ifndef __NODE_MAPNIK_IMAGE_KERNELS_H__
+#define __NODE_MAPNIK_IMAGE_KERNELS_H__
+
+// mapnik
+#include <mapnik/image_any.hpp>
+#include <mapnik/image_util.hpp>
+
+// stl
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NODE_MAPNIK_HAS_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define NODE_MAPNIK_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace node_mapnik {
+
+// Vectorized fast paths for the hottest per-pixel loops. Each helper
+// returns true when it handled the image (rgba8 data on a platform with
+// a SIMD implementation) and false when the caller must fall back to
+// the scalar mapnik implementation. The arithmetic replicates agg's
+// multiplier exactly - t = v * a + 255; v' = ((t >> 8) + t) >> 8 - so
+// results are bit-identical to mapnik::premultiply_alpha.
+
+inline std::uint8_t premultiply_channel(std::uint8_t v, std::uint8_t a)
+{
+    std::uint32_t t = static_cast<std::uint32_t>(v) * a + 255;
+    return static_cast<std::uint8_t>(((t >> 8) + t) >> 8);
+}
+
+inline bool premultiply_alpha_fast(mapnik::image_any & im)
+{
+#if defined(NODE_MAPNIK_HAS_SSE2) || defined(NODE_MAPNIK_HAS_NEON)
+    if (!im.is<mapnik::image_rgba8>())
+    {
+        return false;
+    }
+    mapnik::image_rgba8 & data = mapnik::util::get<mapnik::image_rgba8>(im);
+    if (data.get_premultiplied())
+    {
+        return true;
+    }
+    std::uint8_t * bytes = data.bytes();
+    std::size_t count = static_cast<std::size_t>(data.width()) * data.height();
+    std::size_t i = 0;
+#if defined(NODE_MAPNIK_HAS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c255 = _mm_set1_epi16(255);
+    const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i src = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bytes + i * 4));
+        __m128i lo = _mm_unpacklo_epi8(src, zero);
+        __m128i hi = _mm_unpackhi_epi8(src, zero);
+        __m128i alpha_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+        __m128i alpha_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+        __m128i t_lo = _mm_add_epi16(_mm_mullo_epi16(lo, alpha_lo), c255);
+        __m128i t_hi = _mm_add_epi16(_mm_mullo_epi16(hi, alpha_hi), c255);
+        __m128i res_lo = _mm_srli_epi16(_mm_add_epi16(_mm_srli_epi16(t_lo, 8), t_lo), 8);
+        __m128i res_hi = _mm_srli_epi16(_mm_add_epi16(_mm_srli_epi16(t_hi, 8), t_hi), 8);
+        __m128i res = _mm_packus_epi16(res_lo, res_hi);
+        // alpha itself stays untouched
+        res = _mm_or_si128(_mm_andnot_si128(alpha_mask, res), _mm_and_si128(alpha_mask, src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + i * 4), res);
+    }
+#elif defined(NODE_MAPNIK_HAS_NEON)
+    const uint16x8_t c255 = vdupq_n_u16(255);
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t px = vld4_u8(bytes + i * 4);
+        uint16x8_t t_r = vaddq_u16(vmull_u8(px.val[0], px.val[3]), c255);
+        uint16x8_t t_g = vaddq_u16(vmull_u8(px.val[1], px.val[3]), c255);
+        uint16x8_t t_b = vaddq_u16(vmull_u8(px.val[2], px.val[3]), c255);
+        px.val[0] = vmovn_u16(vshrq_n_u16(vaddq_u16(vshrq_n_u16(t_r, 8), t_r), 8));
+        px.val[1] = vmovn_u16(vshrq_n_u16(vaddq_u16(vshrq_n_u16(t_g, 8), t_g), 8));
+        px.val[2] = vmovn_u16(vshrq_n_u16(vaddq_u16(vshrq_n_u16(t_b, 8), t_b), 8));
+        vst4_u8(bytes + i * 4, px);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        std::uint8_t * px = bytes + i * 4;
+        std::uint8_t a = px[3];
+        px[0] = premultiply_channel(px[0], a);
+        px[1] = premultiply_channel(px[1], a);
+        px[2] = premultiply_channel(px[2], a);
+    }
+    data.set_premultiplied(true);
+    return true;
+#else
+    return false;
+#endif
+}
+
+// premultiply through the fast path when possible, otherwise via mapnik
+inline void premultiply_alpha(mapnik::image_any & im)
+{
+    if (!premultiply_alpha_fast(im))
+    {
+        mapnik::premultiply_alpha(im);
+    }
+}
+
+// Counts pixels whose channel difference exceeds the threshold, exactly
+// like mapnik::compare for rgba8 images, but 16 bytes at a time with an
+// early skip for identical blocks. Returns false when the inputs are
+// not both rgba8 of equal size or the threshold is outside byte range.
+inline bool compare_fast(mapnik::image_any const& im1,
+                         mapnik::image_any const& im2,
+                         int threshold,
+                         bool alpha,
+                         unsigned & difference)
+{
+#if defined(NODE_MAPNIK_HAS_SSE2)
+    if (!im1.is<mapnik::image_rgba8>() || !im2.is<mapnik::image_rgba8>())
+    {
+        return false;
+    }
+    if (threshold < 0 || threshold > 254)
+    {
+        return false;
+    }
+    mapnik::image_rgba8 const& data1 = mapnik::util::get<mapnik::image_rgba8>(im1);
+    mapnik::image_rgba8 const& data2 = mapnik::util::get<mapnik::image_rgba8>(im2);
+    if (data1.width() != data2.width() || data1.height() != data2.height())
+    {
+        return false;
+    }
+    std::uint8_t const* bytes1 = data1.bytes();
+    std::uint8_t const* bytes2 = data2.bytes();
+    std::size_t count = static_cast<std::size_t>(data1.width()) * data1.height();
+    difference = 0;
+    std::size_t i = 0;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i tvec = _mm_set1_epi8(static_cast<char>(threshold));
+    const __m128i alpha_ok = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bytes1 + i * 4));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bytes2 + i * 4));
+        // |a - b| per byte via saturated subtraction in both directions
+        __m128i diff = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+        // 0xFF where the channel difference is within the threshold
+        __m128i ok = _mm_cmpeq_epi8(_mm_subs_epu8(diff, tvec), zero);
+        if (!alpha)
+        {
+            ok = _mm_or_si128(ok, alpha_ok);
+        }
+        int mask = _mm_movemask_epi8(ok);
+        if (mask != 0xFFFF)
+        {
+            // one nibble per pixel; a nibble short of 0xF means some
+            // channel of that pixel differed beyond the threshold
+            if ((mask & 0x000F) != 0x000F) ++difference;
+            if ((mask & 0x00F0) != 0x00F0) ++difference;
+            if ((mask & 0x0F00) != 0x0F00) ++difference;
+            if ((mask & 0xF000) != 0xF000) ++difference;
+        }
+    }
+    for (; i < count; ++i)
+    {
+        std::uint8_t const* px1 = bytes1 + i * 4;
+        std::uint8_t const* px2 = bytes2 + i * 4;
+        int dr = px1[0] > px2[0] ? px1[0] - px2[0] : px2[0] - px1[0];
+        int dg = px1[1] > px2[1] ? px1[1] - px2[1] : px2[1] - px1[1];
+        int db = px1[2] > px2[2] ? px1[2] - px2[2] : px2[2] - px1[2];
+        int da = px1[3] > px2[3] ? px1[3] - px2[3] : px2[3] - px1[3];
+        if (dr > threshold || dg > threshold || db > threshold ||
+            (alpha && da > threshold))
+        {
+            ++difference;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // end ns
+
+#endif // __NODE_MAPNIK_IMAGE_KERNELS_H__
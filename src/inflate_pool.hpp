@@ -0,0 +1,140 @@
+#ifndef __NODE_MAPNIK_INFLATE_POOL_H__
+#define __NODE_MAPNIK_INFLATE_POOL_H__
+
+// zlib
+#include <zlib.h>
+
+// stl
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace node_mapnik {
+
+// A reusable inflate stream, the decompression counterpart of
+// deflate_pool.hpp. Each context pays inflateInit2 once (auto-detecting
+// gzip and zlib wrappers) and is recycled with inflateReset, and the
+// output scratch buffer keeps the capacity of the largest tile it has
+// decompressed, so steady ingest stops paying per-tile z_stream setup
+// and buffer growth.
+class inflate_context
+{
+public:
+    inflate_context() :
+        stream_(),
+        initialized_(false),
+        buffer_() {}
+
+    ~inflate_context()
+    {
+        if (initialized_)
+        {
+            inflateEnd(&stream_);
+        }
+    }
+
+    inflate_context(inflate_context const&) = delete;
+    inflate_context& operator=(inflate_context const&) = delete;
+
+    // decompresses into the context's scratch buffer and returns it;
+    // the reference is valid until the next decompress on this context
+    std::string const& decompress(const char * data, std::size_t size)
+    {
+        if (!initialized_)
+        {
+            stream_.zalloc = Z_NULL;
+            stream_.zfree = Z_NULL;
+            stream_.opaque = Z_NULL;
+            stream_.next_in = Z_NULL;
+            stream_.avail_in = 0;
+            // 15 + 32 auto-detects gzip and zlib wrappers
+            if (inflateInit2(&stream_, 15 + 32) != Z_OK)
+            {
+                throw std::runtime_error("inflate: could not initialize decompression stream");
+            }
+            initialized_ = true;
+        }
+        else
+        {
+            inflateReset(&stream_);
+        }
+        buffer_.clear();
+        if (buffer_.capacity() < size * 3)
+        {
+            buffer_.reserve(size * 3);
+        }
+        stream_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        stream_.avail_in = size;
+        std::size_t used = 0;
+        int ret = Z_OK;
+        do
+        {
+            if (buffer_.size() - used < 65536)
+            {
+                buffer_.resize(used + 262144);
+            }
+            std::size_t avail = buffer_.size() - used;
+            stream_.next_out = reinterpret_cast<Bytef *>(&buffer_[used]);
+            stream_.avail_out = avail;
+            ret = inflate(&stream_, Z_NO_FLUSH);
+            used += avail - stream_.avail_out;
+        } while (ret == Z_OK);
+        if (ret != Z_STREAM_END)
+        {
+            throw std::runtime_error("inflate: decompression failed");
+        }
+        buffer_.resize(used);
+        return buffer_;
+    }
+
+private:
+    z_stream stream_;
+    bool initialized_;
+    std::string buffer_;
+};
+
+// Process-wide pool of inflate contexts shared across threads,
+// mirroring deflate_context_pool. Contexts that failed mid stream
+// should be dropped instead of released.
+class inflate_context_pool
+{
+public:
+    static inflate_context_pool& instance()
+    {
+        static inflate_context_pool pool;
+        return pool;
+    }
+
+    std::unique_ptr<inflate_context> acquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty())
+        {
+            std::unique_ptr<inflate_context> ctx = std::move(idle_.back());
+            idle_.pop_back();
+            return ctx;
+        }
+        return std::unique_ptr<inflate_context>(new inflate_context());
+    }
+
+    void release(std::unique_ptr<inflate_context> ctx)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() < max_idle)
+        {
+            idle_.push_back(std::move(ctx));
+        }
+    }
+
+private:
+    inflate_context_pool() = default;
+    static const std::size_t max_idle = 8;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<inflate_context> > idle_;
+};
+
+} // end ns
+
+#endif // __NODE_MAPNIK_INFLATE_POOL_H__
@@ -0,0 +1,171 @@
+#ifndef __NODE_MAPNIK_JOB_SCHEDULER_H__
+#define __NODE_MAPNIK_JOB_SCHEDULER_H__
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wshadow"
+#include <nan.h>
+#pragma GCC diagnostic pop
+
+// stl
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace node_mapnik {
+
+// Priority-aware dispatch on top of the shared libuv threadpool.
+// Operations routed through here occupy at most `concurrency` uv work
+// slots; everything beyond that parks in a priority queue and is
+// released highest-priority-first (FIFO within a priority) as running
+// jobs finish, so cheap interactive work overtakes queued batch work
+// instead of waiting behind it in libuv's FIFO. The admission limit
+// defaults to UV_THREADPOOL_SIZE (libuv's own sizing rule) and can be
+// changed from JS via mapnik.threadPool({concurrency}); the thread
+// count itself still belongs to libuv.
+class job_scheduler
+{
+public:
+    enum priority : int
+    {
+        priority_low = 0,
+        priority_normal = 1,
+        priority_high = 2
+    };
+
+    static job_scheduler& instance()
+    {
+        static job_scheduler scheduler;
+        return scheduler;
+    }
+
+    static bool priority_from_string(std::string const& name, priority & result)
+    {
+        if (name == "low") { result = priority_low; return true; }
+        if (name == "normal") { result = priority_normal; return true; }
+        if (name == "high") { result = priority_high; return true; }
+        return false;
+    }
+
+    void queue(uv_work_t* req, uv_work_cb work, uv_after_work_cb after, priority p)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (active_ < concurrency_)
+        {
+            ++active_;
+            dispatch(req, work, after);
+            return;
+        }
+        job parked;
+        parked.req = req;
+        parked.work = work;
+        parked.after = after;
+        parked.p = p;
+        parked.seq = next_seq_++;
+        parked_.push(parked);
+    }
+
+    void set_concurrency(unsigned concurrency)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        concurrency_ = concurrency > 0 ? concurrency : 1;
+        // raising the limit may unblock parked jobs immediately
+        while (active_ < concurrency_ && !parked_.empty())
+        {
+            job next = parked_.top();
+            parked_.pop();
+            ++active_;
+            dispatch(next.req, next.work, next.after);
+        }
+    }
+
+    unsigned get_concurrency()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return concurrency_;
+    }
+
+private:
+    job_scheduler() :
+        mutex_(),
+        concurrency_(default_concurrency()),
+        active_(0),
+        next_seq_(0) {}
+
+    // mirrors libuv's threadpool sizing rule so deployments tuned with
+    // UV_THREADPOOL_SIZE keep their render concurrency on upgrade: the
+    // env var when set (clamped like libuv clamps it), otherwise 4
+    static unsigned default_concurrency()
+    {
+        const char * env = std::getenv("UV_THREADPOOL_SIZE");
+        if (env != nullptr)
+        {
+            long value = std::atol(env);
+            if (value < 1) value = 1;
+            if (value > 128) value = 128;
+            return static_cast<unsigned>(value);
+        }
+        return 4;
+    }
+
+    struct job
+    {
+        uv_work_t* req;
+        uv_work_cb work;
+        uv_after_work_cb after;
+        priority p;
+        std::uint64_t seq;
+    };
+
+    struct job_order
+    {
+        bool operator() (job const& a, job const& b) const
+        {
+            if (a.p != b.p) return a.p < b.p; // higher priority first
+            return a.seq > b.seq;             // then submission order
+        }
+    };
+
+    void dispatch(uv_work_t* req, uv_work_cb work, uv_after_work_cb after)
+    {
+        // mutex_ held by caller
+        originals_[req] = after;
+        uv_queue_work(uv_default_loop(), req, work, job_scheduler::after_trampoline);
+    }
+
+    static void after_trampoline(uv_work_t* req, int status)
+    {
+        job_scheduler & self = instance();
+        uv_after_work_cb original = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(self.mutex_);
+            std::map<uv_work_t*, uv_after_work_cb>::iterator itr = self.originals_.find(req);
+            original = itr->second;
+            self.originals_.erase(itr);
+            --self.active_;
+            if (self.active_ < self.concurrency_ && !self.parked_.empty())
+            {
+                job next = self.parked_.top();
+                self.parked_.pop();
+                ++self.active_;
+                self.dispatch(next.req, next.work, next.after);
+            }
+        }
+        original(req, status);
+    }
+
+    std::mutex mutex_;
+    unsigned concurrency_;
+    unsigned active_;
+    std::uint64_t next_seq_;
+    std::priority_queue<job, std::vector<job>, job_order> parked_;
+    std::map<uv_work_t*, uv_after_work_cb> originals_;
+};
+
+} // end ns
+
+#endif // __NODE_MAPNIK_JOB_SCHEDULER_H__
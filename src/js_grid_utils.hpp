@@ -10,9 +10,11 @@
 
 // stl
 #include <cmath> // ceil
+#include <cstdint>
 #include <stdint.h>  // for uint16_t
 
 #include <memory>
+#include <vector>
 
 
 
@@ -29,6 +31,7 @@ static void grid2utf(T const& grid_type,
 {
     typedef std::map< typename T::lookup_type, typename T::value_type> keys_type;
     typedef typename keys_type::const_iterator keys_iterator;
+    typedef typename T::value_type value_type;
 
     typename T::feature_key_type const& feature_keys = grid_type.get_feature_keys();
     typename T::feature_key_type::const_iterator feature_pos;
@@ -37,7 +40,73 @@ static void grid2utf(T const& grid_type,
     // start counting at utf8 codepoint 32, aka space character
     uint16_t codepoint = 32;
 
+    // resolves a feature id to its codepoint, assigning a new one in
+    // first-appearance order exactly as before; returns -1 for ids that
+    // are not in the feature key map
+    auto resolve = [&](value_type feature_id) -> std::int32_t
+    {
+        feature_pos = feature_keys.find(feature_id);
+        if (feature_pos == feature_keys.end())
+        {
+            // shouldn't get here...
+            return -1;
+        }
+        typename T::lookup_type const& val = feature_pos->second;
+        keys_iterator key_pos = keys.find(val);
+        if (key_pos != keys.end())
+        {
+            return static_cast<std::int32_t>(key_pos->second);
+        }
+        // Create a new entry for this key. Skip the codepoints that
+        // can't be encoded directly in JSON.
+        if (codepoint == 34) ++codepoint;      // Skip "
+        else if (codepoint == 92) ++codepoint; // Skip backslash
+        if (feature_id == mapnik::grid::base_mask)
+        {
+            keys[""] = codepoint;
+            key_order.emplace_back("");
+        }
+        else
+        {
+            keys[val] = codepoint;
+            key_order.push_back(val);
+        }
+        return static_cast<std::int32_t>(codepoint++);
+    };
+
+    // Grid values are dense small integers, so cache the id -> codepoint
+    // resolution in a flat table over the id range instead of paying two
+    // map lookups (one of them keyed by string) for every cell. Slot
+    // states: -1 unseen, -2 known absent, otherwise the codepoint.
+    value_type min_id = 0;
+    value_type max_id = 0;
+    bool have_range = false;
+    for (auto const& fk : feature_keys)
+    {
+        if (fk.first == mapnik::grid::base_mask) continue;
+        if (!have_range)
+        {
+            min_id = max_id = fk.first;
+            have_range = true;
+        }
+        else
+        {
+            if (fk.first < min_id) min_id = fk.first;
+            if (fk.first > max_id) max_id = fk.first;
+        }
+    }
+    bool const use_table = have_range &&
+        (static_cast<std::int64_t>(max_id) - static_cast<std::int64_t>(min_id)) < (1 << 20);
+    std::vector<std::int32_t> id_codepoints;
+    if (use_table)
+    {
+        id_codepoints.assign(static_cast<std::size_t>(max_id - min_id) + 1, -1);
+    }
+    std::int32_t mask_codepoint = -1;
+
     unsigned array_size = std::ceil(grid_type.width()/static_cast<float>(resolution));
+    lines.reserve(static_cast<std::size_t>(
+        std::ceil(grid_type.height()/static_cast<float>(resolution))));
     for (unsigned y = 0; y < grid_type.height(); y=y+resolution)
     {
         uint16_t idx = 0;
@@ -45,38 +114,35 @@ static void grid2utf(T const& grid_type,
         typename T::value_type const* row = grid_type.get_row(y);
         for (unsigned x = 0; x < grid_type.width(); x=x+resolution)
         {
-            // todo - this lookup is expensive
-            typename T::value_type feature_id = row[x];
-            feature_pos = feature_keys.find(feature_id);
-            if (feature_pos != feature_keys.end())
+            value_type feature_id = row[x];
+            std::int32_t cp;
+            if (feature_id == mapnik::grid::base_mask)
             {
-                typename T::lookup_type const& val = feature_pos->second;
-                keys_iterator key_pos = keys.find(val);
-                if (key_pos == keys.end())
+                if (mask_codepoint == -1)
                 {
-                    // Create a new entry for this key. Skip the codepoints that
-                    // can't be encoded directly in JSON.
-                    if (codepoint == 34) ++codepoint;      // Skip "
-                    else if (codepoint == 92) ++codepoint; // Skip backslash
-                    if (feature_id == mapnik::grid::base_mask)
-                    {
-                        keys[""] = codepoint;
-                        key_order.emplace_back("");
-                    }
-                    else
-                    {
-                        keys[val] = codepoint;
-                        key_order.push_back(val);
-                    }
-                    line[idx++] = static_cast<uint16_t>(codepoint);
-                    ++codepoint;
+                    std::int32_t resolved = resolve(feature_id);
+                    mask_codepoint = resolved < 0 ? -2 : resolved;
                 }
-                else
+                cp = mask_codepoint;
+            }
+            else if (use_table && feature_id >= min_id && feature_id <= max_id)
+            {
+                std::int32_t & slot = id_codepoints[static_cast<std::size_t>(feature_id - min_id)];
+                if (slot == -1)
                 {
-                    line[idx++] = static_cast<uint16_t>(key_pos->second);
+                    std::int32_t resolved = resolve(feature_id);
+                    slot = resolved < 0 ? -2 : resolved;
                 }
+                cp = slot;
+            }
+            else
+            {
+                cp = resolve(feature_id);
+            }
+            if (cp >= 0)
+            {
+                line[idx++] = static_cast<uint16_t>(cp);
             }
-            // else, shouldn't get here...
         }
         lines.push_back(std::move(line));
     }
@@ -1,5 +1,6 @@
 
 #include "mapnik_datasource.hpp"
+#include "mapnik_plugins.hpp"
 #include "mapnik_featureset.hpp"
 #include "utils.hpp"
 #include "ds_emitter.hpp"
@@ -41,6 +42,7 @@ void Datasource::Initialize(v8::Local<v8::Object> target) {
     Nan::SetPrototypeMethod(lcons, "featureset", featureset);
     Nan::SetPrototypeMethod(lcons, "extent", extent);
     Nan::SetPrototypeMethod(lcons, "fields", fields);
+    Nan::SetPrototypeMethod(lcons, "invalidate", invalidate);
 
     target->Set(Nan::New("Datasource").ToLocalChecked(), lcons->GetFunction());
     constructor.Reset(lcons);
@@ -110,6 +112,8 @@ NAN_METHOD(Datasource::New)
     mapnik::datasource_ptr ds;
     try
     {
+        boost::optional<std::string> type = params.get<std::string>("type");
+        node_mapnik::ensure_plugins_registered(type ? *type : "");
         ds = mapnik::datasource_cache::instance().create(params);
     }
     catch (std::exception const& ex)
@@ -215,7 +219,13 @@ NAN_METHOD(Datasource::describe)
     v8::Local<v8::Object> description = Nan::New<v8::Object>();
     try
     {
-        node_mapnik::describe_datasource(description,d->datasource_);
+        // the native snapshot is captured once and reused; for database
+        // sources the introspection behind get_descriptor is a round trip
+        if (!d->description_cache_.valid)
+        {
+            node_mapnik::capture_description(d->description_cache_, d->datasource_);
+        }
+        node_mapnik::describe_datasource(description, d->description_cache_);
     }
     catch (std::exception const& ex)
     {
@@ -314,6 +324,35 @@ NAN_METHOD(Datasource::fields)
 {
     Datasource* d = Nan::ObjectWrap::Unwrap<Datasource>(info.Holder());
     v8::Local<v8::Object> fields = Nan::New<v8::Object>();
-    node_mapnik::get_fields(fields,d->datasource_);
+    try
+    {
+        if (!d->description_cache_.valid)
+        {
+            node_mapnik::capture_description(d->description_cache_, d->datasource_);
+        }
+        node_mapnik::get_fields(fields, d->description_cache_.descriptor);
+    }
+    catch (std::exception const& ex)
+    {
+        /* LCOV_EXCL_START */
+        Nan::ThrowError(ex.what());
+        return;
+        /* LCOV_EXCL_STOP */
+    }
     info.GetReturnValue().Set(fields);
 }
+
+/**
+ * Drop the cached description so the next describe() or fields() call
+ * re-runs the datasource introspection.
+ *
+ * @name invalidate
+ * @memberof Datasource
+ * @instance
+ */
+NAN_METHOD(Datasource::invalidate)
+{
+    Datasource* d = Nan::ObjectWrap::Unwrap<Datasource>(info.Holder());
+    d->description_cache_ = node_mapnik::datasource_description();
+    return;
+}
@@ -9,7 +9,7 @@
 
 #include <memory>
 
-
+#include "ds_emitter.hpp"
 
 namespace mapnik { class datasource; }
 
@@ -27,6 +27,7 @@ public:
     static NAN_METHOD(featureset);
     static NAN_METHOD(extent);
     static NAN_METHOD(fields);
+    static NAN_METHOD(invalidate);
 
     Datasource();
     inline datasource_ptr get() { return datasource_; }
@@ -34,6 +35,7 @@ public:
 private:
     ~Datasource();
     datasource_ptr datasource_;
+    node_mapnik::datasource_description description_cache_;
 };
 
 #endif
@@ -12,6 +12,8 @@
 
 // stl
 #include <exception>                    // for exception
+#include <map>                          // for map
+#include <mutex>                        // for mutex, lock_guard
 
 Nan::Persistent<v8::FunctionTemplate> Expression::constructor;
 
@@ -26,10 +28,74 @@ void Expression::Initialize(v8::Local<v8::Object> target) {
     Nan::SetPrototypeMethod(lcons, "toString", toString);
     Nan::SetPrototypeMethod(lcons, "evaluate", evaluate);
 
+    Nan::SetMethod(lcons->GetFunction().As<v8::Object>(), "clearCache", Expression::clearCache);
+    Nan::SetMethod(lcons->GetFunction().As<v8::Object>(), "cacheSize", Expression::cacheSize);
+
     target->Set(Nan::New("Expression").ToLocalChecked(), lcons->GetFunction());
     constructor.Reset(lcons);
 }
 
+namespace {
+
+// Process-wide cache of parsed expressions keyed by the source string.
+// Expressions are immutable once parsed so instances can share the
+// compiled tree; repeat construction of a known expression becomes a
+// map lookup instead of a grammar parse. Bounded by a simple size cap
+// (the working set is typically a few dozen expressions) and clearable
+// through Expression.clearCache().
+std::map<std::string, mapnik::expression_ptr> expression_cache;
+std::mutex expression_cache_mutex;
+const std::size_t expression_cache_max_entries = 1024;
+
+mapnik::expression_ptr parse_expression_cached(std::string const& source)
+{
+    {
+        std::lock_guard<std::mutex> lock(expression_cache_mutex);
+        std::map<std::string, mapnik::expression_ptr>::const_iterator itr = expression_cache.find(source);
+        if (itr != expression_cache.end())
+        {
+            return itr->second;
+        }
+    }
+    mapnik::expression_ptr expression = mapnik::parse_expression(source);
+    std::lock_guard<std::mutex> lock(expression_cache_mutex);
+    if (expression_cache.size() < expression_cache_max_entries)
+    {
+        expression_cache[source] = expression;
+    }
+    return expression;
+}
+
+} // anonymous namespace
+
+/**
+ * Empty the process-wide cache of parsed expressions.
+ *
+ * @name clearCache
+ * @memberof Expression
+ * @static
+ */
+NAN_METHOD(Expression::clearCache)
+{
+    std::lock_guard<std::mutex> lock(expression_cache_mutex);
+    expression_cache.clear();
+    return;
+}
+
+/**
+ * Number of parsed expressions currently cached.
+ *
+ * @name cacheSize
+ * @memberof Expression
+ * @static
+ * @returns {number} cached expression count
+ */
+NAN_METHOD(Expression::cacheSize)
+{
+    std::lock_guard<std::mutex> lock(expression_cache_mutex);
+    info.GetReturnValue().Set(Nan::New<v8::Integer>(static_cast<int>(expression_cache.size())));
+}
+
 Expression::Expression() :
     Nan::ObjectWrap(),
     this_() {}
@@ -50,7 +116,7 @@ NAN_METHOD(Expression::New)
     try
     {
         if (info.Length() == 1 && info[0]->IsString()) {
-            e_ptr = mapnik::parse_expression(TOSTR(info[0]));
+            e_ptr = parse_expression_cached(TOSTR(info[0]));
         } else {
             Nan::ThrowTypeError("invalid arguments: accepts a single argument of string type");
             return;
@@ -21,6 +21,8 @@ public:
     static NAN_METHOD(New);
     static NAN_METHOD(toString);
     static NAN_METHOD(evaluate);
+    static NAN_METHOD(clearCache);
+    static NAN_METHOD(cacheSize);
 
     Expression();
     inline mapnik::expression_ptr get() { return this_; }
@@ -32,6 +32,7 @@ void Feature::Initialize(v8::Local<v8::Object> target) {
     Nan::SetPrototypeMethod(lcons, "id", id);
     Nan::SetPrototypeMethod(lcons, "extent", extent);
     Nan::SetPrototypeMethod(lcons, "attributes", attributes);
+    Nan::SetPrototypeMethod(lcons, "get", get);
     Nan::SetPrototypeMethod(lcons, "geometry", geometry);
     Nan::SetPrototypeMethod(lcons, "toJSON", toJSON);
 
@@ -176,6 +177,35 @@ NAN_METHOD(Feature::extent)
  * @instance
  * @returns {Object} attributes
  */
+/**
+ * Get a single attribute value by field name, converting only that value
+ * instead of materializing every attribute like `attributes` does.
+ * Returns `undefined` when the feature has no such field.
+ *
+ * @name get
+ * @memberof Feature
+ * @instance
+ * @param {string} field attribute name
+ * @returns {string|number|boolean|null|undefined} the attribute value
+ */
+NAN_METHOD(Feature::get)
+{
+    if (info.Length() != 1 || !info[0]->IsString())
+    {
+        Nan::ThrowTypeError("first argument must be a field name (string)");
+        return;
+    }
+    Feature* fp = Nan::ObjectWrap::Unwrap<Feature>(info.Holder());
+    mapnik::feature_ptr feature = fp->get();
+    std::string field = TOSTR(info[0]);
+    if (!feature->has_key(field))
+    {
+        return;
+    }
+    info.GetReturnValue().Set(
+        mapnik::util::apply_visitor(node_mapnik::value_converter(), feature->get(field)));
+}
+
 NAN_METHOD(Feature::attributes)
 {
     Feature* fp = Nan::ObjectWrap::Unwrap<Feature>(info.Holder());
@@ -1,5 +1,9 @@
 #include "mapnik_featureset.hpp"
 #include "mapnik_feature.hpp"
+#include "utils.hpp"
+
+// stl
+#include <vector>
 
 Nan::Persistent<v8::FunctionTemplate> Featureset::constructor;
 
@@ -19,6 +23,7 @@ void Featureset::Initialize(v8::Local<v8::Object> target) {
     lcons->SetClassName(Nan::New("Featureset").ToLocalChecked());
 
     Nan::SetPrototypeMethod(lcons, "next", next);
+    Nan::SetPrototypeMethod(lcons, "nextBatch", nextBatch);
 
     target->Set(Nan::New("Featureset").ToLocalChecked(), lcons->GetFunction());
     constructor.Reset(lcons);
@@ -92,6 +97,151 @@ NAN_METHOD(Featureset::next)
     return;
 }
 
+namespace {
+
+typedef struct {
+    uv_work_t request;
+    Featureset* fs;
+    unsigned batch_size;
+    std::vector<mapnik::feature_ptr> features;
+    bool error;
+    std::string error_name;
+    Nan::Persistent<v8::Function> cb;
+} featureset_batch_baton_t;
+
+// converts a batch of pulled features into an array of plain objects of
+// the form {id, attributes}, so a whole batch costs one boundary crossing
+v8::Local<v8::Array> batch_to_v8(std::vector<mapnik::feature_ptr> const& features)
+{
+    Nan::EscapableHandleScope scope;
+    v8::Local<v8::Array> arr = Nan::New<v8::Array>(features.size());
+    std::size_t i = 0;
+    for (mapnik::feature_ptr const& feature : features)
+    {
+        v8::Local<v8::Object> feat = Nan::New<v8::Object>();
+        feat->Set(Nan::New("id").ToLocalChecked(), Nan::New<v8::Number>(feature->id()));
+        v8::Local<v8::Object> attributes = Nan::New<v8::Object>();
+        mapnik::feature_impl::iterator itr = feature->begin();
+        mapnik::feature_impl::iterator end = feature->end();
+        for ( ;itr!=end; ++itr)
+        {
+            attributes->Set(Nan::New<v8::String>(std::get<0>(*itr)).ToLocalChecked(),
+                            mapnik::util::apply_visitor(node_mapnik::value_converter(), std::get<1>(*itr)));
+        }
+        feat->Set(Nan::New("attributes").ToLocalChecked(), attributes);
+        arr->Set(i++, feat);
+    }
+    return scope.Escape(arr);
+}
+
+} // anonymous namespace
+
+/**
+ * Pull up to `n` features in a single native call and return them as an
+ * array of `{id, attributes}` objects, avoiding the per-feature wrapper
+ * and boundary-crossing cost of `next`. With a callback the datasource
+ * iteration runs on the thread pool and the callback receives the batch;
+ * an empty array means the featureset is exhausted.
+ *
+ * @name nextBatch
+ * @instance
+ * @memberof Featureset
+ * @param {number} n maximum number of features to pull
+ * @param {Function} [callback] optional `function(err, features)`
+ * @returns {Array<Object>} batch of features (sync form only)
+ */
+NAN_METHOD(Featureset::nextBatch)
+{
+    Featureset* fs = Nan::ObjectWrap::Unwrap<Featureset>(info.Holder());
+    if (info.Length() < 1 || !info[0]->IsNumber() || info[0]->IntegerValue() < 1)
+    {
+        Nan::ThrowTypeError("first argument must be a positive number of features to pull");
+        return;
+    }
+    unsigned batch_size = static_cast<unsigned>(info[0]->IntegerValue());
+
+    if (!info[info.Length()-1]->IsFunction())
+    {
+        std::vector<mapnik::feature_ptr> features;
+        if (fs->this_)
+        {
+            try
+            {
+                mapnik::feature_ptr fp;
+                while (features.size() < batch_size && (fp = fs->this_->next()))
+                {
+                    features.push_back(fp);
+                }
+            }
+            catch (std::exception const& ex)
+            {
+                /* LCOV_EXCL_START */
+                Nan::ThrowError(ex.what());
+                return;
+                /* LCOV_EXCL_STOP */
+            }
+        }
+        info.GetReturnValue().Set(batch_to_v8(features));
+        return;
+    }
+
+    v8::Local<v8::Value> callback = info[info.Length()-1];
+    featureset_batch_baton_t *closure = new featureset_batch_baton_t();
+    closure->request.data = closure;
+    closure->fs = fs;
+    closure->batch_size = batch_size;
+    closure->error = false;
+    closure->cb.Reset(callback.As<v8::Function>());
+    uv_queue_work(uv_default_loop(), &closure->request, EIO_NextBatch, (uv_after_work_cb)EIO_AfterNextBatch);
+    fs->Ref();
+    return;
+}
+
+void Featureset::EIO_NextBatch(uv_work_t* req)
+{
+    featureset_batch_baton_t *closure = static_cast<featureset_batch_baton_t *>(req->data);
+    if (!closure->fs->this_)
+    {
+        return;
+    }
+    try
+    {
+        mapnik::feature_ptr fp;
+        while (closure->features.size() < closure->batch_size && (fp = closure->fs->this_->next()))
+        {
+            closure->features.push_back(fp);
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        /* LCOV_EXCL_START */
+        closure->error = true;
+        closure->error_name = ex.what();
+        /* LCOV_EXCL_STOP */
+    }
+}
+
+void Featureset::EIO_AfterNextBatch(uv_work_t* req)
+{
+    Nan::HandleScope scope;
+    featureset_batch_baton_t *closure = static_cast<featureset_batch_baton_t *>(req->data);
+    if (closure->error)
+    {
+        /* LCOV_EXCL_START */
+        v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+        /* LCOV_EXCL_STOP */
+    }
+    else
+    {
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), batch_to_v8(closure->features) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+    }
+    closure->fs->Unref();
+    closure->cb.Reset();
+    delete closure;
+}
+
 v8::Local<v8::Value> Featureset::NewInstance(mapnik::featureset_ptr fs_ptr)
 {
     Nan::EscapableHandleScope scope;
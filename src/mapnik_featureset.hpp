@@ -21,6 +21,9 @@ public:
     static NAN_METHOD(New);
     static v8::Local<v8::Value> NewInstance(mapnik::featureset_ptr fs_ptr);
     static NAN_METHOD(next);
+    static NAN_METHOD(nextBatch);
+    static void EIO_NextBatch(uv_work_t* req);
+    static void EIO_AfterNextBatch(uv_work_t* req);
 
     Featureset();
 
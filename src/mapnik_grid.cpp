@@ -56,8 +56,10 @@ void Grid::Initialize(v8::Local<v8::Object> target) {
 
 Grid::Grid(unsigned int width, unsigned int height, std::string const& key) :
     Nan::ObjectWrap(),
-    this_(std::make_shared<mapnik::grid>(width,height,key))
+    this_(std::make_shared<mapnik::grid>(width,height,key)),
+    tracker_(node_mapnik::grid_stats())
 {
+    tracker_.update(static_cast<std::int64_t>(width) * height * sizeof(mapnik::grid::value_type));
 }
 
 Grid::~Grid()
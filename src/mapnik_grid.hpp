@@ -10,6 +10,8 @@
 #pragma GCC diagnostic pop
 
 #include <mapnik/grid/grid.hpp>
+
+#include "memory_stats.hpp"
 #include <memory>
 
 
@@ -50,6 +52,7 @@ public:
 private:
     ~Grid();
     grid_ptr this_;
+    node_mapnik::object_tracker tracker_;
 };
 
 #endif
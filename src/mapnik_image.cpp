@@ -23,6 +23,9 @@
 #include <mapnik/svg/svg_path_attributes.hpp>
 
 #include "mapnik_image.hpp"
+#include "image_kernels.hpp"
+#include "output_buffer_pool.hpp"
+#include "async_metrics.hpp"
 #include "mapnik_image_view.hpp"
 #include "mapnik_palette.hpp"
 #include "mapnik_color.hpp"
@@ -44,6 +47,15 @@
 #include <ostream>                      // for operator<<, basic_ostream
 #include <sstream>                      // for basic_ostringstream, etc
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <sys/stat.h>
 
 Nan::Persistent<v8::FunctionTemplate> Image::constructor;
 
@@ -148,14 +160,18 @@ void Image::Initialize(v8::Local<v8::Object> target) {
 
 Image::Image(unsigned int width, unsigned int height, mapnik::image_dtype type, bool initialized, bool premultiplied, bool painted) :
     Nan::ObjectWrap(),
-    this_(std::make_shared<mapnik::image_any>(width,height,type,initialized,premultiplied,painted))
+    this_(std::make_shared<mapnik::image_any>(width,height,type,initialized,premultiplied,painted)),
+    tracker_(node_mapnik::image_stats())
 {
+    tracker_.update(static_cast<std::int64_t>(this_->size()));
 }
 
 Image::Image(image_ptr _this) :
     Nan::ObjectWrap(),
-    this_(_this)
+    this_(_this),
+    tracker_(node_mapnik::image_stats())
 {
+    tracker_.update(static_cast<std::int64_t>(this_->size()));
 }
 
 Image::~Image()
@@ -638,7 +654,11 @@ NAN_METHOD(Image::compare)
             Nan::ThrowTypeError("image dimensions do not match");
             return;
     }
-    unsigned difference = mapnik::compare(*im->this_, *im2->this_, threshold, alpha);
+    unsigned difference;
+    if (!node_mapnik::compare_fast(*im->this_, *im2->this_, threshold, alpha, difference))
+    {
+        difference = mapnik::compare(*im->this_, *im2->this_, threshold, alpha);
+    }
     info.GetReturnValue().Set(Nan::New<v8::Integer>(difference));
 }
 
@@ -1200,7 +1220,7 @@ NAN_METHOD(Image::premultiplySync)
 v8::Local<v8::Value> Image::_premultiplySync(Nan::NAN_METHOD_ARGS_TYPE info) {
     Nan::EscapableHandleScope scope;
     Image* im = Nan::ObjectWrap::Unwrap<Image>(info.Holder());
-    mapnik::premultiply_alpha(*im->this_);
+    node_mapnik::premultiply_alpha(*im->this_);
     return scope.Escape(Nan::Undefined());
 }
 
@@ -1245,7 +1265,7 @@ NAN_METHOD(Image::premultiply)
 void Image::EIO_Premultiply(uv_work_t* req)
 {
     image_op_baton_t *closure = static_cast<image_op_baton_t *>(req->data);
-    mapnik::premultiply_alpha(*closure->im->this_);
+    node_mapnik::premultiply_alpha(*closure->im->this_);
 }
 
 void Image::EIO_AfterMultiply(uv_work_t* req)
@@ -1747,6 +1767,7 @@ typedef struct {
     int offset_x;
     int offset_y;
     double filter_factor;
+    unsigned threads;
     Nan::Persistent<v8::Function> cb;
     bool error;
     std::string error_name;
@@ -1892,6 +1913,18 @@ NAN_METHOD(Image::resize)
             return;
         }
     }
+
+    unsigned threads = 1;
+    if (options->Has(Nan::New("threads").ToLocalChecked()))
+    {
+        v8::Local<v8::Value> threads_val = options->Get(Nan::New("threads").ToLocalChecked());
+        if (!threads_val->IsNumber() || threads_val->IntegerValue() < 1)
+        {
+            Nan::ThrowTypeError("threads argument must be a positive integer");
+            return;
+        }
+        threads = static_cast<unsigned>(threads_val->IntegerValue());
+    }
     resize_image_baton_t *closure = new resize_image_baton_t();
     closure->request.data = closure;
     closure->im1 = im1;
@@ -1901,6 +1934,7 @@ NAN_METHOD(Image::resize)
     closure->offset_x = offset_x;
     closure->offset_y = offset_y;
     closure->filter_factor = filter_factor;
+    closure->threads = threads;
     closure->error = false;
     closure->cb.Reset(callback.As<v8::Function>());
     uv_queue_work(uv_default_loop(), &closure->request, EIO_Resize, (uv_after_work_cb)EIO_AfterResize);
@@ -2042,6 +2076,57 @@ void Image::EIO_Resize(uv_work_t* req)
         }
         double image_ratio_x = static_cast<double>(closure->size_x) / im_width; 
         double image_ratio_y = static_cast<double>(closure->size_y) / im_height;
+        // the scaling kernels are independent across output rows, so with
+        // {threads: N} rgba8 resizes split the output into row bands
+        // scaled on parallel tasks; band b's source window is selected
+        // through the y offset, giving the same sample coordinates (and
+        // the same bytes) as a single pass
+        if (closure->threads > 1 &&
+            closure->im1->this_->is<mapnik::image_rgba8>() &&
+            closure->im2->is<mapnik::image_rgba8>() &&
+            closure->size_y > 1)
+        {
+            if (!closure->im1->this_->get_premultiplied())
+            {
+                throw std::runtime_error("RGBA8 images must be premultiplied prior to using resize");
+            }
+            mapnik::image_rgba8 const& source = mapnik::util::get<mapnik::image_rgba8>(*(closure->im1->this_));
+            mapnik::image_rgba8 & target = mapnik::util::get<mapnik::image_rgba8>(*(closure->im2));
+            unsigned bands = closure->threads > closure->size_y ?
+                static_cast<unsigned>(closure->size_y) : closure->threads;
+            std::vector<std::future<void> > futures;
+            futures.reserve(bands);
+            for (unsigned band = 0; band < bands; ++band)
+            {
+                std::size_t y0 = band * closure->size_y / bands;
+                std::size_t y1 = (band + 1) * closure->size_y / bands;
+                futures.push_back(std::async(std::launch::async,
+                                             [closure, &source, &target, image_ratio_x, image_ratio_y, y0, y1]()
+                {
+                    std::size_t band_height = y1 - y0;
+                    mapnik::image_rgba8 band_im(closure->size_x, band_height, true, true);
+                    mapnik::scale_image_agg(band_im,
+                                            source,
+                                            closure->scaling_method,
+                                            image_ratio_x,
+                                            image_ratio_y,
+                                            static_cast<double>(closure->offset_x),
+                                            static_cast<double>(closure->offset_y) + y0 / image_ratio_y,
+                                            closure->filter_factor);
+                    for (std::size_t row = 0; row < band_height; ++row)
+                    {
+                        std::memcpy(target.bytes() + (y0 + row) * target.row_size(),
+                                    band_im.bytes() + row * band_im.row_size(),
+                                    band_im.row_size());
+                    }
+                }));
+            }
+            for (auto & future : futures)
+            {
+                future.get();
+            }
+            return;
+        }
         resize_visitor visit(*(closure->im1->this_),
                              closure->scaling_method,
                              image_ratio_x,
@@ -2335,6 +2420,218 @@ NAN_METHOD(Image::openSync)
     info.GetReturnValue().Set(_openSync(info));
 }
 
+namespace {
+
+// Opt-in LRU of decoded images keyed by path and mtime, used by
+// Image.open/openSync with {cache: true}. Hits hand back a copy of the
+// cached pixels - callers may mutate their image freely - while the
+// decode, which dominates for large rasters, runs only when the file is
+// first seen or has changed on disk. Entries beyond max_entries are
+// evicted least-recently-used; mapnik.clearCache() empties the cache.
+struct image_cache_entry
+{
+    image_ptr image;
+    std::time_t mtime;
+    std::list<std::string>::iterator order_itr;
+};
+
+std::list<std::string> image_cache_order;
+std::map<std::string, image_cache_entry> image_cache;
+std::mutex image_cache_mutex;
+const std::size_t image_cache_max_entries = 8;
+
+bool image_file_mtime(std::string const& path, std::time_t & mtime)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    mtime = st.st_mtime;
+    return true;
+}
+
+// decodes an image file exactly like the original open paths, consulting
+// the cache when requested; throws on unsupported formats
+image_ptr open_image_file(std::string const& filename, bool use_cache)
+{
+    std::time_t mtime = 0;
+    bool have_mtime = use_cache && image_file_mtime(filename, mtime);
+    if (have_mtime)
+    {
+        image_ptr master;
+        {
+            std::lock_guard<std::mutex> lock(image_cache_mutex);
+            std::map<std::string, image_cache_entry>::iterator itr = image_cache.find(filename);
+            if (itr != image_cache.end() && itr->second.mtime == mtime)
+            {
+                image_cache_order.splice(image_cache_order.begin(), image_cache_order, itr->second.order_itr);
+                master = itr->second.image;
+            }
+        }
+        if (master)
+        {
+            // copy outside the lock - the cached master is immutable
+            return std::make_shared<mapnik::image_any>(*master);
+        }
+    }
+    boost::optional<std::string> type = mapnik::type_from_filename(filename);
+    if (!type)
+    {
+        throw std::runtime_error("Unsupported image format:" + filename);
+    }
+    std::unique_ptr<mapnik::image_reader> reader(mapnik::get_image_reader(filename,*type));
+    if (!reader.get())
+    {
+        /* LCOV_EXCL_START */
+        throw std::runtime_error("Failed to load: " + filename);
+        /* LCOV_EXCL_STOP */
+    }
+    image_ptr image = std::make_shared<mapnik::image_any>(reader->read(0,0,reader->width(),reader->height()));
+    if (!reader->has_alpha())
+    {
+        mapnik::set_premultiplied_alpha(*image, true);
+    }
+    if (have_mtime)
+    {
+        {
+            std::lock_guard<std::mutex> lock(image_cache_mutex);
+            std::map<std::string, image_cache_entry>::iterator itr = image_cache.find(filename);
+            if (itr != image_cache.end())
+            {
+                image_cache_order.erase(itr->second.order_itr);
+                image_cache.erase(itr);
+            }
+            image_cache_order.push_front(filename);
+            image_cache_entry entry;
+            entry.image = image;
+            entry.mtime = mtime;
+            entry.order_itr = image_cache_order.begin();
+            image_cache[filename] = entry;
+            while (image_cache.size() > image_cache_max_entries)
+            {
+                image_cache.erase(image_cache_order.back());
+                image_cache_order.pop_back();
+            }
+        }
+        // the cached master must not alias the image handed to the caller
+        return std::make_shared<mapnik::image_any>(*image);
+    }
+    return image;
+}
+
+bool parse_open_cache_option(Nan::NAN_METHOD_ARGS_TYPE info, int idx, bool & use_cache)
+{
+    if (info.Length() <= idx || info[idx]->IsFunction()) return true;
+    if (!info[idx]->IsObject())
+    {
+        Nan::ThrowTypeError("optional second argument must be an options object");
+        return false;
+    }
+    v8::Local<v8::Object> options = info[idx]->ToObject();
+    if (options->Has(Nan::New("cache").ToLocalChecked()))
+    {
+        v8::Local<v8::Value> param_val = options->Get(Nan::New("cache").ToLocalChecked());
+        if (!param_val->IsBoolean())
+        {
+            Nan::ThrowTypeError("'cache' must be a Boolean");
+            return false;
+        }
+        use_cache = param_val->BooleanValue();
+    }
+    return true;
+}
+
+// LRU of rasterized SVG results keyed by content hash and scale, used
+// by the buffer-based fromSVG paths where the content is in hand. Hits
+// return a copy of the cached pixels; total cached bytes are capped.
+struct svg_cache_entry
+{
+    image_ptr image;
+    std::size_t bytes;
+    std::list<std::uint64_t>::iterator order_itr;
+};
+
+std::list<std::uint64_t> svg_cache_order;
+std::map<std::uint64_t, svg_cache_entry> svg_cache;
+std::mutex svg_cache_mutex;
+std::size_t svg_cache_bytes = 0;
+const std::size_t svg_cache_max_bytes = 32 * 1024 * 1024;
+
+std::uint64_t svg_cache_key(const char * data, std::size_t size, double scale)
+{
+    std::uint64_t h = 1469598103934665603ULL;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ULL;
+    }
+    std::uint64_t scale_bits;
+    std::memcpy(&scale_bits, &scale, sizeof(scale_bits));
+    for (unsigned i = 0; i < 8; ++i)
+    {
+        h ^= (scale_bits >> (i * 8)) & 0xFF;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+image_ptr svg_cache_find(std::uint64_t key)
+{
+    image_ptr master;
+    {
+        std::lock_guard<std::mutex> lock(svg_cache_mutex);
+        std::map<std::uint64_t, svg_cache_entry>::iterator itr = svg_cache.find(key);
+        if (itr == svg_cache.end())
+        {
+            return image_ptr();
+        }
+        svg_cache_order.splice(svg_cache_order.begin(), svg_cache_order, itr->second.order_itr);
+        master = itr->second.image;
+    }
+    // copy outside the lock - the cached master is immutable
+    return std::make_shared<mapnik::image_any>(*master);
+}
+
+void svg_cache_insert(std::uint64_t key, image_ptr const& image)
+{
+    image_ptr master = std::make_shared<mapnik::image_any>(*image);
+    std::size_t bytes = master->size();
+    if (bytes > svg_cache_max_bytes) return;
+    std::lock_guard<std::mutex> lock(svg_cache_mutex);
+    std::map<std::uint64_t, svg_cache_entry>::iterator itr = svg_cache.find(key);
+    if (itr != svg_cache.end())
+    {
+        return; // raced with another rasterization of the same content
+    }
+    svg_cache_order.push_front(key);
+    svg_cache_entry entry;
+    entry.image = master;
+    entry.bytes = bytes;
+    entry.order_itr = svg_cache_order.begin();
+    svg_cache[key] = entry;
+    svg_cache_bytes += bytes;
+    while (svg_cache_bytes > svg_cache_max_bytes && !svg_cache_order.empty())
+    {
+        std::map<std::uint64_t, svg_cache_entry>::iterator evict = svg_cache.find(svg_cache_order.back());
+        svg_cache_bytes -= evict->second.bytes;
+        svg_cache.erase(evict);
+        svg_cache_order.pop_back();
+    }
+}
+
+} // anonymous namespace
+
+void Image::clear_image_cache()
+{
+    {
+        std::lock_guard<std::mutex> lock(image_cache_mutex);
+        image_cache.clear();
+        image_cache_order.clear();
+    }
+    std::lock_guard<std::mutex> lock(svg_cache_mutex);
+    svg_cache.clear();
+    svg_cache_order.clear();
+    svg_cache_bytes = 0;
+}
+
 v8::Local<v8::Value> Image::_openSync(Nan::NAN_METHOD_ARGS_TYPE info)
 {
     Nan::EscapableHandleScope scope;
@@ -2349,27 +2646,19 @@ v8::Local<v8::Value> Image::_openSync(Nan::NAN_METHOD_ARGS_TYPE info)
         return scope.Escape(Nan::Undefined());
     }
 
+    bool use_cache = false;
+    if (!parse_open_cache_option(info, 1, use_cache))
+    {
+        return scope.Escape(Nan::Undefined());
+    }
+
     try
     {
         std::string filename = TOSTR(info[0]);
-        boost::optional<std::string> type = mapnik::type_from_filename(filename);
-        if (type)
-        {
-            std::unique_ptr<mapnik::image_reader> reader(mapnik::get_image_reader(filename,*type));
-            if (reader.get())
-            {
-                std::shared_ptr<mapnik::image_any> image_ptr = std::make_shared<mapnik::image_any>(reader->read(0,0,reader->width(), reader->height()));
-                if (!reader->has_alpha())
-                {
-                    mapnik::set_premultiplied_alpha(*image_ptr, true);
-                }
-                Image* im = new Image(image_ptr);
-                v8::Local<v8::Value> ext = Nan::New<v8::External>(im);
-                return scope.Escape(Nan::New(constructor)->GetFunction()->NewInstance(1, &ext));
-            }
-        }
-        Nan::ThrowTypeError(("Unsupported image format:" + filename).c_str());
-        return scope.Escape(Nan::Undefined());
+        image_ptr image = open_image_file(filename, use_cache);
+        Image* im = new Image(image);
+        v8::Local<v8::Value> ext = Nan::New<v8::External>(im);
+        return scope.Escape(Nan::New(constructor)->GetFunction()->NewInstance(1, &ext));
     }
     catch (std::exception const& ex)
     {
@@ -2393,6 +2682,7 @@ typedef struct {
     uv_work_t request;
     image_ptr im;
     std::string filename;
+    bool cache;
     bool error;
     std::string error_name;
     Nan::Persistent<v8::Function> cb;
@@ -2413,7 +2703,7 @@ typedef struct {
  */
 NAN_METHOD(Image::open)
 {
-    if (info.Length() == 1) {
+    if (info.Length() == 1 || !info[info.Length()-1]->IsFunction()) {
         info.GetReturnValue().Set(_openSync(info));
         return;
     }
@@ -2435,9 +2725,16 @@ NAN_METHOD(Image::open)
         return;
     }
 
+    bool use_cache = false;
+    if (!parse_open_cache_option(info, 1, use_cache))
+    {
+        return;
+    }
+
     image_file_ptr_baton_t *closure = new image_file_ptr_baton_t();
     closure->request.data = closure;
     closure->filename = TOSTR(info[0]);
+    closure->cache = use_cache;
     closure->error = false;
     closure->cb.Reset(callback.As<v8::Function>());
     uv_queue_work(uv_default_loop(), &closure->request, EIO_Open, (uv_after_work_cb)EIO_AfterOpen);
@@ -2450,34 +2747,7 @@ void Image::EIO_Open(uv_work_t* req)
 
     try
     {
-        boost::optional<std::string> type = mapnik::type_from_filename(closure->filename);
-        if (!type)
-        {
-            closure->error = true;
-            closure->error_name = "Unsupported image format: " + closure->filename;
-        }
-        else
-        {
-            std::unique_ptr<mapnik::image_reader> reader(mapnik::get_image_reader(closure->filename,*type));
-            if (reader.get())
-            {
-                closure->im = std::make_shared<mapnik::image_any>(reader->read(0,0,reader->width(),reader->height()));
-                if (!reader->has_alpha())
-                {
-                    mapnik::set_premultiplied_alpha(*(closure->im), true);
-                }
-            }
-            else
-            {
-                // The only way this is ever reached is if the reader factory in 
-                // mapnik was not providing an image type it should. This should never
-                // be occuring so marking this out from coverage
-                /* LCOV_EXCL_START */
-                closure->error = true;
-                closure->error_name = "Failed to load: " + closure->filename;
-                /* LCOV_EXCL_STOP */
-            }
-        }
+        closure->im = open_image_file(closure->filename, closure->cache);
     }
     catch (std::exception const& ex)
     {
@@ -2619,6 +2889,14 @@ v8::Local<v8::Value> Image::_fromSVGSync(bool fromFile, Nan::NAN_METHOD_ARGS_TYP
                 return scope.Escape(Nan::Undefined());
             }
             std::string svg_buffer(node::Buffer::Data(obj),node::Buffer::Length(obj));
+            std::uint64_t cache_key = svg_cache_key(svg_buffer.data(), svg_buffer.size(), scale);
+            image_ptr cached = svg_cache_find(cache_key);
+            if (cached)
+            {
+                Image *im_cached = new Image(cached);
+                v8::Local<v8::Value> ext = Nan::New<v8::External>(im_cached);
+                return scope.Escape(Nan::New(constructor)->GetFunction()->NewInstance(1, &ext));
+            }
             if (!p.parse_from_string(svg_buffer))
             {
                 std::ostringstream errorMessage("");
@@ -2677,6 +2955,11 @@ v8::Local<v8::Value> Image::_fromSVGSync(bool fromFile, Nan::NAN_METHOD_ARGS_TYP
         mapnik::demultiply_alpha(im);
 
         std::shared_ptr<mapnik::image_any> image_ptr = std::make_shared<mapnik::image_any>(im);
+        if (!fromFile)
+        {
+            v8::Local<v8::Object> obj = info[0]->ToObject();
+            svg_cache_insert(svg_cache_key(node::Buffer::Data(obj), node::Buffer::Length(obj), scale), image_ptr);
+        }
         Image *im2 = new Image(image_ptr);
         v8::Local<v8::Value> ext = Nan::New<v8::External>(im2);
         return scope.Escape(Nan::New(constructor)->GetFunction()->NewInstance(1, &ext));
@@ -2985,6 +3268,12 @@ void Image::EIO_FromSVGBytes(uv_work_t* req)
         svg_converter_type svg(svg_path, marker_path->attributes());
         svg_parser p(svg);
 
+        std::uint64_t cache_key = svg_cache_key(closure->data, closure->dataLength, closure->scale);
+        closure->im = svg_cache_find(cache_key);
+        if (closure->im)
+        {
+            return;
+        }
         std::string svg_buffer(closure->data,closure->dataLength);
         if (!p.parse_from_string(svg_buffer))
         {
@@ -3044,6 +3333,7 @@ void Image::EIO_FromSVGBytes(uv_work_t* req)
         svg_renderer_this.render(ras_ptr, sl, renb, mtx, opacity, bbox);
         mapnik::demultiply_alpha(im);
         closure->im = std::make_shared<mapnik::image_any>(im);
+        svg_cache_insert(cache_key, closure->im);
     }
     catch (std::exception const& ex)
     {
@@ -3422,16 +3712,18 @@ NAN_METHOD(Image::encodeSync)
     }
 
     try {
-        std::string s;
+        std::string s = node_mapnik::output_buffer_pool::instance().acquire();
+        node_mapnik::string_sink_buf sink(s);
+        std::ostream stream(&sink);
         if (palette.get())
         {
-            s = save_to_string(*(im->this_), format, *palette);
+            save_to_stream(*(im->this_), stream, format, *palette);
         }
         else {
-            s = save_to_string(*(im->this_), format);
+            save_to_stream(*(im->this_), stream, format);
         }
 
-        info.GetReturnValue().Set(Nan::CopyBuffer((char*)s.data(), s.size()).ToLocalChecked());
+        info.GetReturnValue().Set(node_mapnik::pooled_buffer_to_v8(std::move(s)));
     }
     catch (std::exception const& ex)
     {
@@ -3445,6 +3737,7 @@ typedef struct {
     Image* im;
     std::string format;
     palette_ptr palette;
+    node_mapnik::async_trace trace;
     bool error;
     std::string error_name;
     Nan::Persistent<v8::Function> cb;
@@ -3544,15 +3837,19 @@ NAN_METHOD(Image::encode)
 void Image::EIO_Encode(uv_work_t* req)
 {
     encode_image_baton_t *closure = static_cast<encode_image_baton_t *>(req->data);
+    node_mapnik::trace_scope tracing(closure->trace, "image.encode");
 
     try {
+        closure->result = node_mapnik::output_buffer_pool::instance().acquire();
+        node_mapnik::string_sink_buf sink(closure->result);
+        std::ostream stream(&sink);
         if (closure->palette.get())
         {
-            closure->result = save_to_string(*(closure->im->this_), closure->format, *closure->palette);
+            save_to_stream(*(closure->im->this_), stream, closure->format, *closure->palette);
         }
         else
         {
-            closure->result = save_to_string(*(closure->im->this_), closure->format);
+            save_to_stream(*(closure->im->this_), stream, closure->format);
         }
     }
     catch (std::exception const& ex)
@@ -3574,7 +3871,7 @@ void Image::EIO_AfterEncode(uv_work_t* req)
     }
     else
     {
-        v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::CopyBuffer((char*)closure->result.data(), closure->result.size()).ToLocalChecked() };
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), node_mapnik::pooled_buffer_to_v8(std::move(closure->result)) };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
     }
 
@@ -3981,7 +4278,7 @@ void Image::EIO_Composite(uv_work_t* req)
             {
                 mapnik::util::apply_visitor(visitor, filter_tag);
             }
-            mapnik::premultiply_alpha(*closure->im2->this_);
+            node_mapnik::premultiply_alpha(*closure->im2->this_);
         }
         mapnik::composite(*closure->im1->this_,*closure->im2->this_, closure->mode, closure->opacity, closure->dx, closure->dy);
     }
@@ -4069,10 +4366,63 @@ NAN_SETTER(Image::set_offset)
  * var img = new mapnik.Image.open('./path/to/image.png');
  * var buffr = img.data();
  */
+namespace {
+
+void release_image_data_ref(char*, void* hint)
+{
+    delete static_cast<image_ptr*>(hint);
+}
+
+} // anonymous namespace
+
+/**
+ * Get the image's pixel bytes. By default a copy is returned; with
+ * {alias: true} the Buffer aliases the underlying pixel storage with no
+ * copy, so typed-array views over it read and write the image directly
+ * at memory speed. The aliased storage is co-owned by the Buffer and
+ * stays valid even if the Image is collected, but operations that
+ * replace the image's buffer (resize, copy) detach it from the Image.
+ * Writers are responsible for respecting the premultiplication state
+ * reported by premultiplied().
+ *
+ * @name data
+ * @instance
+ * @memberof Image
+ * @param {Object} [options] options with an `alias` key
+ * @returns {Buffer} pixel data
+ */
 NAN_METHOD(Image::data)
 {
     Image* im = Nan::ObjectWrap::Unwrap<Image>(info.Holder());
-    // TODO - make this zero copy
+    bool alias = false;
+    if (info.Length() >= 1)
+    {
+        if (!info[0]->IsObject())
+        {
+            Nan::ThrowTypeError("optional first argument must be an options object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[0]->ToObject();
+        if (options->Has(Nan::New("alias").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("alias").ToLocalChecked());
+            if (!param_val->IsBoolean())
+            {
+                Nan::ThrowTypeError("'alias' must be a Boolean");
+                return;
+            }
+            alias = param_val->BooleanValue();
+        }
+    }
+    if (alias)
+    {
+        image_ptr * ref = new image_ptr(im->this_);
+        info.GetReturnValue().Set(Nan::NewBuffer(reinterpret_cast<char *>(im->this_->bytes()),
+                                                 im->this_->size(),
+                                                 release_image_data_ref,
+                                                 ref).ToLocalChecked());
+        return;
+    }
     info.GetReturnValue().Set(Nan::CopyBuffer(reinterpret_cast<const char *>(im->this_->bytes()), im->this_->size()).ToLocalChecked());
 }
 
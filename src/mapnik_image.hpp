@@ -16,6 +16,8 @@ namespace mapnik {
     enum image_dtype : std::uint8_t;
 }
 
+#include "memory_stats.hpp"
+
 typedef std::shared_ptr<mapnik::image_any> image_ptr;
 
 class Image: public Nan::ObjectWrap {
@@ -40,6 +42,7 @@ public:
     static NAN_METHOD(openSync);
     static NAN_METHOD(open);
     static void EIO_Open(uv_work_t* req);
+    static void clear_image_cache();
     static void EIO_AfterOpen(uv_work_t* req);
     static v8::Local<v8::Value> _fromBytesSync(Nan::NAN_METHOD_ARGS_TYPE info);
     static v8::Local<v8::Value> _fromBufferSync(Nan::NAN_METHOD_ARGS_TYPE info);
@@ -124,6 +127,7 @@ public:
 private:
     ~Image();
     image_ptr this_;
+    node_mapnik::object_tracker tracker_;
 };
 
 #endif
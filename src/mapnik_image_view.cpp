@@ -7,6 +7,7 @@
 
 #include "mapnik_image.hpp"
 #include "mapnik_image_view.hpp"
+#include "output_buffer_pool.hpp"
 #include "mapnik_color.hpp"
 #include "mapnik_palette.hpp"
 #include "utils.hpp"
@@ -425,7 +426,7 @@ NAN_METHOD(ImageView::encodeSync)
             s = save_to_string(*(im->this_), format);
         }
 
-        info.GetReturnValue().Set(Nan::CopyBuffer((char*)s.data(),s.size()).ToLocalChecked());
+        info.GetReturnValue().Set(node_mapnik::pooled_buffer_to_v8(std::move(s)));
     }
     catch (std::exception const& ex)
     {
@@ -541,7 +542,7 @@ void ImageView::EIO_AfterEncode(uv_work_t* req)
     }
     else
     {
-        v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::CopyBuffer((char*)closure->result.data(), closure->result.size()).ToLocalChecked() };
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), node_mapnik::pooled_buffer_to_v8(std::move(closure->result)) };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
     }
 
@@ -8,6 +8,10 @@
 #include "mapnik_image.hpp"             // for Image, Image::constructor
 #include "mapnik_layer.hpp"             // for Layer, Layer::constructor
 #include "mapnik_palette.hpp"           // for palette_ptr, Palette, etc
+#include "mapnik_plugins.hpp"
+#include "job_scheduler.hpp"
+#include "async_metrics.hpp"
+#include "output_buffer_pool.hpp"
 #include "mapnik_vector_tile.hpp"
 #include "object_to_container.hpp"
 
@@ -27,6 +31,8 @@
 #include <mapnik/image.hpp>             // for image_rgba8
 #include <mapnik/image_any.hpp>
 #include <mapnik/image_util.hpp>        // for save_to_file, guess_type, etc
+#include <mapnik/image_view.hpp>        // for image_view_rgba8
+#include <mapnik/image_view_any.hpp>    // for image_view_any
 #include <mapnik/layer.hpp>             // for layer
 #include <mapnik/load_map.hpp>          // for load_map, load_map_string
 #include <mapnik/map.hpp>               // for Map, etc
@@ -37,13 +43,25 @@
 #if defined(HAVE_CAIRO)
 #include <mapnik/cairo_io.hpp>
 #endif
+#if defined(HAVE_PNG)
+#include <png.h>
+#endif
 
 // stl
+#include <chrono>                       // for steady_clock
+#include <csetjmp>                      // for setjmp (banded png writing)
+#include <cstdio>                       // for fopen, fclose
+#include <ctime>                        // for time_t
 #include <exception>                    // for exception
+#include <future>                       // for async, future
 #include <iosfwd>                       // for ostringstream, ostream
+#include <map>                          // for map
+#include <mutex>                        // for mutex, lock_guard
 #include <ostream>                      // for operator<<, basic_ostream, etc
 #include <sstream>                      // for basic_ostringstream, etc
 
+#include <sys/stat.h>                   // for stat
+
 // boost
 #include <boost/optional/optional.hpp>  // for optional
 
@@ -117,6 +135,7 @@ void Map::Initialize(v8::Local<v8::Object> target) {
 
     Nan::SetPrototypeMethod(lcons, "render", render);
     Nan::SetPrototypeMethod(lcons, "renderSync", renderSync);
+    Nan::SetPrototypeMethod(lcons, "renderMetatile", renderMetatile);
     Nan::SetPrototypeMethod(lcons, "renderFile", renderFile);
     Nan::SetPrototypeMethod(lcons, "renderFileSync", renderFileSync);
 
@@ -465,6 +484,20 @@ NAN_METHOD(Map::memoryFonts)
     info.GetReturnValue().Set(a);
 }
 
+namespace {
+
+// Process-wide cache of font directory scans keyed by path and recurse
+// flag. The first Map to register a directory pays the filesystem walk
+// and face-name probing; later maps merge the cached name-to-file
+// mapping into their own font mapping without touching the disk again.
+// Actual FreeType faces stay lazily loaded - mapnik's font cache only
+// opens a face when a glyph from it is first needed during rendering.
+typedef std::map<std::string, std::pair<int,std::string> > font_file_mapping_type;
+std::map<std::string, font_file_mapping_type> font_scan_cache;
+std::mutex font_scan_cache_mutex;
+
+} // anonymous namespace
+
 NAN_METHOD(Map::registerFonts)
 {
     Map* m = Nan::ObjectWrap::Unwrap<Map>(info.Holder());
@@ -496,7 +529,36 @@ NAN_METHOD(Map::registerFonts)
         }
     }
     std::string path = TOSTR(info[0]);
-    info.GetReturnValue().Set(Nan::New(m->map_->register_fonts(path,recurse)));
+    std::string key = path + (recurse ? "|r" : "|n");
+    {
+        std::lock_guard<std::mutex> lock(font_scan_cache_mutex);
+        std::map<std::string, font_file_mapping_type>::const_iterator itr = font_scan_cache.find(key);
+        if (itr != font_scan_cache.end())
+        {
+            auto & mapping = m->map_->get_font_file_mapping();
+            for (auto const& kv : itr->second)
+            {
+                mapping.emplace(kv.first, kv.second);
+            }
+            info.GetReturnValue().Set(Nan::New(!itr->second.empty()));
+            return;
+        }
+    }
+    bool map_was_empty = m->map_->get_font_file_mapping().empty();
+    bool found = m->map_->register_fonts(path,recurse);
+    // only cache when every mapping entry is attributable to this scan;
+    // a map that already carried fonts could shadow part of the result
+    if (map_was_empty)
+    {
+        font_file_mapping_type scanned;
+        for (auto const& kv : m->map_->get_font_file_mapping())
+        {
+            scanned.emplace(kv.first, kv.second);
+        }
+        std::lock_guard<std::mutex> lock(font_scan_cache_mutex);
+        font_scan_cache[key] = std::move(scanned);
+    }
+    info.GetReturnValue().Set(Nan::New(found));
 }
 
 /**
@@ -736,6 +798,32 @@ v8::Local<v8::Value> Map::abstractQueryPoint(Nan::NAN_METHOD_ARGS_TYPE info, boo
     return Nan::Undefined();
 }
 
+namespace {
+
+// holds features drained from a lazy datasource featureset, so JS
+// iteration after a query is pure memory access instead of running the
+// datasource I/O on the event loop
+struct materialized_featureset : mapnik::Featureset
+{
+    explicit materialized_featureset(std::vector<mapnik::feature_ptr> && features) :
+        features_(std::move(features)),
+        idx_(0) {}
+
+    mapnik::feature_ptr next()
+    {
+        if (idx_ < features_.size())
+        {
+            return features_[idx_++];
+        }
+        return mapnik::feature_ptr();
+    }
+
+    std::vector<mapnik::feature_ptr> features_;
+    std::size_t idx_;
+};
+
+} // anonymous namespace
+
 void Map::EIO_QueryMap(uv_work_t* req)
 {
     query_map_baton_t *closure = static_cast<query_map_baton_t *>(req->data);
@@ -743,45 +831,53 @@ void Map::EIO_QueryMap(uv_work_t* req)
     try
     {
         std::vector<mapnik::layer> const& layers = closure->m->map_->layers();
-        if (closure->layer_idx >= 0)
+        // runs the hit test for one layer and drains the lazy featureset
+        // here on the worker, so the datasource I/O never reaches the loop
+        auto query_layer = [closure](std::size_t idx) -> mapnik::featureset_ptr
         {
             mapnik::featureset_ptr fs;
             if (closure->geo_coords)
             {
-                fs = closure->m->map_->query_point(closure->layer_idx,
+                fs = closure->m->map_->query_point(idx,
                                                    closure->x,
                                                    closure->y);
             }
             else
             {
-                fs = closure->m->map_->query_map_point(closure->layer_idx,
+                fs = closure->m->map_->query_map_point(idx,
                                                        closure->x,
                                                        closure->y);
             }
+            if (!fs)
+            {
+                return fs;
+            }
+            std::vector<mapnik::feature_ptr> features;
+            mapnik::feature_ptr feature;
+            while ((feature = fs->next()))
+            {
+                features.push_back(feature);
+            }
+            return std::make_shared<materialized_featureset>(std::move(features));
+        };
+        if (closure->layer_idx >= 0)
+        {
             mapnik::layer const& lyr = layers[closure->layer_idx];
-            closure->featuresets.insert(std::make_pair(lyr.name(),fs));
+            closure->featuresets.insert(std::make_pair(lyr.name(), query_layer(closure->layer_idx)));
         }
         else
         {
-            // query all layers
-            unsigned idx = 0;
-            for (mapnik::layer const& lyr : layers)
+            // query all layers, issuing the per-layer datasource queries
+            // in parallel and merging the results in layer order
+            std::vector<std::future<mapnik::featureset_ptr> > futures;
+            futures.reserve(layers.size());
+            for (std::size_t idx = 0; idx < layers.size(); ++idx)
             {
-                mapnik::featureset_ptr fs;
-                if (closure->geo_coords)
-                {
-                    fs = closure->m->map_->query_point(idx,
-                                                       closure->x,
-                                                       closure->y);
-                }
-                else
-                {
-                    fs = closure->m->map_->query_map_point(idx,
-                                                           closure->x,
-                                                           closure->y);
-                }
-                closure->featuresets.insert(std::make_pair(lyr.name(),fs));
-                ++idx;
+                futures.push_back(std::async(std::launch::async, query_layer, idx));
+            }
+            for (std::size_t idx = 0; idx < layers.size(); ++idx)
+            {
+                closure->featuresets.insert(std::make_pair(layers[idx].name(), futures[idx].get()));
             }
         }
     }
@@ -982,17 +1078,158 @@ NAN_METHOD(Map::resize)
 }
 
 
+namespace {
+
+// Process-wide cache of parsed stylesheets, keyed by path plus the load
+// options that affect parsing. Entries are immutable masters: hits are
+// served by copying, never by handing out the cached map itself. This
+// skips the XML parse entirely when the same stylesheet is loaded
+// repeatedly in one process (the parse dominates Map::loadSync cost for
+// large styles); separate processes still parse once each since mapnik
+// offers no binary serialization of a resolved map.
+struct style_cache_entry
+{
+    map_ptr map;
+    std::time_t mtime;
+};
+
+std::map<std::string, style_cache_entry> style_cache;
+std::mutex style_cache_mutex;
+
+bool stylesheet_mtime(std::string const& path, std::time_t & mtime)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    mtime = st.st_mtime;
+    return true;
+}
+
+std::string style_cache_key(std::string const& stylesheet, bool strict, std::string const& base_path)
+{
+    std::string key = stylesheet;
+    key += strict ? "|1|" : "|0|";
+    key += base_path;
+    return key;
+}
+
+} // anonymous namespace
+
+void Map::clear_style_cache()
+{
+    std::lock_guard<std::mutex> lock(style_cache_mutex);
+    style_cache.clear();
+}
+
 typedef struct {
     uv_work_t request;
     Map *m;
     std::string stylesheet;
     std::string base_path;
     bool strict;
+    bool cache;
     bool error;
     std::string error_name;
     Nan::Persistent<v8::Function> cb;
 } load_xml_baton_t;
 
+namespace {
+
+// applies a freshly parsed stylesheet (master) to a target map the way
+// mapnik::load_map would: map-level settings are overwritten, styles,
+// fontsets, font mappings and layers are appended; the target's
+// dimensions are never touched. The master is only read, but is taken
+// by non-const reference because several mapnik::Map accessors used
+// here lack const overloads.
+void merge_parsed_map(mapnik::Map & target, mapnik::Map & master)
+{
+    target.set_srs(master.srs());
+    target.set_buffer_size(master.buffer_size());
+    if (master.background())
+    {
+        target.set_background(*master.background());
+    }
+    if (master.background_image())
+    {
+        target.set_background_image(*master.background_image());
+    }
+    target.set_background_image_comp_op(master.background_image_comp_op());
+    target.set_background_image_opacity(master.background_image_opacity());
+    if (master.maximum_extent())
+    {
+        target.set_maximum_extent(*master.maximum_extent());
+    }
+    target.set_base_path(master.base_path());
+    mapnik::parameters params = master.get_extra_parameters();
+    target.set_extra_parameters(params);
+    for (auto const& fontset : master.fontsets())
+    {
+        target.insert_fontset(fontset.first, fontset.second);
+    }
+    auto & font_mapping = target.get_font_file_mapping();
+    for (auto const& font : master.get_font_file_mapping())
+    {
+        font_mapping.emplace(font.first, font.second);
+    }
+    for (auto itr = master.begin_styles(); itr != master.end_styles(); ++itr)
+    {
+        target.insert_style(itr->first, itr->second);
+    }
+    for (mapnik::layer const& lyr : master.layers())
+    {
+        target.add_layer(lyr);
+    }
+}
+
+// shared by Map::loadSync and Map::EIO_Load - parses the stylesheet into
+// the target map, consulting the process-wide cache when requested
+void load_map_cached(mapnik::Map & target,
+                     std::string const& stylesheet,
+                     bool strict,
+                     std::string const& base_path,
+                     bool use_cache)
+{
+    if (!use_cache)
+    {
+        node_mapnik::ensure_plugins_registered("");
+        mapnik::load_map(target, stylesheet, strict, base_path);
+        return;
+    }
+    std::time_t mtime = 0;
+    bool have_mtime = stylesheet_mtime(stylesheet, mtime);
+    std::string key = style_cache_key(stylesheet, strict, base_path);
+    map_ptr master;
+    if (have_mtime)
+    {
+        std::lock_guard<std::mutex> lock(style_cache_mutex);
+        std::map<std::string, style_cache_entry>::const_iterator itr = style_cache.find(key);
+        if (itr != style_cache.end() && itr->second.mtime == mtime)
+        {
+            master = itr->second.map;
+        }
+    }
+    if (!master)
+    {
+        // parse into a fresh map so the cached master only ever carries
+        // the stylesheet's own content, never the loading map's layers
+        master = std::make_shared<mapnik::Map>(target.width(), target.height());
+        node_mapnik::ensure_plugins_registered("");
+        mapnik::load_map(*master, stylesheet, strict, base_path);
+        if (have_mtime)
+        {
+            style_cache_entry entry;
+            entry.map = master;
+            entry.mtime = mtime;
+            std::lock_guard<std::mutex> lock(style_cache_mutex);
+            style_cache[key] = entry;
+        }
+    }
+    // cold and warm cached loads take the same path: merge the parsed
+    // master into the target with load_map's append/overwrite semantics
+    merge_parsed_map(target, *master);
+}
+
+} // anonymous namespace
+
 
 /**
  * Load styles, layers, and other information for this map from a Mapnik
@@ -1050,6 +1287,7 @@ NAN_METHOD(Map::load)
 
     load_xml_baton_t *closure = new load_xml_baton_t();
     closure->request.data = closure;
+    closure->cache = false;
 
     param = Nan::New("base").ToLocalChecked();
     if (options->Has(param))
@@ -1062,6 +1300,17 @@ NAN_METHOD(Map::load)
         closure->base_path = TOSTR(param_val);
     }
 
+    param = Nan::New("cache").ToLocalChecked();
+    if (options->Has(param))
+    {
+        v8::Local<v8::Value> param_val = options->Get(param);
+        if (!param_val->IsBoolean()) {
+            Nan::ThrowTypeError("'cache' must be a Boolean");
+            return;
+        }
+        closure->cache = param_val->BooleanValue();
+    }
+
     closure->stylesheet = TOSTR(stylesheet);
     closure->m = m;
     closure->strict = strict;
@@ -1078,7 +1327,7 @@ void Map::EIO_Load(uv_work_t* req)
 
     try
     {
-        mapnik::load_map(*closure->m->map_,closure->stylesheet,closure->strict,closure->base_path);
+        load_map_cached(*closure->m->map_,closure->stylesheet,closure->strict,closure->base_path,closure->cache);
     }
     catch (std::exception const& ex)
     {
@@ -1113,9 +1362,13 @@ void Map::EIO_AfterLoad(uv_work_t* req)
  * @instance
  * @name loadSync
  * @param {string} stylesheet path
- * @param {Object} [options={}]
+ * @param {Object} [options={}] options with optional `strict`, `base`
+ * and `cache` keys. With `cache: true` the parsed stylesheet is kept in
+ * a process-wide cache (keyed by path, options and file mtime) and
+ * repeated loads copy the cached result instead of re-parsing the XML.
+ * Use `mapnik.clearCache()` to drop cached styles.
  * @example
- * map.loadSync('./style.xml');
+ * map.loadSync('./style.xml', {cache: true});
  */
 NAN_METHOD(Map::loadSync)
 {
@@ -1127,6 +1380,7 @@ NAN_METHOD(Map::loadSync)
     Map* m = Nan::ObjectWrap::Unwrap<Map>(info.Holder());
     std::string stylesheet = TOSTR(info[0]);
     bool strict = false;
+    bool cache = false;
     std::string base_path;
 
     if (info.Length() > 2)
@@ -1169,11 +1423,23 @@ NAN_METHOD(Map::loadSync)
             }
             base_path = TOSTR(param_val);
         }
+
+        param = Nan::New("cache").ToLocalChecked();
+        if (options->Has(param))
+        {
+            v8::Local<v8::Value> param_val = options->Get(param);
+            if (!param_val->IsBoolean())
+            {
+                Nan::ThrowTypeError("'cache' must be a Boolean");
+                return;
+            }
+            cache = param_val->BooleanValue();
+        }
     }
 
     try
     {
-        mapnik::load_map(*m->map_,stylesheet,strict,base_path);
+        load_map_cached(*m->map_,stylesheet,strict,base_path,cache);
     }
     catch (std::exception const& ex)
     {
@@ -1251,6 +1517,7 @@ NAN_METHOD(Map::fromStringSync)
 
     try
     {
+        node_mapnik::ensure_plugins_registered("");
         mapnik::load_map_string(*m->map_,stylesheet,strict,base_path);
     }
     catch (std::exception const& ex)
@@ -1356,6 +1623,7 @@ void Map::EIO_FromString(uv_work_t* req)
 
     try
     {
+        node_mapnik::ensure_plugins_registered("");
         mapnik::load_map_string(*closure->m->map_,closure->stylesheet,closure->strict,closure->base_path);
     }
     catch (std::exception const& ex)
@@ -1400,6 +1668,14 @@ NAN_METHOD(Map::clone)
     info.GetReturnValue().Set(Nan::New(constructor)->GetFunction()->NewInstance(1, &ext));
 }
 
+v8::Local<v8::Value> Map::NewInstance(map_ptr m_ptr) {
+    Nan::EscapableHandleScope scope;
+    Map* m = new Map();
+    m->map_ = m_ptr;
+    v8::Local<v8::Value> ext = Nan::New<v8::External>(m);
+    return scope.Escape(Nan::New(constructor)->GetFunction()->NewInstance(1, &ext));
+}
+
 NAN_METHOD(Map::save)
 {
     if (info.Length() != 1 || !info[0]->IsString())
@@ -1497,6 +1773,9 @@ struct image_baton_t {
     mapnik::attributes variables;
     unsigned offset_x;
     unsigned offset_y;
+    bool collect_stats;
+    double render_ms;
+    node_mapnik::async_trace trace;
     bool error;
     std::string error_name;
     Nan::Persistent<v8::Function> cb;
@@ -1507,6 +1786,8 @@ struct image_baton_t {
       variables(),
       offset_x(0),
       offset_y(0),
+      collect_stats(false),
+      render_ms(0.0),
       error(false),
       error_name() {}
 };
@@ -1558,6 +1839,7 @@ struct vector_tile_baton_t {
     mapnik::vector_tile_impl::polygon_fill_type fill_type;
     bool process_all_rings;
     std::launch threading_mode;
+    node_mapnik::async_trace trace;
     std::string error_name;
     Nan::Persistent<v8::Function> cb;
     vector_tile_baton_t() :
@@ -1610,6 +1892,8 @@ NAN_METHOD(Map::render)
         double scale_denominator = 0.0;
         unsigned offset_x = 0;
         unsigned offset_y = 0;
+        bool collect_stats = false;
+        node_mapnik::job_scheduler::priority job_priority = node_mapnik::job_scheduler::priority_normal;
 
         v8::Local<v8::Object> options = Nan::New<v8::Object>();
 
@@ -1671,6 +1955,24 @@ NAN_METHOD(Map::render)
 
                 offset_y = bind_opt->IntegerValue();
             }
+
+            if (options->Has(Nan::New("stats").ToLocalChecked())) {
+                v8::Local<v8::Value> bind_opt = options->Get(Nan::New("stats").ToLocalChecked());
+                if (!bind_opt->IsBoolean()) {
+                    Nan::ThrowTypeError("optional arg 'stats' must be a boolean");
+                    return;
+                }
+                collect_stats = bind_opt->BooleanValue();
+            }
+
+            if (options->Has(Nan::New("priority").ToLocalChecked())) {
+                v8::Local<v8::Value> bind_opt = options->Get(Nan::New("priority").ToLocalChecked());
+                if (!bind_opt->IsString() ||
+                    !node_mapnik::job_scheduler::priority_from_string(TOSTR(bind_opt), job_priority)) {
+                    Nan::ThrowTypeError("optional arg 'priority' must be 'low', 'normal' or 'high'");
+                    return;
+                }
+            }
         }
 
         v8::Local<v8::Object> obj = info[0]->ToObject();
@@ -1687,6 +1989,7 @@ NAN_METHOD(Map::render)
             closure->scale_denominator = scale_denominator;
             closure->offset_x = offset_x;
             closure->offset_y = offset_y;
+            closure->collect_stats = collect_stats;
             closure->error = false;
 
             if (options->Has(Nan::New("variables").ToLocalChecked()))
@@ -1707,7 +2010,7 @@ NAN_METHOD(Map::render)
                 return;
             }
             closure->cb.Reset(info[info.Length() - 1].As<v8::Function>());
-            uv_queue_work(uv_default_loop(), &closure->request, EIO_RenderImage, (uv_after_work_cb)EIO_AfterRenderImage);
+            node_mapnik::job_scheduler::instance().queue(&closure->request, EIO_RenderImage, (uv_after_work_cb)EIO_AfterRenderImage, job_priority);
 
         }
 #if defined(GRID_RENDERER)
@@ -1824,7 +2127,7 @@ NAN_METHOD(Map::render)
                 return;
             }
             closure->cb.Reset(info[info.Length() - 1].As<v8::Function>());
-            uv_queue_work(uv_default_loop(), &closure->request, EIO_RenderGrid, (uv_after_work_cb)EIO_AfterRenderGrid);
+            node_mapnik::job_scheduler::instance().queue(&closure->request, EIO_RenderGrid, (uv_after_work_cb)EIO_AfterRenderGrid, job_priority);
         }
 #endif
         else if (Nan::New(VectorTile::constructor)->HasInstance(obj)) 
@@ -1944,6 +2247,23 @@ NAN_METHOD(Map::render)
                 }
             }
 
+            if (options->Has(Nan::New("threads").ToLocalChecked()))
+            {
+                // convenience alias for threading_mode: more than one
+                // thread requests concurrent per-layer processing inside
+                // the vector tile processor (which sizes its worker group
+                // to the layer count), one thread keeps it sequential
+                v8::Local<v8::Value> param_val = options->Get(Nan::New("threads").ToLocalChecked());
+                if (!param_val->IsNumber() || param_val->IntegerValue() < 1)
+                {
+                    delete closure;
+                    Nan::ThrowTypeError("option 'threads' must be a positive integer");
+                    return;
+                }
+                closure->threading_mode = param_val->IntegerValue() > 1 ?
+                    std::launch::async : std::launch::deferred;
+            }
+
             if (options->Has(Nan::New("simplify_distance").ToLocalChecked())) 
             {
                 v8::Local<v8::Value> param_val = options->Get(Nan::New("simplify_distance").ToLocalChecked());
@@ -2002,7 +2322,8 @@ NAN_METHOD(Map::render)
                 return;
             }
             closure->cb.Reset(info[info.Length() - 1].As<v8::Function>());
-            uv_queue_work(uv_default_loop(), &closure->request, EIO_RenderVectorTile, (uv_after_work_cb)EIO_AfterRenderVectorTile);
+            closure->d->detach_tile();
+            node_mapnik::job_scheduler::instance().queue(&closure->request, EIO_RenderVectorTile, (uv_after_work_cb)EIO_AfterRenderVectorTile, job_priority);
         } 
         else 
         {
@@ -2026,6 +2347,7 @@ NAN_METHOD(Map::render)
 void Map::EIO_RenderVectorTile(uv_work_t* req)
 {
     vector_tile_baton_t *closure = static_cast<vector_tile_baton_t *>(req->data);
+    node_mapnik::trace_scope tracing(closure->trace, "map.render.vectortile");
     try
     {
         mapnik::Map const& map = *closure->m->get();
@@ -2064,9 +2386,10 @@ void Map::EIO_AfterRenderVectorTile(uv_work_t* req)
     {
         v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
-    } 
-    else 
+    }
+    else
     {
+        closure->d->invalidate_query_index();
         v8::Local<v8::Value> argv[2] = { Nan::Null(), closure->d->handle() };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
     }
@@ -2184,9 +2507,11 @@ struct agg_renderer_visitor
 void Map::EIO_RenderImage(uv_work_t* req)
 {
     image_baton_t *closure = static_cast<image_baton_t *>(req->data);
+    node_mapnik::trace_scope tracing(closure->trace, "map.render.image");
 
     try
     {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
         mapnik::Map const& map = *closure->m->map_;
         mapnik::request m_req(map.width(),map.height(),map.get_current_extent());
         m_req.set_buffer_size(closure->buffer_size);
@@ -2198,6 +2523,11 @@ void Map::EIO_RenderImage(uv_work_t* req)
                                    closure->offset_y,
                                    closure->scale_denominator);
         mapnik::util::apply_visitor(visit, *closure->im->get());
+        if (closure->collect_stats)
+        {
+            closure->render_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        }
     }
     catch (std::exception const& ex)
     {
@@ -2215,6 +2545,12 @@ void Map::EIO_AfterRenderImage(uv_work_t* req)
     if (closure->error) {
         v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+    } else if (closure->collect_stats) {
+        // per-call render telemetry requested with {stats: true}
+        v8::Local<v8::Object> stats = Nan::New<v8::Object>();
+        stats->Set(Nan::New("render_ms").ToLocalChecked(), Nan::New<v8::Number>(closure->render_ms));
+        v8::Local<v8::Value> argv[3] = { Nan::Null(), closure->im->handle(), stats };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 3, argv);
     } else {
         v8::Local<v8::Value> argv[2] = { Nan::Null(), closure->im->handle() };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
@@ -2237,11 +2573,343 @@ typedef struct {
     mapnik::attributes variables;
     bool use_cairo;
     int buffer_size; // TODO - no effect until mapnik::request is used
+    unsigned bands;
     bool error;
     std::string error_name;
     Nan::Persistent<v8::Function> cb;
 } render_file_baton_t;
 
+#if defined(HAVE_PNG)
+namespace {
+
+// Renders the map in horizontal bands and streams each band's rows
+// straight into a libpng writer, so peak memory is one band rather than
+// the full canvas. Only the rows of a band exist at any time; features
+// crossing band boundaries are covered by the request buffer like any
+// other clipped render (label placement near band edges may differ
+// from a single-pass render, the same caveat metatiling has).
+void render_file_banded(render_file_baton_t *closure)
+{
+    mapnik::Map const& map = *closure->m->map_;
+    unsigned width = map.width();
+    unsigned height = map.height();
+    unsigned bands = closure->bands > height ? height : closure->bands;
+
+    FILE * file = std::fopen(closure->output.c_str(), "wb");
+    if (file == nullptr)
+    {
+        throw std::runtime_error("cannot open file for writing: " + closure->output);
+    }
+    png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info_ptr = png_ptr ? png_create_info_struct(png_ptr) : nullptr;
+    if (info_ptr == nullptr)
+    {
+        /* LCOV_EXCL_START */
+        if (png_ptr) png_destroy_write_struct(&png_ptr, nullptr);
+        std::fclose(file);
+        throw std::runtime_error("could not initialize png writer");
+        /* LCOV_EXCL_STOP */
+    }
+    if (setjmp(png_jmpbuf(png_ptr)))
+    {
+        /* LCOV_EXCL_START */
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        std::fclose(file);
+        throw std::runtime_error("error writing png: " + closure->output);
+        /* LCOV_EXCL_STOP */
+    }
+    png_init_io(png_ptr, file);
+    png_set_IHDR(png_ptr, info_ptr, width, height, 8,
+                 PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png_ptr, info_ptr);
+
+    // the band renders can throw C++ exceptions (bad expressions,
+    // datasource failures), which the setjmp path above does not cover -
+    // release the png structs and the file before rethrowing so a failed
+    // export does not leak them in a long-lived server
+    try
+    {
+        mapnik::box2d<double> const& extent = map.get_current_extent();
+        double pixel_height = (extent.maxy() - extent.miny()) / height;
+        for (unsigned band = 0; band < bands; ++band)
+        {
+            unsigned y0 = band * height / bands;
+            unsigned y1 = (band + 1) * height / bands;
+            unsigned band_height = y1 - y0;
+            mapnik::box2d<double> band_extent(extent.minx(),
+                                              extent.maxy() - y1 * pixel_height,
+                                              extent.maxx(),
+                                              extent.maxy() - y0 * pixel_height);
+            mapnik::image_rgba8 im(width, band_height);
+            mapnik::request m_req(width, band_height, band_extent);
+            m_req.set_buffer_size(closure->buffer_size);
+            mapnik::agg_renderer<mapnik::image_rgba8> ren(map,
+                                                          m_req,
+                                                          closure->variables,
+                                                          im,
+                                                          closure->scale_factor);
+            ren.apply(closure->scale_denominator);
+            for (unsigned row = 0; row < band_height; ++row)
+            {
+                png_write_row(png_ptr, const_cast<png_bytep>(im.bytes() + row * im.row_size()));
+            }
+        }
+        png_write_end(png_ptr, info_ptr);
+    }
+    catch (...)
+    {
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        std::fclose(file);
+        std::remove(closure->output.c_str());
+        throw;
+    }
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    std::fclose(file);
+}
+
+} // anonymous namespace
+#endif // defined(HAVE_PNG)
+
+struct render_metatile_baton_t {
+    uv_work_t request;
+    Map *m;
+    unsigned tile_size;
+    unsigned tiles_x;
+    unsigned tiles_y;
+    std::string format;
+    int buffer_size;
+    double scale_factor;
+    double scale_denominator;
+    mapnik::attributes variables;
+    std::vector<std::string> results;
+    bool error;
+    std::string error_name;
+    Nan::Persistent<v8::Function> cb;
+    render_metatile_baton_t() :
+      tile_size(256),
+      tiles_x(0),
+      tiles_y(0),
+      format("png"),
+      buffer_size(0),
+      scale_factor(1.0),
+      scale_denominator(0.0),
+      variables(),
+      results(),
+      error(false),
+      error_name() {}
+};
+
+/**
+ * Render the map's full canvas once, then slice it into tile_size
+ * sub-tiles and encode them on parallel tasks, returning the encoded
+ * Buffers in row-major order. Amortizes the datasource queries of a
+ * metatile render without one encode round trip per sub-tile.
+ *
+ * @name renderMetatile
+ * @memberof Map
+ * @instance
+ * @param {Object} [options={}] options with optional `tile_size`
+ * (default 256; map width and height must be multiples of it),
+ * `format` (default 'png'), `buffer_size`, `scale`, `scale_denominator`
+ * and `variables` keys
+ * @param {Function} callback - `function(err, buffers)` where buffers is
+ * an array of encoded sub-tiles, left to right then top to bottom
+ * @example
+ * var map = new mapnik.Map(2048, 2048);
+ * map.loadSync('./style.xml');
+ * map.zoomAll();
+ * map.renderMetatile({tile_size: 256}, function(err, buffers) {
+ *   if (err) throw err;
+ *   console.log(buffers.length); // 64
+ * });
+ */
+NAN_METHOD(Map::renderMetatile)
+{
+    Map* m = Nan::ObjectWrap::Unwrap<Map>(info.Holder());
+
+    v8::Local<v8::Value> callback = info[info.Length()-1];
+    if (info.Length() < 1 || !callback->IsFunction())
+    {
+        Nan::ThrowTypeError("last argument must be a callback function");
+        return;
+    }
+
+    std::unique_ptr<render_metatile_baton_t> closure(new render_metatile_baton_t());
+    closure->request.data = closure.get();
+    closure->m = m;
+
+    if (info.Length() > 1)
+    {
+        if (!info[0]->IsObject())
+        {
+            Nan::ThrowTypeError("optional first argument must be an options object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[0]->ToObject();
+        if (options->Has(Nan::New("tile_size").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("tile_size").ToLocalChecked());
+            if (!param_val->IsNumber() || param_val->IntegerValue() <= 0)
+            {
+                Nan::ThrowTypeError("option 'tile_size' must be a positive integer");
+                return;
+            }
+            closure->tile_size = static_cast<unsigned>(param_val->IntegerValue());
+        }
+        if (options->Has(Nan::New("format").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("format").ToLocalChecked());
+            if (!param_val->IsString())
+            {
+                Nan::ThrowTypeError("option 'format' must be a string");
+                return;
+            }
+            closure->format = TOSTR(param_val);
+        }
+        if (options->Has(Nan::New("buffer_size").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("buffer_size").ToLocalChecked());
+            if (!param_val->IsNumber())
+            {
+                Nan::ThrowTypeError("optional arg 'buffer_size' must be a number");
+                return;
+            }
+            closure->buffer_size = param_val->IntegerValue();
+        }
+        if (options->Has(Nan::New("scale").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("scale").ToLocalChecked());
+            if (!param_val->IsNumber())
+            {
+                Nan::ThrowTypeError("optional arg 'scale' must be a number");
+                return;
+            }
+            closure->scale_factor = param_val->NumberValue();
+        }
+        if (options->Has(Nan::New("scale_denominator").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("scale_denominator").ToLocalChecked());
+            if (!param_val->IsNumber())
+            {
+                Nan::ThrowTypeError("optional arg 'scale_denominator' must be a number");
+                return;
+            }
+            closure->scale_denominator = param_val->NumberValue();
+        }
+        if (options->Has(Nan::New("variables").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("variables").ToLocalChecked());
+            if (!param_val->IsObject())
+            {
+                Nan::ThrowTypeError("optional arg 'variables' must be an object");
+                return;
+            }
+            object_to_container(closure->variables,param_val->ToObject());
+        }
+    }
+
+    unsigned width = m->map_->width();
+    unsigned height = m->map_->height();
+    if (width == 0 || height == 0 ||
+        width % closure->tile_size != 0 || height % closure->tile_size != 0)
+    {
+        Nan::ThrowTypeError("map width and height must be non-zero multiples of 'tile_size'");
+        return;
+    }
+    closure->tiles_x = width / closure->tile_size;
+    closure->tiles_y = height / closure->tile_size;
+
+    if (!m->acquire())
+    {
+        Nan::ThrowTypeError("render: Map currently in use by another thread. Consider using a map pool.");
+        return;
+    }
+
+    closure->cb.Reset(callback.As<v8::Function>());
+    uv_queue_work(uv_default_loop(), &closure->request, EIO_RenderMetatile, (uv_after_work_cb)EIO_AfterRenderMetatile);
+    m->Ref();
+    closure.release();
+    return;
+}
+
+void Map::EIO_RenderMetatile(uv_work_t* req)
+{
+    render_metatile_baton_t *closure = static_cast<render_metatile_baton_t *>(req->data);
+
+    try
+    {
+        // render the whole canvas once
+        mapnik::Map const& map = *closure->m->map_;
+        mapnik::request m_req(map.width(),map.height(),map.get_current_extent());
+        m_req.set_buffer_size(closure->buffer_size);
+        mapnik::image_rgba8 im(map.width(), map.height());
+        mapnik::agg_renderer<mapnik::image_rgba8> ren(map,m_req,closure->variables,im,closure->scale_factor,0,0);
+        ren.apply(closure->scale_denominator);
+
+        // slice and encode the sub-tiles on parallel tasks
+        std::size_t num_tiles = static_cast<std::size_t>(closure->tiles_x) * closure->tiles_y;
+        closure->results.resize(num_tiles);
+        std::vector<std::future<void> > futures;
+        futures.reserve(num_tiles);
+        for (unsigned ty = 0; ty < closure->tiles_y; ++ty)
+        {
+            for (unsigned tx = 0; tx < closure->tiles_x; ++tx)
+            {
+                std::size_t idx = static_cast<std::size_t>(ty) * closure->tiles_x + tx;
+                futures.push_back(std::async(std::launch::async, [closure, &im, tx, ty, idx]()
+                {
+                    mapnik::image_view_rgba8 view(tx * closure->tile_size,
+                                                  ty * closure->tile_size,
+                                                  closure->tile_size,
+                                                  closure->tile_size,
+                                                  im);
+                    mapnik::image_view_any view_any(view);
+                    closure->results[idx] = mapnik::save_to_string(view_any, closure->format);
+                }));
+            }
+        }
+        for (auto & future : futures)
+        {
+            future.get();
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        closure->error = true;
+        closure->error_name = ex.what();
+        closure->results.clear();
+    }
+}
+
+void Map::EIO_AfterRenderMetatile(uv_work_t* req)
+{
+    Nan::HandleScope scope;
+    render_metatile_baton_t *closure = static_cast<render_metatile_baton_t *>(req->data);
+    closure->m->release();
+
+    if (closure->error)
+    {
+        v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+    }
+    else
+    {
+        v8::Local<v8::Array> arr = Nan::New<v8::Array>(closure->results.size());
+        for (std::size_t i = 0; i < closure->results.size(); ++i)
+        {
+            // move each encoded tile into its Buffer instead of copying
+            arr->Set(i, node_mapnik::pooled_buffer_to_v8(std::move(closure->results[i])));
+        }
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), arr };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+    }
+
+    closure->m->Unref();
+    closure->cb.Reset();
+    delete closure;
+}
+
 NAN_METHOD(Map::renderFile)
 {
     if (info.Length() < 1 || !info[0]->IsString()) {
@@ -2255,6 +2923,7 @@ NAN_METHOD(Map::renderFile)
     double scale_denominator = 0.0;
     palette_ptr palette;
     int buffer_size = 0;
+    unsigned bands = 1;
 
     v8::Local<v8::Value> callback = info[info.Length()-1];
 
@@ -2324,6 +2993,17 @@ NAN_METHOD(Map::renderFile)
             buffer_size = bind_opt->IntegerValue();
         }
 
+        if (options->Has(Nan::New("bands").ToLocalChecked())) {
+            // render in horizontal bands streamed straight to disk so
+            // poster-size exports stay at O(band) memory; png output only
+            v8::Local<v8::Value> bind_opt = options->Get(Nan::New("bands").ToLocalChecked());
+            if (!bind_opt->IsNumber() || bind_opt->IntegerValue() < 1) {
+                Nan::ThrowTypeError("optional arg 'bands' must be a positive integer");
+                return;
+            }
+            bands = static_cast<unsigned>(bind_opt->IntegerValue());
+        }
+
     } else if (!info[1]->IsFunction()) {
         Nan::ThrowTypeError("optional argument must be an object");
         return;
@@ -2389,6 +3069,15 @@ NAN_METHOD(Map::renderFile)
     closure->format = format;
     closure->palette = palette;
     closure->output = output;
+    closure->bands = bands;
+
+    if (bands > 1 && (closure->use_cairo || closure->palette.get() || format != "png"))
+    {
+        closure->m->release();
+        delete closure;
+        Nan::ThrowTypeError("option 'bands' is only supported for png output without a palette");
+        return;
+    }
 
     uv_queue_work(uv_default_loop(), &closure->request, EIO_RenderFile, (uv_after_work_cb)EIO_AfterRenderFile);
     m->Ref();
@@ -2409,6 +3098,15 @@ void Map::EIO_RenderFile(uv_work_t* req)
             // https://github.com/mapnik/mapnik/issues/1930
             mapnik::save_to_cairo_file(*closure->m->map_,closure->output,closure->format,closure->scale_factor,closure->scale_denominator);
 #else
+#endif
+        }
+        else if (closure->bands > 1)
+        {
+#if defined(HAVE_PNG)
+            render_file_banded(closure);
+#else
+            closure->error = true;
+            closure->error_name = "Mapnik not built with png support";
 #endif
         }
         else
@@ -2567,7 +3265,7 @@ NAN_METHOD(Map::renderSync)
         return;
     }
     m->release();
-    info.GetReturnValue().Set(Nan::CopyBuffer((char*)s.data(), s.size()).ToLocalChecked());
+    info.GetReturnValue().Set(node_mapnik::pooled_buffer_to_v8(std::move(s)));
 }
 
 NAN_METHOD(Map::renderFileSync)
@@ -34,12 +34,14 @@ public:
     static NAN_METHOD(load);
     static void EIO_Load(uv_work_t* req);
     static void EIO_AfterLoad(uv_work_t* req);
+    static void clear_style_cache();
 
     static NAN_METHOD(fromStringSync);
     static NAN_METHOD(fromString);
     static void EIO_FromString(uv_work_t* req);
     static void EIO_AfterFromString(uv_work_t* req);
     static NAN_METHOD(clone);
+    static v8::Local<v8::Value> NewInstance(map_ptr m_ptr);
 
     // async rendering
     static NAN_METHOD(render);
@@ -56,6 +58,10 @@ public:
     static void EIO_RenderFile(uv_work_t* req);
     static void EIO_AfterRenderFile(uv_work_t* req);
 
+    static NAN_METHOD(renderMetatile);
+    static void EIO_RenderMetatile(uv_work_t* req);
+    static void EIO_AfterRenderMetatile(uv_work_t* req);
+
     // sync rendering
     static NAN_METHOD(renderSync);
     static NAN_METHOD(renderFileSync);
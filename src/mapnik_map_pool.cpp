@@ -0,0 +1,298 @@
+#include "mapnik_map_pool.hpp"
+#include "mapnik_map.hpp"
+#include "utils.hpp"
+
+// mapnik
+#include <mapnik/map.hpp>               // for Map, etc
+
+// stl
+#include <exception>                    // for exception
+
+Nan::Persistent<v8::FunctionTemplate> MapPool::constructor;
+
+/**
+ * **`mapnik.MapPool`**
+ *
+ * A pool of map clones sharing a single parsed master map. Rendering
+ * against a {@link mapnik.Map} serializes all jobs on that object, so
+ * saturating multiple cores normally requires parsing the stylesheet
+ * once per worker. A MapPool parses once and hands out clones to
+ * concurrent render jobs: each clone is created lazily in the thread
+ * pool the first time it is needed and then reused for the lifetime of
+ * the pool, so the copy cost is paid once per slot rather than once per
+ * render. The master map must not be mutated after the pool is created.
+ *
+ * @class MapPool
+ * @param {mapnik.Map} map fully loaded master map
+ * @param {Object} [options={}] options with a `size` key controlling
+ * how many clones may be outstanding at once (default 8)
+ * @example
+ * var map = new mapnik.Map(256, 256);
+ * map.loadSync('./style.xml');
+ * var pool = new mapnik.MapPool(map, {size: 4});
+ * pool.acquire(function(err, m) {
+ *     if (err) throw err;
+ *     // render with m, then hand it back
+ *     pool.release(m);
+ * });
+ */
+void MapPool::Initialize(v8::Local<v8::Object> target) {
+
+    Nan::HandleScope scope;
+
+    v8::Local<v8::FunctionTemplate> lcons = Nan::New<v8::FunctionTemplate>(MapPool::New);
+    lcons->InstanceTemplate()->SetInternalFieldCount(1);
+    lcons->SetClassName(Nan::New("MapPool").ToLocalChecked());
+
+    Nan::SetPrototypeMethod(lcons, "acquire", acquire);
+    Nan::SetPrototypeMethod(lcons, "release", release);
+
+    Nan::SetAccessor(lcons->InstanceTemplate(), Nan::New("size").ToLocalChecked(), get_prop);
+    Nan::SetAccessor(lcons->InstanceTemplate(), Nan::New("available").ToLocalChecked(), get_prop);
+
+    target->Set(Nan::New("MapPool").ToLocalChecked(), lcons->GetFunction());
+    constructor.Reset(lcons);
+}
+
+MapPool::MapPool(map_ptr master, unsigned size) :
+    Nan::ObjectWrap(),
+    master_(master),
+    idle_(),
+    waiters_(),
+    size_(size),
+    created_(0) {}
+
+MapPool::~MapPool()
+{
+    while (!waiters_.empty())
+    {
+        waiters_.front()->Reset();
+        waiters_.pop();
+    }
+}
+
+NAN_METHOD(MapPool::New)
+{
+    if (!info.IsConstructCall())
+    {
+        Nan::ThrowError("Cannot call constructor as function, you need to use 'new' keyword");
+        return;
+    }
+
+    if (info.Length() < 1 || !info[0]->IsObject())
+    {
+        Nan::ThrowTypeError("first argument must be a mapnik.Map");
+        return;
+    }
+
+    v8::Local<v8::Object> obj = info[0].As<v8::Object>();
+    if (obj->IsNull() || obj->IsUndefined() || !Nan::New(Map::constructor)->HasInstance(obj))
+    {
+        Nan::ThrowTypeError("first argument must be a mapnik.Map");
+        return;
+    }
+
+    unsigned size = 8;
+    if (info.Length() >= 2)
+    {
+        if (!info[1]->IsObject())
+        {
+            Nan::ThrowTypeError("optional second argument must be an options object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[1].As<v8::Object>();
+        v8::Local<v8::String> param = Nan::New("size").ToLocalChecked();
+        if (options->Has(param))
+        {
+            v8::Local<v8::Value> param_val = options->Get(param);
+            if (!param_val->IsNumber() || param_val->IntegerValue() <= 0)
+            {
+                Nan::ThrowTypeError("'size' must be a positive integer");
+                return;
+            }
+            size = static_cast<unsigned>(param_val->IntegerValue());
+        }
+    }
+
+    Map* m = Nan::ObjectWrap::Unwrap<Map>(obj);
+    MapPool* pool = new MapPool(m->get(), size);
+    pool->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+    return;
+}
+
+typedef struct {
+    uv_work_t request;
+    MapPool* pool;
+    map_ptr map;
+    bool need_clone;
+    bool error;
+    std::string error_name;
+    Nan::Persistent<v8::Function> cb;
+} acquire_map_baton_t;
+
+/**
+ * Acquire a map clone from the pool. If all clones are handed out the
+ * callback is queued and fires as soon as another job calls `release`.
+ *
+ * @memberof MapPool
+ * @instance
+ * @name acquire
+ * @param {Function} callback function with `(err, map)` arguments
+ */
+NAN_METHOD(MapPool::acquire)
+{
+    MapPool* pool = Nan::ObjectWrap::Unwrap<MapPool>(info.Holder());
+
+    // ensure callback is a function
+    v8::Local<v8::Value> callback = info[info.Length()-1];
+    if (info.Length() < 1 || !callback->IsFunction())
+    {
+        Nan::ThrowTypeError("last argument must be a callback function");
+        return;
+    }
+
+    acquire_map_baton_t *closure = new acquire_map_baton_t();
+    closure->request.data = closure;
+    closure->pool = pool;
+    closure->need_clone = false;
+    closure->error = false;
+
+    if (!pool->idle_.empty())
+    {
+        closure->map = pool->idle_.back();
+        pool->idle_.pop_back();
+    }
+    else if (pool->created_ < pool->size_)
+    {
+        // claim the slot now so concurrent acquires cannot overshoot
+        ++pool->created_;
+        closure->need_clone = true;
+    }
+    else
+    {
+        // pool exhausted: wait for a release()
+        delete closure;
+        std::shared_ptr<Nan::Persistent<v8::Function> > waiter =
+            std::make_shared<Nan::Persistent<v8::Function> >();
+        waiter->Reset(callback.As<v8::Function>());
+        pool->waiters_.push(waiter);
+        pool->Ref();
+        return;
+    }
+
+    closure->cb.Reset(callback.As<v8::Function>());
+    uv_queue_work(uv_default_loop(), &closure->request, EIO_Acquire, (uv_after_work_cb)EIO_AfterAcquire);
+    pool->Ref();
+    return;
+}
+
+void MapPool::EIO_Acquire(uv_work_t* req)
+{
+    acquire_map_baton_t *closure = static_cast<acquire_map_baton_t *>(req->data);
+
+    if (!closure->need_clone) return;
+
+    try
+    {
+        closure->map = std::make_shared<mapnik::Map>(*closure->pool->master_);
+    }
+    catch (std::exception const& ex)
+    {
+        closure->error = true;
+        closure->error_name = ex.what();
+    }
+}
+
+void MapPool::EIO_AfterAcquire(uv_work_t* req)
+{
+    Nan::HandleScope scope;
+    acquire_map_baton_t *closure = static_cast<acquire_map_baton_t *>(req->data);
+    if (closure->error) {
+        // give the slot back so a later acquire can retry the clone
+        --closure->pool->created_;
+        v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+    } else {
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), Map::NewInstance(closure->map) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+    }
+
+    closure->pool->Unref();
+    closure->cb.Reset();
+    delete closure;
+}
+
+/**
+ * Return a map previously handed out by `acquire` to the pool. If
+ * other jobs are waiting the map is passed straight to the oldest
+ * waiter, otherwise it goes back on the idle list. The map must not be
+ * used after it has been released.
+ *
+ * @memberof MapPool
+ * @instance
+ * @name release
+ * @param {mapnik.Map} map map obtained from `acquire`
+ */
+NAN_METHOD(MapPool::release)
+{
+    MapPool* pool = Nan::ObjectWrap::Unwrap<MapPool>(info.Holder());
+
+    if (info.Length() < 1 || !info[0]->IsObject())
+    {
+        Nan::ThrowTypeError("first argument must be a mapnik.Map from acquire()");
+        return;
+    }
+
+    v8::Local<v8::Object> obj = info[0].As<v8::Object>();
+    if (obj->IsNull() || obj->IsUndefined() || !Nan::New(Map::constructor)->HasInstance(obj))
+    {
+        Nan::ThrowTypeError("first argument must be a mapnik.Map from acquire()");
+        return;
+    }
+
+    Map* m = Nan::ObjectWrap::Unwrap<Map>(obj);
+    map_ptr map = m->get();
+
+    for (std::vector<map_ptr>::const_iterator it = pool->idle_.begin();
+         it != pool->idle_.end(); ++it)
+    {
+        if (*it == map)
+        {
+            Nan::ThrowError("map has already been released to this pool");
+            return;
+        }
+    }
+
+    if (!pool->waiters_.empty())
+    {
+        // hand the map straight to the oldest waiter, bouncing through
+        // the thread pool so its callback always fires asynchronously
+        std::shared_ptr<Nan::Persistent<v8::Function> > waiter = pool->waiters_.front();
+        pool->waiters_.pop();
+        acquire_map_baton_t *closure = new acquire_map_baton_t();
+        closure->request.data = closure;
+        closure->pool = pool;
+        closure->map = map;
+        closure->need_clone = false;
+        closure->error = false;
+        closure->cb.Reset(Nan::New(*waiter));
+        waiter->Reset();
+        uv_queue_work(uv_default_loop(), &closure->request, EIO_Acquire, (uv_after_work_cb)EIO_AfterAcquire);
+        return;
+    }
+
+    pool->idle_.push_back(map);
+    return;
+}
+
+NAN_GETTER(MapPool::get_prop)
+{
+    MapPool* pool = Nan::ObjectWrap::Unwrap<MapPool>(info.Holder());
+    std::string a = TOSTR(property);
+    if (a == "size")
+        info.GetReturnValue().Set(Nan::New<v8::Integer>(pool->size_));
+    else //if (a == "available")
+        info.GetReturnValue().Set(Nan::New<v8::Integer>(
+            static_cast<int>(pool->idle_.size() + (pool->size_ - pool->created_))));
+}
@@ -0,0 +1,50 @@
+#ifndef __NODE_MAPNIK_MAP_POOL_H__
+#define __NODE_MAPNIK_MAP_POOL_H__
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wshadow"
+#include <nan.h>
+#pragma GCC diagnostic pop
+
+// stl
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace mapnik { class Map; }
+
+typedef std::shared_ptr<mapnik::Map> map_ptr;
+
+class MapPool: public Nan::ObjectWrap {
+public:
+
+    static Nan::Persistent<v8::FunctionTemplate> constructor;
+    static void Initialize(v8::Local<v8::Object> target);
+    static NAN_METHOD(New);
+
+    static NAN_METHOD(acquire);
+    static void EIO_Acquire(uv_work_t* req);
+    static void EIO_AfterAcquire(uv_work_t* req);
+    static NAN_METHOD(release);
+
+    static NAN_GETTER(get_prop);
+
+    MapPool(map_ptr master, unsigned size);
+    void _ref() { Ref(); }
+    void _unref() { Unref(); }
+
+    inline map_ptr master() { return master_; }
+
+private:
+    ~MapPool();
+    map_ptr master_;
+    // clones not currently handed out, reused across acquire() calls
+    std::vector<map_ptr> idle_;
+    // callbacks waiting for a release() once all clones are out
+    std::queue<std::shared_ptr<Nan::Persistent<v8::Function> > > waiters_;
+    unsigned size_;
+    unsigned created_;
+};
+
+#endif
@@ -1,12 +1,16 @@
 // mapnik
 #include <mapnik/version.hpp>
 #include <mapnik/unicode.hpp>
+#include <mapnik/datasource_cache.hpp>
 #include <mapnik/feature_factory.hpp>
+#include <mapnik/feature_layer_desc.hpp>
 #include <mapnik/memory_datasource.hpp>
+#include <mapnik/query.hpp>
 #include <mapnik/value_types.hpp>
 
 #include "mapnik_memory_datasource.hpp"
 #include "mapnik_featureset.hpp"
+#include "mapnik_plugins.hpp"
 #include "utils.hpp"
 #include "ds_emitter.hpp"
 
@@ -28,6 +32,7 @@ void MemoryDatasource::Initialize(v8::Local<v8::Object> target) {
     Nan::SetPrototypeMethod(lcons, "describe", describe);
     Nan::SetPrototypeMethod(lcons, "featureset", featureset);
     Nan::SetPrototypeMethod(lcons, "add", add);
+    Nan::SetPrototypeMethod(lcons, "addGeoJSON", addGeoJSON);
     Nan::SetPrototypeMethod(lcons, "fields", fields);
 
     target->Set(Nan::New("MemoryDatasource").ToLocalChecked(), lcons->GetFunction());
@@ -242,6 +247,150 @@ NAN_METHOD(MemoryDatasource::add)
     info.GetReturnValue().Set(Nan::False());
 }
 
+namespace {
+
+typedef struct {
+    uv_work_t request;
+    MemoryDatasource* d;
+    std::string geojson;
+    std::size_t count;
+    bool error;
+    std::string error_name;
+    Nan::Persistent<v8::Function> cb;
+} add_geojson_baton_t;
+
+} // anonymous namespace
+
+// parses a GeoJSON feature collection through the geojson datasource
+// plugin (one parse, shared feature context) and pushes every feature
+// into the memory datasource; returns the number of features added
+static std::size_t bulk_load_geojson(MemoryDatasource* d, std::string const& geojson)
+{
+    node_mapnik::ensure_plugins_registered("geojson");
+    mapnik::parameters p;
+    p["type"] = "geojson";
+    p["inline"] = geojson;
+    mapnik::datasource_ptr source = mapnik::datasource_cache::instance().create(p);
+    mapnik::query q(source->envelope());
+    mapnik::layer_descriptor ld = source->get_descriptor();
+    for (auto const& attr_desc : ld.get_descriptors())
+    {
+        q.add_property_name(attr_desc.get_name());
+    }
+    mapnik::memory_datasource *cache = dynamic_cast<mapnik::memory_datasource *>(d->get().get());
+    std::size_t count = 0;
+    mapnik::featureset_ptr fs = source->features(q);
+    if (fs)
+    {
+        mapnik::feature_ptr feature;
+        while ((feature = fs->next()))
+        {
+            feature->set_id(d->next_feature_id());
+            cache->push(feature);
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+ * Add every feature of a GeoJSON FeatureCollection in one native call,
+ * parsing the whole collection once instead of crossing the JS boundary
+ * per feature. With a callback the parse and load run on the thread
+ * pool. Requires the geojson input plugin to be registered.
+ *
+ * @name addGeoJSON
+ * @instance
+ * @memberof MemoryDatasource
+ * @param {Buffer|string} geojson a GeoJSON FeatureCollection
+ * @param {Function} [callback] optional `function(err, count)`
+ * @returns {number} number of features added (sync form only)
+ */
+NAN_METHOD(MemoryDatasource::addGeoJSON)
+{
+    MemoryDatasource* d = Nan::ObjectWrap::Unwrap<MemoryDatasource>(info.Holder());
+
+    if (info.Length() < 1)
+    {
+        Nan::ThrowError("accepts a GeoJSON string or Buffer and an optional callback");
+        return;
+    }
+    std::string geojson;
+    if (node::Buffer::HasInstance(info[0]))
+    {
+        v8::Local<v8::Object> obj = info[0].As<v8::Object>();
+        geojson.assign(node::Buffer::Data(obj), node::Buffer::Length(obj));
+    }
+    else if (info[0]->IsString())
+    {
+        geojson = TOSTR(info[0]);
+    }
+    else
+    {
+        Nan::ThrowTypeError("first argument must be a GeoJSON string or Buffer");
+        return;
+    }
+
+    if (!info[info.Length()-1]->IsFunction())
+    {
+        try
+        {
+            std::size_t count = bulk_load_geojson(d, geojson);
+            info.GetReturnValue().Set(Nan::New<v8::Number>(static_cast<double>(count)));
+        }
+        catch (std::exception const& ex)
+        {
+            Nan::ThrowError(ex.what());
+        }
+        return;
+    }
+
+    v8::Local<v8::Value> callback = info[info.Length()-1];
+    add_geojson_baton_t *closure = new add_geojson_baton_t();
+    closure->request.data = closure;
+    closure->d = d;
+    closure->geojson = std::move(geojson);
+    closure->count = 0;
+    closure->error = false;
+    closure->cb.Reset(callback.As<v8::Function>());
+    uv_queue_work(uv_default_loop(), &closure->request, EIO_AddGeoJSON, (uv_after_work_cb)EIO_AfterAddGeoJSON);
+    d->Ref();
+    return;
+}
+
+void MemoryDatasource::EIO_AddGeoJSON(uv_work_t* req)
+{
+    add_geojson_baton_t *closure = static_cast<add_geojson_baton_t *>(req->data);
+    try
+    {
+        closure->count = bulk_load_geojson(closure->d, closure->geojson);
+    }
+    catch (std::exception const& ex)
+    {
+        closure->error = true;
+        closure->error_name = ex.what();
+    }
+}
+
+void MemoryDatasource::EIO_AfterAddGeoJSON(uv_work_t* req)
+{
+    Nan::HandleScope scope;
+    add_geojson_baton_t *closure = static_cast<add_geojson_baton_t *>(req->data);
+    if (closure->error)
+    {
+        v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+    }
+    else
+    {
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::New<v8::Number>(static_cast<double>(closure->count)) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+    }
+    closure->d->Unref();
+    closure->cb.Reset();
+    delete closure;
+}
+
 NAN_METHOD(MemoryDatasource::fields)
 {
     MemoryDatasource* d = Nan::ObjectWrap::Unwrap<MemoryDatasource>(info.Holder());
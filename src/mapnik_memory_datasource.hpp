@@ -24,10 +24,14 @@ public:
     static NAN_METHOD(features);
     static NAN_METHOD(featureset);
     static NAN_METHOD(add);
+    static NAN_METHOD(addGeoJSON);
+    static void EIO_AddGeoJSON(uv_work_t* req);
+    static void EIO_AfterAddGeoJSON(uv_work_t* req);
     static NAN_METHOD(fields);
 
     MemoryDatasource();
     inline mapnik::datasource_ptr get() { return datasource_; }
+    inline unsigned int next_feature_id() { return feature_id_++; }
 
 private:
     ~MemoryDatasource();
@@ -26,7 +26,8 @@ void Palette::Initialize(v8::Local<v8::Object> target) {
 
 Palette::Palette(std::string const& palette, mapnik::rgba_palette::palette_type type) :
     Nan::ObjectWrap(),
-    palette_(std::make_shared<mapnik::rgba_palette>(palette, type)) {}
+    palette_(std::make_shared<mapnik::rgba_palette>(palette, type)),
+    quantize_cache_(std::make_shared<node_mapnik::palette_quantize_cache>(palette_)) {}
 
 Palette::~Palette() {
 }
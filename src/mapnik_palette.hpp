@@ -8,12 +8,74 @@
 #pragma GCC diagnostic pop
 
 #include <mapnik/palette.hpp>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 
 
 typedef std::shared_ptr<mapnik::rgba_palette> palette_ptr;
 
+namespace node_mapnik {
+
+// Caches rgba_palette::quantize results in a flat lock-free
+// open-addressing table keyed by the exact rgba value. The table is
+// created once per Palette object and shared by every encode using
+// that palette, so the per-pixel cost of repeated paletted PNG output
+// drops to one hash probe instead of a hashmap lookup (and the
+// underlying palette scan runs at most once per distinct color).
+// Satisfies the quantizer interface mapnik::save_as_png8 expects.
+class palette_quantize_cache
+{
+public:
+    explicit palette_quantize_cache(palette_ptr pal) :
+        pal_(pal),
+        slots_(table_size) {}
+
+    unsigned char quantize(unsigned val) const
+    {
+        std::uint64_t const key = static_cast<std::uint64_t>(val) << 32;
+        std::size_t slot = hash(val);
+        for (std::size_t probe = 0; probe < max_probes; ++probe)
+        {
+            std::uint64_t entry = slots_[slot].load(std::memory_order_relaxed);
+            if (entry == 0)
+            {
+                unsigned char index = pal_->quantize(val);
+                // the stored index is offset by one so an empty slot is 0
+                slots_[slot].compare_exchange_strong(entry,
+                                                     key | (static_cast<std::uint64_t>(index) + 1),
+                                                     std::memory_order_relaxed);
+                return index;
+            }
+            if ((entry & 0xFFFFFFFF00000000ULL) == key)
+            {
+                return static_cast<unsigned char>((entry & 0xFFFFFFFFULL) - 1);
+            }
+            slot = (slot + 1) & (table_size - 1);
+        }
+        return pal_->quantize(val);
+    }
+
+private:
+    static const std::size_t table_size = 1 << 16;
+    static const std::size_t max_probes = 8;
+
+    static std::size_t hash(unsigned val)
+    {
+        std::uint64_t h = static_cast<std::uint64_t>(val) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<std::size_t>(h >> 40) & (table_size - 1);
+    }
+
+    palette_ptr pal_;
+    mutable std::vector<std::atomic<std::uint64_t> > slots_;
+};
+
+typedef std::shared_ptr<palette_quantize_cache> palette_cache_ptr;
+
+} // end ns node_mapnik
+
 class Palette: public Nan::ObjectWrap {
 public:
     static Nan::Persistent<v8::FunctionTemplate> constructor;
@@ -26,9 +88,11 @@ public:
     static NAN_METHOD(ToBuffer);
 
     inline palette_ptr palette() { return palette_; }
+    inline node_mapnik::palette_cache_ptr quantize_cache() { return quantize_cache_; }
 private:
     ~Palette();
     palette_ptr palette_;
+    node_mapnik::palette_cache_ptr quantize_cache_;
 };
 
 #endif
@@ -7,6 +7,7 @@
 #include <mapnik/version.hpp>
 
 // stl
+#include <algorithm>
 #include <vector>
 #include <string>
 #include "utils.hpp"
@@ -15,9 +16,27 @@
 
 namespace node_mapnik {
 
+// Deferred plugin registration: register_datasources({defer: true})
+// records the directory instead of dlopening every plugin immediately,
+// and ensure_plugins_registered() performs the actual registration the
+// first time a datasource is instantiated (loading just the hinted
+// plugin when the type is known). Definitions live in node_mapnik.cpp.
+bool defer_plugin_dir(std::string const& path);
+void ensure_plugins_registered(std::string const& type_hint);
+std::vector<std::string> pending_plugin_names();
+
 static inline NAN_METHOD(available_input_plugins)
 {
     std::vector<std::string> names = mapnik::datasource_cache::instance().plugin_names();
+    // deferred directories are enumerated from their filenames without
+    // loading anything
+    for (std::string const& pending : pending_plugin_names())
+    {
+        if (std::find(names.begin(), names.end(), pending) == names.end())
+        {
+            names.push_back(pending);
+        }
+    }
     v8::Local<v8::Array> a = Nan::New<v8::Array>(names.size());
     for (unsigned i = 0; i < names.size(); ++i)
     {
@@ -47,13 +66,38 @@ static inline NAN_METHOD(register_datasource)
 
 static inline NAN_METHOD(register_datasources)
 {
-    if (info.Length() != 1 || !info[0]->IsString())
+    if (info.Length() < 1 || !info[0]->IsString())
     {
         Nan::ThrowTypeError("first argument must be a path to a directory of mapnik input plugins");
         return;
     }
-    std::vector<std::string> names_before = mapnik::datasource_cache::instance().plugin_names();
+    bool defer = false;
+    if (info.Length() >= 2)
+    {
+        if (!info[1]->IsObject())
+        {
+            Nan::ThrowTypeError("second argument is optional, but if provided must be an object, eg. { defer: true }");
+            return;
+        }
+        v8::Local<v8::Object> options = info[1].As<v8::Object>();
+        if (options->Has(Nan::New("defer").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> defer_opt = options->Get(Nan::New("defer").ToLocalChecked());
+            if (!defer_opt->IsBoolean())
+            {
+                Nan::ThrowTypeError("'defer' must be a Boolean");
+                return;
+            }
+            defer = defer_opt->BooleanValue();
+        }
+    }
     std::string path = TOSTR(info[0]);
+    if (defer)
+    {
+        info.GetReturnValue().Set(Nan::New(defer_plugin_dir(path)));
+        return;
+    }
+    std::vector<std::string> names_before = mapnik::datasource_cache::instance().plugin_names();
     mapnik::datasource_cache::instance().register_datasources(path);
     std::vector<std::string> names_after = mapnik::datasource_cache::instance().plugin_names();
     if (names_after.size() > names_before.size())
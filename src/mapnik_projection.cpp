@@ -4,6 +4,8 @@
 #include <mapnik/box2d.hpp>
 #include <mapnik/proj_transform.hpp>
 #include <mapnik/projection.hpp>
+#include <map>
+#include <mutex>
 #include <sstream>
 
 Nan::Persistent<v8::FunctionTemplate> Projection::constructor;
@@ -238,6 +240,8 @@ void ProjTransform::Initialize(v8::Local<v8::Object> target) {
 
     Nan::SetPrototypeMethod(lcons, "forward", forward);
     Nan::SetPrototypeMethod(lcons, "backward", backward);
+    Nan::SetPrototypeMethod(lcons, "forwardMany", forwardMany);
+    Nan::SetPrototypeMethod(lcons, "backwardMany", backwardMany);
 
     target->Set(Nan::New("ProjTransform").ToLocalChecked(), lcons->GetFunction());
     constructor.Reset(lcons);
@@ -248,10 +252,63 @@ ProjTransform::ProjTransform(mapnik::projection const& src,
     Nan::ObjectWrap(),
     this_(std::make_shared<mapnik::proj_transform>(src,dest)) {}
 
+ProjTransform::ProjTransform(proj_tr_ptr transform) :
+    Nan::ObjectWrap(),
+    this_(transform) {}
+
 ProjTransform::~ProjTransform()
 {
 }
 
+namespace {
+
+// process-wide cache of initialized proj_transform objects keyed by the
+// source/destination parameter pair, so constructing a ProjTransform for
+// an srs pair seen before skips proj4 initialization entirely. The
+// underlying mapnik::proj_transform is immutable after construction and
+// safe to share between wrapper objects. mapnik::proj_transform holds
+// references to its projections, so each entry co-owns them to keep the
+// references valid after the originating Projection wrappers are
+// garbage collected.
+struct proj_transform_cache_entry
+{
+    proj_ptr src;
+    proj_ptr dest;
+    proj_tr_ptr transform;
+};
+
+std::map<std::string, proj_transform_cache_entry> proj_transform_cache;
+std::mutex proj_transform_cache_mutex;
+
+proj_tr_ptr cached_proj_transform(proj_ptr const& src, proj_ptr const& dest)
+{
+    std::string key = src->params() + "|" + dest->params();
+    {
+        std::lock_guard<std::mutex> lock(proj_transform_cache_mutex);
+        std::map<std::string, proj_transform_cache_entry>::const_iterator itr = proj_transform_cache.find(key);
+        if (itr != proj_transform_cache.end())
+        {
+            return itr->second.transform;
+        }
+    }
+    proj_transform_cache_entry entry;
+    entry.src = src;
+    entry.dest = dest;
+    entry.transform = std::make_shared<mapnik::proj_transform>(*src, *dest);
+    std::lock_guard<std::mutex> lock(proj_transform_cache_mutex);
+    // entries are never replaced: a racing insert could otherwise drop
+    // the projections a handed-out transform still references
+    std::map<std::string, proj_transform_cache_entry>::const_iterator itr = proj_transform_cache.find(key);
+    if (itr != proj_transform_cache.end())
+    {
+        return itr->second.transform;
+    }
+    proj_transform_cache[key] = entry;
+    return entry.transform;
+}
+
+} // anonymous namespace
+
 NAN_METHOD(ProjTransform::New)
 {
     if (!info.IsConstructCall()) {
@@ -281,7 +338,7 @@ NAN_METHOD(ProjTransform::New)
 
     try
     {
-        ProjTransform* p = new ProjTransform(*p1->get(),*p2->get());
+        ProjTransform* p = new ProjTransform(cached_proj_transform(p1->get(),p2->get()));
         p->Wrap(info.This());
         info.GetReturnValue().Set(info.This());
     }
@@ -417,3 +474,156 @@ NAN_METHOD(ProjTransform::backward)
         }
     }
 }
+
+namespace {
+
+// transforms count interleaved x,y pairs in place; returns an error
+// message naming the failing pair, or an empty string on success
+std::string project_pairs(mapnik::proj_transform & tr,
+                          double * data,
+                          std::size_t count,
+                          bool forward)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        double x = data[2 * i];
+        double y = data[2 * i + 1];
+        double z = 0;
+        bool ok = forward ? tr.forward(x, y, z) : tr.backward(x, y, z);
+        if (!ok)
+        {
+            std::ostringstream s;
+            s << "Failed to " << (forward ? "forward" : "back") << " project "
+              << data[2 * i] << "," << data[2 * i + 1] << " at pair " << i
+              << " from " << (forward ? tr.source().params() : tr.dest().params())
+              << " to " << (forward ? tr.dest().params() : tr.source().params());
+            return s.str();
+        }
+        data[2 * i] = x;
+        data[2 * i + 1] = y;
+    }
+    return std::string();
+}
+
+typedef struct {
+    uv_work_t request;
+    ProjTransform* p;
+    double* data;
+    std::size_t count;
+    bool forward;
+    bool error;
+    std::string error_name;
+    Nan::Persistent<v8::Object> array;
+    Nan::Persistent<v8::Function> cb;
+} project_many_baton_t;
+
+void project_many(Nan::NAN_METHOD_ARGS_TYPE info, bool forward)
+{
+    ProjTransform* p = Nan::ObjectWrap::Unwrap<ProjTransform>(info.Holder());
+
+    if (info.Length() < 1 || !info[0]->IsFloat64Array())
+    {
+        Nan::ThrowTypeError("first argument must be a Float64Array of interleaved x,y pairs");
+        return;
+    }
+    v8::Local<v8::Float64Array> arr = info[0].As<v8::Float64Array>();
+    if (arr->Length() % 2 != 0)
+    {
+        Nan::ThrowTypeError("Float64Array length must be even (interleaved x,y pairs)");
+        return;
+    }
+    double * data = reinterpret_cast<double *>(
+        static_cast<char *>(arr->Buffer()->GetContents().Data()) + arr->ByteOffset());
+    std::size_t count = arr->Length() / 2;
+
+    // no callback: transform synchronously in place
+    if (!info[info.Length()-1]->IsFunction())
+    {
+        std::string error_name = project_pairs(*p->get(), data, count, forward);
+        if (!error_name.empty())
+        {
+            Nan::ThrowError(error_name.c_str());
+            return;
+        }
+        info.GetReturnValue().Set(arr);
+        return;
+    }
+
+    v8::Local<v8::Value> callback = info[info.Length()-1];
+    project_many_baton_t *closure = new project_many_baton_t();
+    closure->request.data = closure;
+    closure->p = p;
+    closure->data = data;
+    closure->count = count;
+    closure->forward = forward;
+    closure->error = false;
+    closure->array.Reset(arr.As<v8::Object>());
+    closure->cb.Reset(callback.As<v8::Function>());
+    uv_queue_work(uv_default_loop(), &closure->request, ProjTransform::EIO_ProjectMany, (uv_after_work_cb)ProjTransform::EIO_AfterProjectMany);
+    p->_ref();
+    return;
+}
+
+} // anonymous namespace
+
+/**
+ * Transform an interleaved array of x,y pairs from the source projection
+ * to the destination projection in one native call. The Float64Array is
+ * modified in place; with a callback the work runs on the thread pool.
+ *
+ * @name forwardMany
+ * @memberof ProjTransform
+ * @instance
+ * @param {Float64Array} pairs interleaved x,y coordinates, transformed in place
+ * @param {Function} [callback] optional `function(err, pairs)`
+ * @returns {Float64Array} the input array, transformed (sync form only)
+ */
+NAN_METHOD(ProjTransform::forwardMany)
+{
+    project_many(info, true);
+}
+
+/**
+ * Transform an interleaved array of x,y pairs from the destination
+ * projection back to the source projection in one native call. See
+ * `forwardMany` for the calling convention.
+ *
+ * @name backwardMany
+ * @memberof ProjTransform
+ * @instance
+ * @param {Float64Array} pairs interleaved x,y coordinates, transformed in place
+ * @param {Function} [callback] optional `function(err, pairs)`
+ * @returns {Float64Array} the input array, transformed (sync form only)
+ */
+NAN_METHOD(ProjTransform::backwardMany)
+{
+    project_many(info, false);
+}
+
+void ProjTransform::EIO_ProjectMany(uv_work_t* req)
+{
+    project_many_baton_t *closure = static_cast<project_many_baton_t *>(req->data);
+    closure->error_name = project_pairs(*closure->p->get(), closure->data, closure->count, closure->forward);
+    closure->error = !closure->error_name.empty();
+}
+
+void ProjTransform::EIO_AfterProjectMany(uv_work_t* req)
+{
+    Nan::HandleScope scope;
+    project_many_baton_t *closure = static_cast<project_many_baton_t *>(req->data);
+    if (closure->error)
+    {
+        v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+    }
+    else
+    {
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::New(closure->array) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+    }
+
+    closure->p->_unref();
+    closure->array.Reset();
+    closure->cb.Reset();
+    delete closure;
+}
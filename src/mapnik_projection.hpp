@@ -46,9 +46,14 @@ public:
 
     static NAN_METHOD(forward);
     static NAN_METHOD(backward);
+    static NAN_METHOD(forwardMany);
+    static NAN_METHOD(backwardMany);
+    static void EIO_ProjectMany(uv_work_t* req);
+    static void EIO_AfterProjectMany(uv_work_t* req);
 
     ProjTransform(mapnik::projection const& src,
                   mapnik::projection const& dest);
+    explicit ProjTransform(proj_tr_ptr transform);
 
     inline proj_tr_ptr get() { return this_; }
 
@@ -0,0 +1,235 @@
+#ifndef __NODE_MAPNIK_SHARED_STORE_H__
+#define __NODE_MAPNIK_SHARED_STORE_H__
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wshadow"
+#include <nan.h>
+#pragma GCC diagnostic pop
+
+#include "utils.hpp"
+
+// stl
+#include <cstring>
+#include <string>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace node_mapnik {
+
+// Cross-process shared blob store for hot tile data, backed by POSIX
+// shared memory. One worker publishes an immutable tile blob under a
+// name; every other worker reads it as a Buffer that maps the same
+// physical pages (copy-on-write, so a stray write cannot corrupt the
+// shared copy), which can be fed straight to VectorTile.setData. The
+// hot set is paid for once per machine instead of once per worker.
+
+#if !defined(_WIN32)
+
+inline bool shared_store_name(std::string const& name, std::string & shm_name)
+{
+    if (name.empty() || name.size() > 200) return false;
+    for (char c : name)
+    {
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '.';
+        if (!ok) return false;
+    }
+    shm_name = "/nodemapnik." + name;
+    return true;
+}
+
+namespace detail {
+
+struct shared_mapping
+{
+    void * data;
+    std::size_t size;
+};
+
+inline void release_shared_mapping(char*, void* hint)
+{
+    shared_mapping * mapping = static_cast<shared_mapping*>(hint);
+    if (mapping->data != nullptr && mapping->size > 0)
+    {
+        munmap(mapping->data, mapping->size);
+    }
+    delete mapping;
+}
+
+} // end ns detail
+
+#endif // !defined(_WIN32)
+
+/**
+ * Publish a Buffer as an immutable named blob in shared memory, where
+ * other processes on the machine can map it with readSharedTile.
+ * Republishing a name replaces the blob; existing readers keep their
+ * mapping of the old contents.
+ *
+ * @name publishSharedTile
+ * @memberof mapnik
+ * @param {string} name - blob name ([A-Za-z0-9_.-])
+ * @param {Buffer} buffer - the bytes to publish
+ * @returns {boolean} true on success
+ */
+static inline NAN_METHOD(publish_shared_tile)
+{
+#if defined(_WIN32)
+    Nan::ThrowError("the shared tile store is not supported on this platform");
+    return;
+#else
+    if (info.Length() < 2 || !info[0]->IsString() || !node::Buffer::HasInstance(info[1]))
+    {
+        Nan::ThrowTypeError("expects a blob name (string) and a Buffer");
+        return;
+    }
+    std::string shm_name;
+    if (!shared_store_name(TOSTR(info[0]), shm_name))
+    {
+        Nan::ThrowTypeError("blob name must be 1-200 characters of [A-Za-z0-9_.-]");
+        return;
+    }
+    v8::Local<v8::Object> obj = info[1].As<v8::Object>();
+    const char * data = node::Buffer::Data(obj);
+    std::size_t size = node::Buffer::Length(obj);
+
+    // replace any previous blob by unlinking it first: readers that
+    // already mapped the old object keep it alive and intact, whereas
+    // truncating it in place could fault them on access
+    shm_unlink(shm_name.c_str());
+    int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        Nan::ThrowError("could not create shared memory segment");
+        return;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        close(fd);
+        shm_unlink(shm_name.c_str());
+        Nan::ThrowError("could not size shared memory segment");
+        return;
+    }
+    if (size > 0)
+    {
+        void * mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            close(fd);
+            shm_unlink(shm_name.c_str());
+            Nan::ThrowError("could not map shared memory segment");
+            return;
+        }
+        std::memcpy(mapped, data, size);
+        munmap(mapped, size);
+    }
+    close(fd);
+    info.GetReturnValue().Set(Nan::True());
+#endif
+}
+
+/**
+ * Map a blob published with publishSharedTile and return it as a
+ * Buffer referencing the shared pages directly (no per-process copy;
+ * writes to the Buffer are copy-on-write private to this process).
+ * Returns undefined when no blob with that name exists.
+ *
+ * @name readSharedTile
+ * @memberof mapnik
+ * @param {string} name - blob name
+ * @returns {Buffer|undefined} the mapped bytes
+ */
+static inline NAN_METHOD(read_shared_tile)
+{
+#if defined(_WIN32)
+    Nan::ThrowError("the shared tile store is not supported on this platform");
+    return;
+#else
+    if (info.Length() < 1 || !info[0]->IsString())
+    {
+        Nan::ThrowTypeError("expects a blob name (string)");
+        return;
+    }
+    std::string shm_name;
+    if (!shared_store_name(TOSTR(info[0]), shm_name))
+    {
+        Nan::ThrowTypeError("blob name must be 1-200 characters of [A-Za-z0-9_.-]");
+        return;
+    }
+    int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return; // undefined - not published
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        Nan::ThrowError("could not stat shared memory segment");
+        return;
+    }
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    if (size == 0)
+    {
+        close(fd);
+        info.GetReturnValue().Set(Nan::NewBuffer(0).ToLocalChecked());
+        return;
+    }
+    // MAP_PRIVATE: reads share the physical pages, a write faults in a
+    // private copy instead of corrupting the published blob
+    void * mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        Nan::ThrowError("could not map shared memory segment");
+        return;
+    }
+    detail::shared_mapping * mapping = new detail::shared_mapping();
+    mapping->data = mapped;
+    mapping->size = size;
+    info.GetReturnValue().Set(Nan::NewBuffer(static_cast<char*>(mapped),
+                                             size,
+                                             detail::release_shared_mapping,
+                                             mapping).ToLocalChecked());
+#endif
+}
+
+/**
+ * Unlink a published blob. Readers that already mapped it keep their
+ * mapping until their Buffers are collected.
+ *
+ * @name removeSharedTile
+ * @memberof mapnik
+ * @param {string} name - blob name
+ * @returns {boolean} whether a blob was removed
+ */
+static inline NAN_METHOD(remove_shared_tile)
+{
+#if defined(_WIN32)
+    Nan::ThrowError("the shared tile store is not supported on this platform");
+    return;
+#else
+    if (info.Length() < 1 || !info[0]->IsString())
+    {
+        Nan::ThrowTypeError("expects a blob name (string)");
+        return;
+    }
+    std::string shm_name;
+    if (!shared_store_name(TOSTR(info[0]), shm_name))
+    {
+        Nan::ThrowTypeError("blob name must be 1-200 characters of [A-Za-z0-9_.-]");
+        return;
+    }
+    info.GetReturnValue().Set(Nan::New(shm_unlink(shm_name.c_str()) == 0));
+#endif
+}
+
+} // end ns
+
+#endif // __NODE_MAPNIK_SHARED_STORE_H__
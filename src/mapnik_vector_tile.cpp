@@ -12,6 +12,9 @@
 
 #include "mapnik_vector_tile.hpp"
 #include "vector_tile_compression.hpp"
+#include "deflate_pool.hpp"
+#include "inflate_pool.hpp"
+#include "output_buffer_pool.hpp"
 #include "vector_tile_composite.hpp"
 #include "vector_tile_processor.hpp"
 #include "vector_tile_projection.hpp"
@@ -19,6 +22,10 @@
 #include "vector_tile_geometry_decoder.hpp"
 #include "vector_tile_load_tile.hpp"
 #include "object_to_container.hpp"
+#include "mapnik_plugins.hpp"
+#include "job_scheduler.hpp"
+#include "async_metrics.hpp"
+#include "arena.hpp"
 
 // mapnik
 #include <mapnik/agg_renderer.hpp>      // for agg_renderer
@@ -27,11 +34,14 @@
 #include <mapnik/feature.hpp>
 #include <mapnik/featureset.hpp>
 #include <mapnik/feature_kv_iterator.hpp>
+#include <mapnik/feature_layer_desc.hpp>
+#include <mapnik/geometry_envelope.hpp>
 #include <mapnik/geometry_is_simple.hpp>
 #include <mapnik/geometry_is_valid.hpp>
 #include <mapnik/geometry_reprojection.hpp>
 #include <mapnik/geom_util.hpp>
 #include <mapnik/hit_test_filter.hpp>
+#include <mapnik/query.hpp>
 #include <mapnik/image_any.hpp>
 #include <mapnik/layer.hpp>
 #include <mapnik/map.hpp>
@@ -55,14 +65,26 @@
 #endif
 
 // std
+#include <atomic>                       // for atomic
+#include <chrono>                       // for steady_clock
+#include <cmath>                        // for isfinite
+#include <cstdio>                       // for snprintf
+#include <condition_variable>           // for condition_variable
+#include <future>                       // for async, future
 #include <set>                          // for set, etc
 #include <sstream>                      // for operator<<, basic_ostream, etc
 #include <string>                       // for string, char_traits, etc
 #include <exception>                    // for exception
 #include <vector>                       // for vector
 
+// boost
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
 // protozero
 #include <protozero/pbf_reader.hpp>
+#include <protozero/pbf_writer.hpp>
 
 namespace detail
 {
@@ -242,6 +264,254 @@ detail::p2p_result path_to_point_distance(mapnik::geometry::geometry<double> con
     return mapnik::util::apply_visitor(detail::p2p_distance(x,y), geom);
 }
 
+namespace detail
+{
+
+// Lazily built r-tree over the decoded features of each layer, used by
+// VectorTile::query with {index: true}. Envelope intersection against a
+// box grown by the query tolerance is a necessary condition for the
+// exact point-to-path distance check, so the index only prunes
+// candidates - the distance filter below stays authoritative.
+struct query_index_layer
+{
+    using point_type = boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian>;
+    using box_type = boost::geometry::model::box<point_type>;
+    using value_type = std::pair<box_type, std::size_t>;
+    using rtree_type = boost::geometry::index::rtree<value_type, boost::geometry::index::quadratic<16> >;
+    std::string name;
+    std::vector<mapnik::feature_ptr> features;
+    rtree_type rtree;
+};
+
+struct tile_query_index
+{
+    std::vector<query_index_layer> layers;
+};
+
+} // end ns detail
+
+std::shared_ptr<detail::tile_query_index> VectorTile::ensure_query_index()
+{
+    std::lock_guard<std::mutex> lock(query_index_mutex_);
+    if (query_index_)
+    {
+        return query_index_;
+    }
+    auto index = std::make_shared<detail::tile_query_index>();
+    protozero::pbf_reader item(tile_->get_reader());
+    while (item.next(mapnik::vector_tile_impl::Tile_Encoding::LAYERS))
+    {
+        protozero::pbf_reader layer_msg = item.get_message();
+        auto ds = std::make_shared<mapnik::vector_tile_impl::tile_datasource_pbf>(
+                                        layer_msg,
+                                        tile_->x(),
+                                        tile_->y(),
+                                        tile_->z());
+        // use the buffered extent so features in the tile buffer are indexed too
+        mapnik::query q(tile_->get_buffered_extent());
+        mapnik::layer_descriptor ld = ds->get_descriptor();
+        for (auto const& attr_desc : ld.get_descriptors())
+        {
+            q.add_property_name(attr_desc.get_name());
+        }
+        detail::query_index_layer layer;
+        layer.name = ds->get_name();
+        std::vector<detail::query_index_layer::value_type> values;
+        mapnik::featureset_ptr fs = ds->features(q);
+        if (fs)
+        {
+            mapnik::feature_ptr feature;
+            while ((feature = fs->next()))
+            {
+                mapnik::box2d<double> envelope = mapnik::geometry::envelope(feature->get_geometry());
+                if (!envelope.valid())
+                {
+                    continue;
+                }
+                detail::query_index_layer::box_type box(
+                    detail::query_index_layer::point_type(envelope.minx(), envelope.miny()),
+                    detail::query_index_layer::point_type(envelope.maxx(), envelope.maxy()));
+                values.emplace_back(box, layer.features.size());
+                layer.features.push_back(feature);
+            }
+        }
+        layer.rtree = detail::query_index_layer::rtree_type(values.begin(), values.end());
+        index->layers.push_back(std::move(layer));
+    }
+    query_index_ = index;
+    return query_index_;
+}
+
+bool VectorTile::layer_bytes(std::string const& name, const char *& data_out, std::size_t & size_out)
+{
+    std::lock_guard<std::mutex> lock(query_index_mutex_);
+    if (!layer_directory_valid_)
+    {
+        layer_directory_.clear();
+        protozero::pbf_reader tile_msg(tile_->get_reader());
+        while (tile_msg.next(mapnik::vector_tile_impl::Tile_Encoding::LAYERS))
+        {
+            auto data_pair = tile_msg.get_data();
+            protozero::pbf_reader name_msg(data_pair);
+            if (!name_msg.next(mapnik::vector_tile_impl::Layer_Encoding::NAME))
+            {
+                continue;
+            }
+            // first occurrence wins, matching the scan layer() used to do
+            layer_directory_.emplace(name_msg.get_string(),
+                                     std::make_pair(data_pair.first, data_pair.second));
+        }
+        layer_directory_valid_ = true;
+    }
+    std::map<std::string, std::pair<const char *, std::size_t> >::const_iterator itr = layer_directory_.find(name);
+    if (itr == layer_directory_.end())
+    {
+        return false;
+    }
+    data_out = itr->second.first;
+    size_out = itr->second.second;
+    return true;
+}
+
+/**
+ * Hit-test a pixel position against this tile's features and return the
+ * nearest hit as `{layer, distance, feature}` (or `undefined` when
+ * nothing is within tolerance). Uses the same lazily-built per-layer
+ * spatial index query({index: true}) uses - built once per tile data
+ * and reused by every call - so interactive hit-testing no longer needs
+ * a second grid render alongside the image render.
+ *
+ * @memberof VectorTile
+ * @instance
+ * @name hitTest
+ * @param {number} x pixel column within the rendered tile
+ * @param {number} y pixel row within the rendered tile
+ * @param {Object} [options]
+ * @param {number} [options.size=256] pixel size the tile was rendered at
+ * @param {number} [options.tolerance=0] hit tolerance in pixels
+ * @param {string} [options.layer] restrict the test to one layer
+ * @returns {Object|undefined} nearest hit
+ * @example
+ * var hit = vt.hitTest(128, 128, {tolerance: 4});
+ * if (hit) console.log(hit.layer, hit.feature.id());
+ */
+NAN_METHOD(VectorTile::hitTest)
+{
+    if (info.Length() < 2 || !info[0]->IsNumber() || !info[1]->IsNumber())
+    {
+        Nan::ThrowTypeError("expects pixel x,y arguments");
+        return;
+    }
+    double px = info[0]->NumberValue();
+    double py = info[1]->NumberValue();
+    double size = 256.0;
+    double tolerance_px = 0.0;
+    std::string layer_name;
+    if (info.Length() > 2)
+    {
+        if (!info[2]->IsObject())
+        {
+            Nan::ThrowTypeError("optional third argument must be an options object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[2]->ToObject();
+        if (options->Has(Nan::New("size").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("size").ToLocalChecked());
+            if (!param_val->IsNumber() || param_val->NumberValue() <= 0)
+            {
+                Nan::ThrowTypeError("option 'size' must be a positive number");
+                return;
+            }
+            size = param_val->NumberValue();
+        }
+        if (options->Has(Nan::New("tolerance").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("tolerance").ToLocalChecked());
+            if (!param_val->IsNumber() || param_val->NumberValue() < 0)
+            {
+                Nan::ThrowTypeError("option 'tolerance' must be a non-negative number");
+                return;
+            }
+            tolerance_px = param_val->NumberValue();
+        }
+        if (options->Has(Nan::New("layer").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("layer").ToLocalChecked());
+            if (!param_val->IsString())
+            {
+                Nan::ThrowTypeError("option 'layer' must be a layer name (string)");
+                return;
+            }
+            layer_name = TOSTR(param_val);
+        }
+    }
+
+    VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
+    if (d->get_tile()->is_empty())
+    {
+        return;
+    }
+    try
+    {
+        mapnik::vector_tile_impl::spherical_mercator merc(d->tile_size());
+        double minx,miny,maxx,maxy;
+        merc.xyz(d->get_tile()->x(), d->get_tile()->y(), d->get_tile()->z(), minx, miny, maxx, maxy);
+        double res_x = (maxx - minx) / size;
+        double res_y = (maxy - miny) / size;
+        double mx = minx + (px + 0.5) * res_x;
+        double my = maxy - (py + 0.5) * res_y;
+        double tolerance = tolerance_px * (res_x > res_y ? res_x : res_y);
+
+        std::shared_ptr<detail::tile_query_index> index = d->ensure_query_index();
+        detail::query_index_layer::box_type search_box(
+            detail::query_index_layer::point_type(mx - tolerance, my - tolerance),
+            detail::query_index_layer::point_type(mx + tolerance, my + tolerance));
+        bool found = false;
+        double best_distance = 0.0;
+        std::string best_layer;
+        mapnik::feature_ptr best_feature;
+        std::vector<detail::query_index_layer::value_type> candidates;
+        for (auto const& layer : index->layers)
+        {
+            if (!layer_name.empty() && layer.name != layer_name)
+            {
+                continue;
+            }
+            candidates.clear();
+            layer.rtree.query(boost::geometry::index::intersects(search_box), std::back_inserter(candidates));
+            for (auto const& candidate : candidates)
+            {
+                mapnik::feature_ptr feature = layer.features[candidate.second];
+                auto p2p = path_to_point_distance(feature->get_geometry(), mx, my);
+                if (p2p.distance >= 0 && p2p.distance <= tolerance &&
+                    (!found || p2p.distance < best_distance))
+                {
+                    found = true;
+                    best_distance = p2p.distance;
+                    best_layer = layer.name;
+                    best_feature = feature;
+                }
+            }
+        }
+        if (!found)
+        {
+            return;
+        }
+        v8::Local<v8::Object> hit = Nan::New<v8::Object>();
+        hit->Set(Nan::New("layer").ToLocalChecked(), Nan::New<v8::String>(best_layer).ToLocalChecked());
+        hit->Set(Nan::New("distance").ToLocalChecked(), Nan::New<v8::Number>(best_distance));
+        hit->Set(Nan::New("feature").ToLocalChecked(), Feature::NewInstance(best_feature));
+        info.GetReturnValue().Set(hit);
+    }
+    catch (std::exception const& ex)
+    {
+        Nan::ThrowError(ex.what());
+    }
+    return;
+}
+
+
 Nan::Persistent<v8::FunctionTemplate> VectorTile::constructor;
 
 /**
@@ -273,6 +543,7 @@ void VectorTile::Initialize(v8::Local<v8::Object> target)
     lcons->InstanceTemplate()->SetInternalFieldCount(1);
     lcons->SetClassName(Nan::New("VectorTile").ToLocalChecked());
     Nan::SetPrototypeMethod(lcons, "render", render);
+    Nan::SetPrototypeMethod(lcons, "renderToBuffer", renderToBuffer);
     Nan::SetPrototypeMethod(lcons, "setData", setData);
     Nan::SetPrototypeMethod(lcons, "setDataSync", setDataSync);
     Nan::SetPrototypeMethod(lcons, "getData", getData);
@@ -280,8 +551,10 @@ void VectorTile::Initialize(v8::Local<v8::Object> target)
     Nan::SetPrototypeMethod(lcons, "addData", addData);
     Nan::SetPrototypeMethod(lcons, "addDataSync", addDataSync);
     Nan::SetPrototypeMethod(lcons, "composite", composite);
+    Nan::SetPrototypeMethod(lcons, "generatePyramid", generatePyramid);
     Nan::SetPrototypeMethod(lcons, "compositeSync", compositeSync);
     Nan::SetPrototypeMethod(lcons, "query", query);
+    Nan::SetPrototypeMethod(lcons, "hitTest", hitTest);
     Nan::SetPrototypeMethod(lcons, "queryMany", queryMany);
     Nan::SetPrototypeMethod(lcons, "extent", extent);
     Nan::SetPrototypeMethod(lcons, "bufferedExtent", bufferedExtent);
@@ -292,6 +565,7 @@ void VectorTile::Initialize(v8::Local<v8::Object> target)
     Nan::SetPrototypeMethod(lcons, "toJSON", toJSON);
     Nan::SetPrototypeMethod(lcons, "toGeoJSON", toGeoJSON);
     Nan::SetPrototypeMethod(lcons, "toGeoJSONSync", toGeoJSONSync);
+    Nan::SetPrototypeMethod(lcons, "toGeoJSONStream", toGeoJSONStream);
     Nan::SetPrototypeMethod(lcons, "addGeoJSON", addGeoJSON);
     Nan::SetPrototypeMethod(lcons, "addImage", addImage);
     Nan::SetPrototypeMethod(lcons, "addImageSync", addImageSync);
@@ -305,6 +579,7 @@ void VectorTile::Initialize(v8::Local<v8::Object> target)
 #endif // BOOST_VERSION >= 105600
     Nan::SetPrototypeMethod(lcons, "painted", painted);
     Nan::SetPrototypeMethod(lcons, "clear", clear);
+    Nan::SetPrototypeMethod(lcons, "release", release);
     Nan::SetPrototypeMethod(lcons, "clearSync", clearSync);
     Nan::SetPrototypeMethod(lcons, "empty", empty);
 
@@ -317,18 +592,149 @@ void VectorTile::Initialize(v8::Local<v8::Object> target)
     
     Nan::SetMethod(lcons->GetFunction().As<v8::Object>(), "info", info);
     
+    Nan::SetMethod(lcons->GetFunction().As<v8::Object>(), "pool", VectorTile::pool);
+
     target->Set(Nan::New("VectorTile").ToLocalChecked(),lcons->GetFunction());
     constructor.Reset(lcons);
 }
 
+namespace {
+
+// Pool of released merc_tile objects, see VectorTile.pool(). Tiles are
+// cleared before parking, which keeps the capacity their data string
+// grew to, so steady-state serving reuses the large buffers instead of
+// freeing and reallocating them per tile lifecycle. Disabled until a
+// capacity is configured from JS.
+std::mutex tile_pool_mutex;
+std::vector<mapnik::vector_tile_impl::merc_tile_ptr> tile_pool;
+std::size_t tile_pool_capacity = 0;
+
+mapnik::vector_tile_impl::merc_tile_ptr acquire_pooled_tile(int x,
+                                                            int y,
+                                                            int z,
+                                                            std::uint32_t tile_size,
+                                                            std::int32_t buffer_size)
+{
+    {
+        std::lock_guard<std::mutex> lock(tile_pool_mutex);
+        if (!tile_pool.empty())
+        {
+            mapnik::vector_tile_impl::merc_tile_ptr tile = std::move(tile_pool.back());
+            tile_pool.pop_back();
+            // parked tiles are already cleared; re-target the new coords
+            // (z first - the x/y setters derive the extent from it)
+            tile->tile_size(tile_size);
+            tile->buffer_size(buffer_size);
+            tile->z(z);
+            tile->x(x);
+            tile->y(y);
+            return tile;
+        }
+    }
+    return std::make_shared<mapnik::vector_tile_impl::merc_tile>(x, y, z, tile_size, buffer_size);
+}
+
+bool park_pooled_tile(mapnik::vector_tile_impl::merc_tile_ptr & tile)
+{
+    // a use count above one means aliased buffers or another holder
+    // still reference the storage - those tiles must not be recycled
+    if (tile.use_count() != 1) return false;
+    std::lock_guard<std::mutex> lock(tile_pool_mutex);
+    if (tile_pool.size() >= tile_pool_capacity) return false;
+    tile->clear();
+    tile_pool.push_back(std::move(tile));
+    return true;
+}
+
+} // anonymous namespace
+
 VectorTile::VectorTile(int z, 
                        int x, 
                        int y, 
                        std::uint32_t tile_size,
                        std::int32_t buffer_size) :
     Nan::ObjectWrap(),
-    tile_(std::make_shared<mapnik::vector_tile_impl::merc_tile>(x, y, z, tile_size, buffer_size))
+    tile_(acquire_pooled_tile(x, y, z, tile_size, buffer_size)),
+    tracker_(node_mapnik::vector_tile_stats())
+{
+}
+
+/**
+ * Configure the process-wide pool of released tile objects. With a
+ * capacity above zero, tiles handed to release() park their backing
+ * buffers for reuse by later VectorTile constructions.
+ *
+ * @name pool
+ * @memberof VectorTile
+ * @static
+ * @param {Object} [options] options with a `size` key (maximum parked tiles)
+ * @returns {Object} the current {size, available} state
+ * @example
+ * mapnik.VectorTile.pool({size: 64});
+ */
+NAN_METHOD(VectorTile::pool)
+{
+    if (info.Length() > 0)
+    {
+        if (!info[0]->IsObject())
+        {
+            Nan::ThrowTypeError("optional first argument must be an options object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[0]->ToObject();
+        if (options->Has(Nan::New("size").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("size").ToLocalChecked());
+            if (!param_val->IsNumber() || param_val->IntegerValue() < 0)
+            {
+                Nan::ThrowTypeError("option 'size' must be a non-negative integer");
+                return;
+            }
+            std::lock_guard<std::mutex> lock(tile_pool_mutex);
+            tile_pool_capacity = static_cast<std::size_t>(param_val->IntegerValue());
+            while (tile_pool.size() > tile_pool_capacity)
+            {
+                tile_pool.pop_back();
+            }
+        }
+    }
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    {
+        std::lock_guard<std::mutex> lock(tile_pool_mutex);
+        result->Set(Nan::New("size").ToLocalChecked(), Nan::New<v8::Integer>(static_cast<int>(tile_pool_capacity)));
+        result->Set(Nan::New("available").ToLocalChecked(), Nan::New<v8::Integer>(static_cast<int>(tile_pool.size())));
+    }
+    info.GetReturnValue().Set(result);
+}
+
+/**
+ * Hand this tile's backing storage to the tile pool and reset the tile
+ * to empty. Returns false - leaving the tile completely untouched -
+ * when the pool is full, disabled, or the storage is still referenced
+ * by an aliased buffer. The tile must not be released while an async
+ * operation on it is in flight.
+ *
+ * @name release
+ * @memberof VectorTile
+ * @instance
+ * @returns {boolean} whether the storage was parked for reuse
+ */
+NAN_METHOD(VectorTile::release)
 {
+    VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
+    int x = d->tile_->x();
+    int y = d->tile_->y();
+    int z = d->tile_->z();
+    std::uint32_t tile_size = d->tile_->tile_size();
+    std::int32_t buffer_size = d->tile_->buffer_size();
+    bool parked = park_pooled_tile(d->tile_);
+    if (parked)
+    {
+        // the wrapper stays usable as a fresh empty tile at the same coords
+        d->tile_ = std::make_shared<mapnik::vector_tile_impl::merc_tile>(x, y, z, tile_size, buffer_size);
+    }
+    d->invalidate_query_index();
+    info.GetReturnValue().Set(Nan::New(parked));
 }
 
 // For some reason coverage never seems to be considered here even though
@@ -458,7 +864,8 @@ void _composite(VectorTile* target_vt,
                 bool process_all_rings,
                 std::string const& image_format,
                 mapnik::scaling_method_e scaling_method,
-                std::launch threading_mode)
+                std::launch threading_mode,
+                bool parallel_sources)
 {
     // create map
     mapnik::Map map(target_vt->tile_size(),target_vt->tile_size(),"+init=epsg:3857");
@@ -477,6 +884,65 @@ void _composite(VectorTile* target_vt,
         merc_vtiles.push_back(vt->get_tile());
     }
 
+    if (parallel_sources && merc_vtiles.size() > 1)
+    {
+        // fan the per-source-tile work (decompress, filter, reproject,
+        // re-encode) out across threads, one task per source tile, then
+        // merge the results sequentially. Each task gets its own map and
+        // processor since neither is thread safe. Note that unlike the
+        // sequential path, which copies same-tile sources ahead of
+        // reprojected ones, the merged layer order here always follows
+        // the input array order.
+        mapnik::vector_tile_impl::merc_tile_ptr target_tile = target_vt->get_tile();
+        std::vector<std::future<mapnik::vector_tile_impl::merc_tile_ptr> > futures;
+        futures.reserve(merc_vtiles.size());
+        for (mapnik::vector_tile_impl::merc_tile_ptr const& source : merc_vtiles)
+        {
+            futures.push_back(std::async(std::launch::async, [&, source]()
+            {
+                mapnik::vector_tile_impl::merc_tile_ptr temp_tile =
+                    std::make_shared<mapnik::vector_tile_impl::merc_tile>(target_tile->x(),
+                                                                          target_tile->y(),
+                                                                          target_tile->z(),
+                                                                          target_tile->tile_size(),
+                                                                          target_tile->buffer_size());
+                mapnik::Map task_map(target_tile->tile_size(),target_tile->tile_size(),"+init=epsg:3857");
+                task_map.set_maximum_extent(map.maximum_extent() ? *map.maximum_extent() : target_tile->get_buffered_extent());
+                mapnik::vector_tile_impl::processor task_ren(task_map);
+                task_ren.set_fill_type(fill_type);
+                task_ren.set_simplify_distance(simplify_distance);
+                task_ren.set_process_all_rings(process_all_rings);
+                task_ren.set_multi_polygon_union(multi_polygon_union);
+                task_ren.set_strictly_simple(strictly_simple);
+                task_ren.set_area_threshold(area_threshold);
+                task_ren.set_scale_factor(scale_factor);
+                task_ren.set_scaling_method(scaling_method);
+                task_ren.set_image_format(image_format);
+                task_ren.set_threading_mode(std::launch::deferred);
+                std::vector<mapnik::vector_tile_impl::merc_tile_ptr> one_source;
+                one_source.push_back(source);
+                mapnik::vector_tile_impl::composite(*temp_tile,
+                                                    one_source,
+                                                    task_map,
+                                                    task_ren,
+                                                    scale_denominator,
+                                                    offset_x,
+                                                    offset_y,
+                                                    reencode);
+                return temp_tile;
+            }));
+        }
+        for (auto & future : futures)
+        {
+            mapnik::vector_tile_impl::merc_tile_ptr temp_tile = future.get();
+            if (temp_tile->size() > 0)
+            {
+                merge_from_compressed_buffer(*target_tile, temp_tile->data(), temp_tile->size(), false, false);
+            }
+        }
+        return;
+    }
+
     mapnik::vector_tile_impl::processor ren(map);
     ren.set_fill_type(fill_type);
     ren.set_simplify_distance(simplify_distance);
@@ -554,6 +1020,7 @@ v8::Local<v8::Value> VectorTile::_compositeSync(Nan::NAN_METHOD_ARGS_TYPE info)
     std::string image_format = "webp";
     mapnik::scaling_method_e scaling_method = mapnik::SCALING_BILINEAR;
     std::launch threading_mode = std::launch::deferred;
+    bool parallel_sources = false;
 
     if (info.Length() > 1)
     {
@@ -646,6 +1113,16 @@ v8::Local<v8::Value> VectorTile::_compositeSync(Nan::NAN_METHOD_ARGS_TYPE info)
                 return scope.Escape(Nan::Undefined());
             }
         }
+        if (options->Has(Nan::New("parallel_sources").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("parallel_sources").ToLocalChecked());
+            if (!param_val->IsBoolean())
+            {
+                Nan::ThrowTypeError("option 'parallel_sources' must be a boolean");
+                return scope.Escape(Nan::Undefined());
+            }
+            parallel_sources = param_val->BooleanValue();
+        }
         if (options->Has(Nan::New("scale").ToLocalChecked()))
         {
             v8::Local<v8::Value> bind_opt = options->Get(Nan::New("scale").ToLocalChecked());
@@ -794,6 +1271,7 @@ v8::Local<v8::Value> VectorTile::_compositeSync(Nan::NAN_METHOD_ARGS_TYPE info)
     }
     try
     {
+        target_vt->detach_tile();
         _composite(target_vt,
                    vtiles_vec,
                    scale_factor,
@@ -810,7 +1288,9 @@ v8::Local<v8::Value> VectorTile::_compositeSync(Nan::NAN_METHOD_ARGS_TYPE info)
                    process_all_rings,
                    image_format,
                    scaling_method,
-                   threading_mode);
+                   threading_mode,
+                   parallel_sources);
+        target_vt->invalidate_query_index();
     }
     catch (std::exception const& ex)
     {
@@ -842,6 +1322,8 @@ typedef struct
     std::string image_format;
     mapnik::scaling_method_e scaling_method;
     std::launch threading_mode;
+    bool parallel_sources;
+    node_mapnik::async_trace trace;
     std::string error_name;
     Nan::Persistent<v8::Function> cb;
 } vector_tile_composite_baton_t;
@@ -881,6 +1363,11 @@ typedef struct
  * @param {string} [options.scaling_method=bilinear] - can be any 
  * of the <mapnik.imageScaling> methods
  * @param {string} [options.threading_mode=deferred]
+ * @param {boolean} [options.parallel_sources=false] - process each source
+ * tile in its own thread and merge the results afterwards, so composite
+ * latency tracks the slowest source instead of the sum of all of them.
+ * Output layers always follow the input array order, whereas the
+ * sequential path lists directly-copied same-tile sources first.
  * @param {Function} callback - `function(err)`
  * @example
  * var vt1 = new mapnik.VectorTile(0,0,0);
@@ -942,6 +1429,7 @@ NAN_METHOD(VectorTile::composite)
     std::string image_format = "webp";
     mapnik::scaling_method_e scaling_method = mapnik::SCALING_BILINEAR;
     std::launch threading_mode = std::launch::deferred;
+    bool parallel_sources = false;
     std::string merc_srs("+init=epsg:3857");
 
     if (info.Length() > 2)
@@ -1020,6 +1508,16 @@ NAN_METHOD(VectorTile::composite)
                 return;
             }
         }
+        if (options->Has(Nan::New("parallel_sources").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("parallel_sources").ToLocalChecked());
+            if (!param_val->IsBoolean())
+            {
+                Nan::ThrowTypeError("option 'parallel_sources' must be a boolean");
+                return;
+            }
+            parallel_sources = param_val->BooleanValue();
+        }
         if (options->Has(Nan::New("simplify_distance").ToLocalChecked())) 
         {
             v8::Local<v8::Value> param_val = options->Get(Nan::New("simplify_distance").ToLocalChecked());
@@ -1180,6 +1678,7 @@ NAN_METHOD(VectorTile::composite)
     closure->scaling_method = scaling_method;
     closure->image_format = image_format;
     closure->threading_mode = threading_mode;
+    closure->parallel_sources = parallel_sources;
     closure->d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
     closure->error = false;
     closure->vtiles.reserve(num_tiles);
@@ -1205,6 +1704,7 @@ NAN_METHOD(VectorTile::composite)
     }
     closure->d->Ref();
     closure->cb.Reset(callback.As<v8::Function>());
+    closure->d->detach_tile();
     uv_queue_work(uv_default_loop(), &closure->request, EIO_Composite, (uv_after_work_cb)EIO_AfterComposite);
     return;
 }
@@ -1212,6 +1712,7 @@ NAN_METHOD(VectorTile::composite)
 void VectorTile::EIO_Composite(uv_work_t* req)
 {
     vector_tile_composite_baton_t *closure = static_cast<vector_tile_composite_baton_t *>(req->data);
+    node_mapnik::trace_scope tracing(closure->trace, "vtile.composite");
     try
     {
         _composite(closure->d,
@@ -1230,7 +1731,8 @@ void VectorTile::EIO_Composite(uv_work_t* req)
                    closure->process_all_rings,
                    closure->image_format,
                    closure->scaling_method,
-                   closure->threading_mode);
+                   closure->threading_mode,
+                   closure->parallel_sources);
     }
     catch (std::exception const& ex)
     {
@@ -1251,6 +1753,7 @@ void VectorTile::EIO_AfterComposite(uv_work_t* req)
     }
     else
     {
+        closure->d->invalidate_query_index();
         v8::Local<v8::Value> argv[2] = { Nan::Null(), closure->d->handle() };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
     }
@@ -1263,85 +1766,336 @@ void VectorTile::EIO_AfterComposite(uv_work_t* req)
     delete closure;
 }
 
-/**
- * Get the extent of this vector tile
- *
- * @memberof VectorTile
- * @instance
- * @name extent
- * @returns {Array<number>} array of extent in the form of `[minx,miny,maxx,maxy]`
- * @example
- * var vt = new mapnik.VectorTile(9,112,195);
- * var extent = vt.extent();
- * console.log(extent); // [-11271098.44281895, 4696291.017841229, -11192826.925854929, 4774562.534805248]
- */
-NAN_METHOD(VectorTile::extent)
+struct pyramid_tile_result
 {
-    VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
-    v8::Local<v8::Array> arr = Nan::New<v8::Array>(4);
-    mapnik::box2d<double> const& e = d->tile_->extent();
-    arr->Set(0, Nan::New<v8::Number>(e.minx()));
-    arr->Set(1, Nan::New<v8::Number>(e.miny()));
-    arr->Set(2, Nan::New<v8::Number>(e.maxx()));
-    arr->Set(3, Nan::New<v8::Number>(e.maxy()));
-    info.GetReturnValue().Set(arr);
-    return;
-}
+    int z;
+    int x;
+    int y;
+    std::string data;
+};
 
-/**
- * Get the extent including the buffer of this vector tile
- *
- * @memberof VectorTile
- * @instance
- * @name bufferedExtent
- * @returns {Array<number>} extent - `[minx, miny, maxx, maxy]`
- * @example
- * var vt = new mapnik.VectorTile(9,112,195);
- * var extent = vt.bufferedExtent();
- * console.log(extent); // [-11273544.4277, 4693845.0329, -11190380.9409, 4777008.5197];
- */
-NAN_METHOD(VectorTile::bufferedExtent)
+struct generate_pyramid_baton_t
 {
-    VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
-    v8::Local<v8::Array> arr = Nan::New<v8::Array>(4);
-    mapnik::box2d<double> e = d->tile_->get_buffered_extent();
-    arr->Set(0, Nan::New<v8::Number>(e.minx()));
-    arr->Set(1, Nan::New<v8::Number>(e.miny()));
-    arr->Set(2, Nan::New<v8::Number>(e.maxx()));
-    arr->Set(3, Nan::New<v8::Number>(e.maxy()));
-    info.GetReturnValue().Set(arr);
-    return;
-}
+    uv_work_t request;
+    VectorTile* d;
+    unsigned minzoom;
+    unsigned maxzoom;
+    unsigned concurrency;
+    std::vector<pyramid_tile_result> results;
+    bool error;
+    std::string error_name;
+    Nan::Persistent<v8::Function> cb;
+};
 
 /**
- * Get the names of all of the layers in this vector tile
+ * Generate all descendant tiles of this tile between minzoom and
+ * maxzoom in one native pass, compositing the source into each child
+ * on a fixed pool of parallel tasks and returning the encoded tile
+ * buffers keyed by z/x/y. Replaces one composite() round trip per
+ * child tile when building overzoom pyramids.
  *
  * @memberof VectorTile
  * @instance
- * @name names
- * @returns {Array<string>} layer names
+ * @name generatePyramid
+ * @param {number} minzoom first emitted zoom level (at or below maxzoom,
+ * greater than this tile's zoom)
+ * @param {number} maxzoom last emitted zoom level (at most 6 levels
+ * below this tile)
+ * @param {Object} [options] options with an optional `concurrency` key
+ * @param {Function} callback - `function(err, tiles)` where tiles is an
+ * array of {z, x, y, buffer}
  * @example
- * var vt = new mapnik.VectorTile(0,0,0);
- * var data = fs.readFileSync('./path/to/data.mvt');
- * vt.addDataSync(data);
- * console.log(vt.names()); // ['layer-name', 'another-layer']
+ * vt.generatePyramid(vt.z + 1, vt.z + 2, function(err, tiles) {
+ *   if (err) throw err;
+ *   console.log(tiles.length); // 4 + 16
+ * });
  */
-NAN_METHOD(VectorTile::names)
+NAN_METHOD(VectorTile::generatePyramid)
 {
     VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
-    std::vector<std::string> const& names = d->tile_->get_layers();
-    v8::Local<v8::Array> arr = Nan::New<v8::Array>(names.size());
-    unsigned idx = 0;
-    for (std::string const& name : names)
+
+    v8::Local<v8::Value> callback = info[info.Length()-1];
+    if (info.Length() < 3 || !callback->IsFunction())
     {
-        arr->Set(idx++,Nan::New<v8::String>(name).ToLocalChecked());
+        Nan::ThrowTypeError("expects minzoom, maxzoom, optional options and a callback");
+        return;
     }
-    info.GetReturnValue().Set(arr);
-    return;
-}
-
-/**
- * Extract the layer by a given name to a new vector tile
+    if (!info[0]->IsNumber() || !info[1]->IsNumber())
+    {
+        Nan::ThrowTypeError("minzoom and maxzoom must be numbers");
+        return;
+    }
+    int source_z = d->get_tile()->z();
+    int minzoom = info[0]->IntegerValue();
+    int maxzoom = info[1]->IntegerValue();
+    if (minzoom <= source_z || maxzoom < minzoom)
+    {
+        Nan::ThrowTypeError("minzoom must be greater than this tile's zoom and at most maxzoom");
+        return;
+    }
+    if (maxzoom - source_z > 6)
+    {
+        Nan::ThrowTypeError("maxzoom can be at most 6 levels below this tile's zoom");
+        return;
+    }
+
+    unsigned concurrency = 4;
+    if (info.Length() > 3)
+    {
+        if (!info[2]->IsObject())
+        {
+            Nan::ThrowTypeError("optional third argument must be an options object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[2]->ToObject();
+        if (options->Has(Nan::New("concurrency").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("concurrency").ToLocalChecked());
+            if (!param_val->IsNumber() || param_val->IntegerValue() < 1)
+            {
+                Nan::ThrowTypeError("option 'concurrency' must be a positive integer");
+                return;
+            }
+            concurrency = static_cast<unsigned>(param_val->IntegerValue());
+        }
+    }
+
+    generate_pyramid_baton_t *closure = new generate_pyramid_baton_t();
+    closure->request.data = closure;
+    closure->d = d;
+    closure->minzoom = static_cast<unsigned>(minzoom);
+    closure->maxzoom = static_cast<unsigned>(maxzoom);
+    closure->concurrency = concurrency;
+    closure->error = false;
+    closure->cb.Reset(callback.As<v8::Function>());
+    uv_queue_work(uv_default_loop(), &closure->request, EIO_GeneratePyramid, (uv_after_work_cb)EIO_AfterGeneratePyramid);
+    d->Ref();
+    return;
+}
+
+void VectorTile::EIO_GeneratePyramid(uv_work_t* req)
+{
+    generate_pyramid_baton_t *closure = static_cast<generate_pyramid_baton_t *>(req->data);
+    try
+    {
+        VectorTile* d = closure->d;
+        int source_z = d->get_tile()->z();
+        int source_x = d->get_tile()->x();
+        int source_y = d->get_tile()->y();
+        std::uint32_t tile_size = d->tile_size();
+        std::int32_t buffer_size = d->buffer_size();
+
+        // enumerate every descendant coordinate up front, then let a
+        // fixed pool of tasks pull children off a shared cursor; the
+        // source stays decompressed in this tile for every composite
+        struct child_coord { int z; int x; int y; };
+        std::vector<child_coord> children;
+        for (unsigned z = closure->minzoom; z <= closure->maxzoom; ++z)
+        {
+            int levels = static_cast<int>(z) - source_z;
+            int span = 1 << levels;
+            int x0 = source_x * span;
+            int y0 = source_y * span;
+            for (int x = x0; x < x0 + span; ++x)
+            {
+                for (int y = y0; y < y0 + span; ++y)
+                {
+                    child_coord c;
+                    c.z = static_cast<int>(z);
+                    c.x = x;
+                    c.y = y;
+                    children.push_back(c);
+                }
+            }
+        }
+        closure->results.resize(children.size());
+
+        std::vector<VectorTile*> source_vec;
+        source_vec.push_back(d);
+        std::atomic<std::size_t> cursor(0);
+        unsigned workers = closure->concurrency;
+        if (workers > children.size())
+        {
+            workers = static_cast<unsigned>(children.size());
+        }
+        auto run_children = [&]()
+        {
+            for (;;)
+            {
+                std::size_t idx = cursor.fetch_add(1);
+                if (idx >= children.size()) break;
+                child_coord const& c = children[idx];
+                mapnik::vector_tile_impl::merc_tile_ptr child_tile =
+                    std::make_shared<mapnik::vector_tile_impl::merc_tile>(c.x, c.y, c.z, tile_size, buffer_size);
+                mapnik::Map child_map(tile_size, tile_size, "+init=epsg:3857");
+                child_map.set_maximum_extent(child_tile->get_buffered_extent());
+                // match the composite() defaults so pyramid children are
+                // byte-identical to per-child composite() output
+                mapnik::vector_tile_impl::processor ren(child_map);
+                ren.set_area_threshold(0.1);
+                ren.set_strictly_simple(true);
+                ren.set_multi_polygon_union(false);
+                ren.set_fill_type(mapnik::vector_tile_impl::positive_fill);
+                ren.set_process_all_rings(false);
+                ren.set_simplify_distance(0.0);
+                ren.set_scale_factor(1.0);
+                ren.set_scaling_method(mapnik::SCALING_BILINEAR);
+                ren.set_image_format("webp");
+                ren.set_threading_mode(std::launch::deferred);
+                std::vector<mapnik::vector_tile_impl::merc_tile_ptr> sources;
+                sources.push_back(d->get_tile());
+                mapnik::vector_tile_impl::composite(*child_tile,
+                                                    sources,
+                                                    child_map,
+                                                    ren,
+                                                    0.0,  // scale_denominator
+                                                    0,    // offset_x
+                                                    0,    // offset_y
+                                                    false);
+                pyramid_tile_result & result = closure->results[idx];
+                result.z = c.z;
+                result.x = c.x;
+                result.y = c.y;
+                result.data.assign(child_tile->data(), child_tile->size());
+            }
+        };
+        if (workers <= 1)
+        {
+            run_children();
+        }
+        else
+        {
+            std::vector<std::future<void> > futures;
+            futures.reserve(workers);
+            for (unsigned i = 0; i < workers; ++i)
+            {
+                futures.push_back(std::async(std::launch::async, run_children));
+            }
+            for (auto & future : futures)
+            {
+                future.get();
+            }
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        closure->error = true;
+        closure->error_name = ex.what();
+        closure->results.clear();
+    }
+}
+
+void VectorTile::EIO_AfterGeneratePyramid(uv_work_t* req)
+{
+    Nan::HandleScope scope;
+    generate_pyramid_baton_t *closure = static_cast<generate_pyramid_baton_t *>(req->data);
+    if (closure->error)
+    {
+        v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+    }
+    else
+    {
+        v8::Local<v8::Array> arr = Nan::New<v8::Array>(closure->results.size());
+        for (std::size_t i = 0; i < closure->results.size(); ++i)
+        {
+            pyramid_tile_result & result = closure->results[i];
+            v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+            obj->Set(Nan::New("z").ToLocalChecked(), Nan::New<v8::Integer>(result.z));
+            obj->Set(Nan::New("x").ToLocalChecked(), Nan::New<v8::Integer>(result.x));
+            obj->Set(Nan::New("y").ToLocalChecked(), Nan::New<v8::Integer>(result.y));
+            obj->Set(Nan::New("buffer").ToLocalChecked(),
+                     node_mapnik::pooled_buffer_to_v8(std::move(result.data)));
+            arr->Set(i, obj);
+        }
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), arr };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+    }
+    closure->d->Unref();
+    closure->cb.Reset();
+    delete closure;
+}
+
+
+/**
+ * Get the extent of this vector tile
+ *
+ * @memberof VectorTile
+ * @instance
+ * @name extent
+ * @returns {Array<number>} array of extent in the form of `[minx,miny,maxx,maxy]`
+ * @example
+ * var vt = new mapnik.VectorTile(9,112,195);
+ * var extent = vt.extent();
+ * console.log(extent); // [-11271098.44281895, 4696291.017841229, -11192826.925854929, 4774562.534805248]
+ */
+NAN_METHOD(VectorTile::extent)
+{
+    VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
+    v8::Local<v8::Array> arr = Nan::New<v8::Array>(4);
+    mapnik::box2d<double> const& e = d->tile_->extent();
+    arr->Set(0, Nan::New<v8::Number>(e.minx()));
+    arr->Set(1, Nan::New<v8::Number>(e.miny()));
+    arr->Set(2, Nan::New<v8::Number>(e.maxx()));
+    arr->Set(3, Nan::New<v8::Number>(e.maxy()));
+    info.GetReturnValue().Set(arr);
+    return;
+}
+
+/**
+ * Get the extent including the buffer of this vector tile
+ *
+ * @memberof VectorTile
+ * @instance
+ * @name bufferedExtent
+ * @returns {Array<number>} extent - `[minx, miny, maxx, maxy]`
+ * @example
+ * var vt = new mapnik.VectorTile(9,112,195);
+ * var extent = vt.bufferedExtent();
+ * console.log(extent); // [-11273544.4277, 4693845.0329, -11190380.9409, 4777008.5197];
+ */
+NAN_METHOD(VectorTile::bufferedExtent)
+{
+    VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
+    v8::Local<v8::Array> arr = Nan::New<v8::Array>(4);
+    mapnik::box2d<double> e = d->tile_->get_buffered_extent();
+    arr->Set(0, Nan::New<v8::Number>(e.minx()));
+    arr->Set(1, Nan::New<v8::Number>(e.miny()));
+    arr->Set(2, Nan::New<v8::Number>(e.maxx()));
+    arr->Set(3, Nan::New<v8::Number>(e.maxy()));
+    info.GetReturnValue().Set(arr);
+    return;
+}
+
+/**
+ * Get the names of all of the layers in this vector tile
+ *
+ * @memberof VectorTile
+ * @instance
+ * @name names
+ * @returns {Array<string>} layer names
+ * @example
+ * var vt = new mapnik.VectorTile(0,0,0);
+ * var data = fs.readFileSync('./path/to/data.mvt');
+ * vt.addDataSync(data);
+ * console.log(vt.names()); // ['layer-name', 'another-layer']
+ */
+NAN_METHOD(VectorTile::names)
+{
+    VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
+    std::vector<std::string> const& names = d->tile_->get_layers();
+    v8::Local<v8::Array> arr = Nan::New<v8::Array>(names.size());
+    unsigned idx = 0;
+    for (std::string const& name : names)
+    {
+        arr->Set(idx++,Nan::New<v8::String>(name).ToLocalChecked());
+    }
+    info.GetReturnValue().Set(arr);
+    return;
+}
+
+/**
+ * Extract the layer by a given name to a new vector tile
  *
  * @memberof VectorTile
  * @instance
@@ -1377,23 +2131,12 @@ NAN_METHOD(VectorTile::layer)
         Nan::ThrowTypeError("layer does not exist in vector tile");
         return;
     }
-    protozero::pbf_reader layer_msg;
     VectorTile* v = new VectorTile(d->get_tile()->z(), d->get_tile()->x(), d->get_tile()->y(), d->tile_size(), d->buffer_size());
-    protozero::pbf_reader tile_message(d->get_tile()->get_reader());
-    while (tile_message.next(mapnik::vector_tile_impl::Tile_Encoding::LAYERS))
+    const char * layer_data = nullptr;
+    std::size_t layer_size = 0;
+    if (d->layer_bytes(layer_name, layer_data, layer_size))
     {
-        auto data_pair = tile_message.get_data();
-        protozero::pbf_reader layer_message(data_pair);
-        if (!layer_message.next(mapnik::vector_tile_impl::Layer_Encoding::NAME))
-        {
-            continue;
-        }
-        std::string name = layer_message.get_string();
-        if (layer_name == name)
-        {
-            v->get_tile()->append_layer_buffer(data_pair.first, data_pair.second, layer_name);
-            break;
-        }
+        v->get_tile()->append_layer_buffer(layer_data, layer_size, layer_name);
     }
     v8::Local<v8::Value> ext = Nan::New<v8::External>(v);
     v8::Local<v8::Object> vt_obj = Nan::New(constructor)->GetFunction()->NewInstance(1, &ext);
@@ -1501,6 +2244,8 @@ typedef struct
     double lon;
     double lat;
     double tolerance;
+    bool use_index;
+    node_mapnik::async_trace trace;
     bool error;
     std::vector<query_result> result;
     std::string layer_name;
@@ -1542,9 +2287,14 @@ typedef struct
  * @param {Object} [options]
  * @param {number} [options.tolerance=0] include features a specific distance from the 
  * lon/lat query in the response
- * @param {string} [options.layer] layer - Pass a layer name to restrict 
- * the query results to a single layer in the vector tile. Get all possible 
+ * @param {string} [options.layer] layer - Pass a layer name to restrict
+ * the query results to a single layer in the vector tile. Get all possible
  * layer names in the vector tile with {@link VectorTile#names}
+ * @param {boolean} [options.index=false] - If true a spatial index over the
+ * tile's features is built lazily on first use and reused by later queries,
+ * making repeated point queries on the same tile much faster for large tiles.
+ * The index is dropped automatically when the tile data changes (setData,
+ * addData, composite, etc). Costs memory proportional to the decoded features.
  * @param {Function} callback(err, features)
  * @returns {Array<mapnik.Feature>} an array of {@link mapnik.Feature} objects
  * @example
@@ -1567,6 +2317,7 @@ NAN_METHOD(VectorTile::query)
     }
     double tolerance = 0.0; // meters
     std::string layer_name("");
+    bool use_index = false;
     if (info.Length() > 2)
     {
         v8::Local<v8::Object> options = Nan::New<v8::Object>();
@@ -1596,6 +2347,16 @@ NAN_METHOD(VectorTile::query)
             }
             layer_name = TOSTR(layer_id);
         }
+        if (options->Has(Nan::New("index").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> index_val = options->Get(Nan::New("index").ToLocalChecked());
+            if (!index_val->IsBoolean())
+            {
+                Nan::ThrowTypeError("index value must be a boolean");
+                return;
+            }
+            use_index = index_val->BooleanValue();
+        }
     }
 
     double lon = info[0]->NumberValue();
@@ -1607,7 +2368,7 @@ NAN_METHOD(VectorTile::query)
     {
         try  
         {
-            std::vector<query_result> result = _query(d, lon, lat, tolerance, layer_name);
+            std::vector<query_result> result = _query(d, lon, lat, tolerance, layer_name, use_index);
             v8::Local<v8::Array> arr = _queryResultToV8(result);
             info.GetReturnValue().Set(arr);
             return;
@@ -1627,6 +2388,7 @@ NAN_METHOD(VectorTile::query)
         closure->lat = lat;
         closure->tolerance = tolerance;
         closure->layer_name = layer_name;
+        closure->use_index = use_index;
         closure->d = d;
         closure->error = false;
         closure->cb.Reset(callback.As<v8::Function>());
@@ -1639,9 +2401,10 @@ NAN_METHOD(VectorTile::query)
 void VectorTile::EIO_Query(uv_work_t* req)
 {
     vector_tile_query_baton_t *closure = static_cast<vector_tile_query_baton_t *>(req->data);
+    node_mapnik::trace_scope tracing(closure->trace, "vtile.query");
     try
     {
-        closure->result = _query(closure->d, closure->lon, closure->lat, closure->tolerance, closure->layer_name);
+        closure->result = _query(closure->d, closure->lon, closure->lat, closure->tolerance, closure->layer_name, closure->use_index);
     }
     catch (std::exception const& ex)
     {
@@ -1672,7 +2435,7 @@ void VectorTile::EIO_AfterQuery(uv_work_t* req)
     delete closure;
 }
 
-std::vector<query_result> VectorTile::_query(VectorTile* d, double lon, double lat, double tolerance, std::string const& layer_name)
+std::vector<query_result> VectorTile::_query(VectorTile* d, double lon, double lat, double tolerance, std::string const& layer_name, bool use_index)
 {
     std::vector<query_result> arr;
     if (d->tile_->is_empty())
@@ -1696,6 +2459,51 @@ std::vector<query_result> VectorTile::_query(VectorTile* d, double lon, double l
     }
 
     mapnik::coord2d pt(x,y);
+    if (use_index)
+    {
+        std::shared_ptr<detail::tile_query_index> index = d->ensure_query_index();
+        detail::query_index_layer::box_type search_box(
+            detail::query_index_layer::point_type(x - tolerance, y - tolerance),
+            detail::query_index_layer::point_type(x + tolerance, y + tolerance));
+        // per-call bump arena for the candidate scratch: freed wholesale
+        // when the query returns instead of per layer through malloc
+        node_mapnik::monotonic_arena arena;
+        typedef node_mapnik::arena_allocator<detail::query_index_layer::value_type> candidate_alloc;
+        typedef std::vector<detail::query_index_layer::value_type, candidate_alloc> candidate_vector;
+        for (auto const& layer : index->layers)
+        {
+            if (!layer_name.empty() && layer.name != layer_name)
+            {
+                continue;
+            }
+            candidate_vector candidates((candidate_alloc(arena)));
+            layer.rtree.query(boost::geometry::index::intersects(search_box), std::back_inserter(candidates));
+            for (auto const& candidate : candidates)
+            {
+                mapnik::feature_ptr feature = layer.features[candidate.second];
+                auto const& geom = feature->get_geometry();
+                auto p2p = path_to_point_distance(geom,x,y);
+                if (!tr.backward(p2p.x_hit,p2p.y_hit,z))
+                {
+                    /* LCOV_EXCL_START */
+                    throw std::runtime_error("could not reproject lon/lat to mercator");
+                    /* LCOV_EXCL_STOP */
+                }
+                if (p2p.distance >= 0 && p2p.distance <= tolerance)
+                {
+                    query_result res;
+                    res.x_hit = p2p.x_hit;
+                    res.y_hit = p2p.y_hit;
+                    res.distance = p2p.distance;
+                    res.layer = layer.name;
+                    res.feature = feature;
+                    arr.push_back(std::move(res));
+                }
+            }
+        }
+        std::sort(arr.begin(), arr.end(), _querySort);
+        return arr;
+    }
     if (!layer_name.empty())
     {
         protozero::pbf_reader layer_msg;
@@ -2047,13 +2855,49 @@ void VectorTile::_queryMany(queryMany_result & result,
 
     if (fs)
     {
+        // index the query points up front so each feature is decoded once
+        // and only runs the exact distance check against the points near
+        // its envelope, instead of against every point in the batch
+        using point_rtree_value = std::pair<detail::query_index_layer::point_type, std::size_t>;
+        using point_rtree_type = boost::geometry::index::rtree<point_rtree_value, boost::geometry::index::quadratic<16> >;
+        // per-call bump arena for the point/candidate scratch; one
+        // wholesale free when the batch completes
+        node_mapnik::monotonic_arena arena;
+        typedef node_mapnik::arena_allocator<point_rtree_value> point_alloc;
+        typedef std::vector<point_rtree_value, point_alloc> point_vector;
+        point_vector point_values((point_alloc(arena)));
+        point_values.reserve(points.size());
+        for (std::size_t p = 0; p < points.size(); ++p)
+        {
+            point_values.emplace_back(detail::query_index_layer::point_type(points[p].x, points[p].y), p);
+        }
+        point_rtree_type point_index(point_values.begin(), point_values.end());
+        point_vector candidates((point_alloc(arena)));
         mapnik::feature_ptr feature;
         unsigned idx = 0;
         while ((feature = fs->next()))
         {
+            mapnik::box2d<double> envelope = mapnik::geometry::envelope(feature->get_geometry());
+            if (!envelope.valid())
+            {
+                continue;
+            }
+            envelope.pad(tolerance);
+            candidates.clear();
+            point_index.query(boost::geometry::index::intersects(
+                                  detail::query_index_layer::box_type(
+                                      detail::query_index_layer::point_type(envelope.minx(), envelope.miny()),
+                                      detail::query_index_layer::point_type(envelope.maxx(), envelope.maxy()))),
+                              std::back_inserter(candidates));
+            // keep the per-point hit order identical to the full scan
+            std::sort(candidates.begin(), candidates.end(),
+                      [](point_rtree_value const& a, point_rtree_value const& b) {
+                          return a.second < b.second;
+                      });
             unsigned has_hit = 0;
-            for (std::size_t p = 0; p < points.size(); ++p)
+            for (auto const& candidate : candidates)
             {
+                std::size_t p = candidate.second;
                 mapnik::coord2d const& pt = points[p];
                 auto const& geom = feature->get_geometry();
                 auto p2p = path_to_point_distance(geom,pt.x,pt.y);
@@ -2478,67 +3322,485 @@ struct json_value_visitor
     }
 };
 
-/**
- * Get a JSON representation of this tile
- *
- * @memberof VectorTile
- * @instance
- * @name toJSON
- * @param {Object} [options]
- * @param {boolean} [options.decode_geometry=false] return geometry as integers
- * relative to the tile grid
- * @returns {Object} json representation of this tile with name, extent,
- * version, and feature properties
- * @example
- * var vt = mapnik.VectorTile(10,131,242);
- * var buffer = fs.readFileSync('./path/to/data.mvt');
- * vt.setData(buffer);
- * var json = vectorTile.toJSON();
- * console.log(json); 
- * // { 
- * //   name: 'layer-name',
- * //   extent: 4096, 
- * //   version: 2,
- * //   features: [ ... ] // array of objects
- * // }
- */
-NAN_METHOD(VectorTile::toJSON)
+namespace detail {
+
+// minimal JSON string escaping: quotes, backslashes and control
+// characters; other bytes pass through untouched (layer data is UTF-8)
+void json_escape_append(std::string & out, std::string const& value)
 {
-    bool decode_geometry = false;
-    if (info.Length() >= 1)
+    out += '"';
+    for (char c : value)
     {
-        if (!info[0]->IsObject())
+        switch (c)
         {
-            Nan::ThrowError("The first argument must be an object");
-            return;
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                }
+                else
+                {
+                    out += c;
+                }
         }
-        v8::Local<v8::Object> options = info[0]->ToObject();
+    }
+    out += '"';
+}
 
-        if (options->Has(Nan::New("decode_geometry").ToLocalChecked()))
-        {
-            v8::Local<v8::Value> param_val = options->Get(Nan::New("decode_geometry").ToLocalChecked());
-            if (!param_val->IsBoolean())
-            {
-                Nan::ThrowError("option 'decode_geometry' must be a boolean");
-                return;
-            }
-            decode_geometry = param_val->BooleanValue();
-        }
+void base64_append(std::string & out, const char * data, std::size_t size)
+{
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::size_t i = 0;
+    for (; i + 3 <= size; i += 3)
+    {
+        std::uint32_t n = (static_cast<unsigned char>(data[i]) << 16) |
+                          (static_cast<unsigned char>(data[i+1]) << 8) |
+                           static_cast<unsigned char>(data[i+2]);
+        out += table[(n >> 18) & 63];
+        out += table[(n >> 12) & 63];
+        out += table[(n >> 6) & 63];
+        out += table[n & 63];
     }
+    if (i < size)
+    {
+        std::uint32_t n = static_cast<unsigned char>(data[i]) << 16;
+        if (i + 1 < size) n |= static_cast<unsigned char>(data[i+1]) << 8;
+        out += table[(n >> 18) & 63];
+        out += table[(n >> 12) & 63];
+        out += (i + 1 < size) ? table[(n >> 6) & 63] : '=';
+        out += '=';
+    }
+}
 
-    VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
-    try
+void json_number_append(std::string & out, double value)
+{
+    if (!std::isfinite(value))
     {
-        protozero::pbf_reader tile_msg = d->tile_->get_reader();
-        v8::Local<v8::Array> arr = Nan::New<v8::Array>(d->tile_->get_layers().size());
-        std::size_t l_idx = 0;
-        while (tile_msg.next(mapnik::vector_tile_impl::Tile_Encoding::LAYERS))
-        {
-            protozero::pbf_reader layer_msg = tile_msg.get_message();
-            v8::Local<v8::Object> layer_obj = Nan::New<v8::Object>();
-            std::vector<std::string> layer_keys;
-            mapnik::vector_tile_impl::layer_pbf_attr_type layer_values;
-            std::vector<protozero::pbf_reader> layer_features;
+        // JSON has no NaN/Infinity; JSON.stringify of the object form
+        // would produce null for these as well
+        out += "null";
+        return;
+    }
+    if (value >= -9007199254740992.0 && value <= 9007199254740992.0 &&
+        value == static_cast<double>(static_cast<std::int64_t>(value)))
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(value));
+        out += buf;
+    }
+    else
+    {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.17g", value);
+        out += buf;
+    }
+}
+
+// mirrors json_value_visitor for the native serializer
+struct json_text_value_visitor
+{
+    explicit json_text_value_visitor(std::string & out) : out_(out) {}
+
+    void operator() (std::string const& val) { json_escape_append(out_, val); }
+    void operator() (bool const& val) { out_ += val ? "true" : "false"; }
+    void operator() (std::int64_t const& val)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(val));
+        out_ += buf;
+    }
+    void operator() (std::uint64_t const& val)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(val));
+        out_ += buf;
+    }
+    void operator() (float const& val) { json_number_append(out_, static_cast<double>(val)); }
+    void operator() (double const& val) { json_number_append(out_, val); }
+
+    std::string & out_;
+};
+
+} // end ns detail
+
+// Serializes the same structure toJSON builds as V8 objects straight
+// into UTF-8 JSON text, so a large tile dump costs one Buffer instead of
+// millions of handles. Geometries are emitted in their undecoded packed
+// form (like decode_geometry: false) and raster data as a base64 string.
+void VectorTile::_toJSONBuffer(VectorTile* d, std::string & out)
+{
+    protozero::pbf_reader tile_msg = d->get_tile()->get_reader();
+    out += '[';
+    bool first_layer = true;
+    while (tile_msg.next(mapnik::vector_tile_impl::Tile_Encoding::LAYERS))
+    {
+        if (!first_layer) out += ',';
+        first_layer = false;
+        protozero::pbf_reader layer_msg = tile_msg.get_message();
+        out += '{';
+        bool first_field = true;
+        std::vector<std::string> layer_keys;
+        mapnik::vector_tile_impl::layer_pbf_attr_type layer_values;
+        std::vector<protozero::pbf_reader> layer_features;
+        protozero::pbf_reader val_msg;
+        while (layer_msg.next())
+        {
+            switch (layer_msg.tag())
+            {
+                case mapnik::vector_tile_impl::Layer_Encoding::NAME:
+                    if (!first_field) out += ',';
+                    first_field = false;
+                    out += "\"name\":";
+                    detail::json_escape_append(out, layer_msg.get_string());
+                    break;
+                case mapnik::vector_tile_impl::Layer_Encoding::FEATURES:
+                    layer_features.push_back(layer_msg.get_message());
+                    break;
+                case mapnik::vector_tile_impl::Layer_Encoding::KEYS:
+                    layer_keys.push_back(layer_msg.get_string());
+                    break;
+                case mapnik::vector_tile_impl::Layer_Encoding::VALUES:
+                    val_msg = layer_msg.get_message();
+                    while (val_msg.next())
+                    {
+                        switch(val_msg.tag())
+                        {
+                            case mapnik::vector_tile_impl::Value_Encoding::STRING:
+                                layer_values.push_back(val_msg.get_string());
+                                break;
+                            case mapnik::vector_tile_impl::Value_Encoding::FLOAT:
+                                layer_values.push_back(val_msg.get_float());
+                                break;
+                            case mapnik::vector_tile_impl::Value_Encoding::DOUBLE:
+                                layer_values.push_back(val_msg.get_double());
+                                break;
+                            case mapnik::vector_tile_impl::Value_Encoding::INT:
+                                layer_values.push_back(val_msg.get_int64());
+                                break;
+                            case mapnik::vector_tile_impl::Value_Encoding::UINT:
+                                // LCOV_EXCL_START
+                                layer_values.push_back(val_msg.get_uint64());
+                                break;
+                                // LCOV_EXCL_STOP
+                            case mapnik::vector_tile_impl::Value_Encoding::SINT:
+                                // LCOV_EXCL_START
+                                layer_values.push_back(val_msg.get_sint64());
+                                break;
+                                // LCOV_EXCL_STOP
+                            case mapnik::vector_tile_impl::Value_Encoding::BOOL:
+                                layer_values.push_back(val_msg.get_bool());
+                                break;
+                            default:
+                                // LCOV_EXCL_START
+                                val_msg.skip();
+                                break;
+                                // LCOV_EXCL_STOP
+                        }
+                    }
+                    break;
+                case mapnik::vector_tile_impl::Layer_Encoding::EXTENT:
+                {
+                    if (!first_field) out += ',';
+                    first_field = false;
+                    char buf[32];
+                    std::snprintf(buf, sizeof(buf), "\"extent\":%u", layer_msg.get_uint32());
+                    out += buf;
+                    break;
+                }
+                case mapnik::vector_tile_impl::Layer_Encoding::VERSION:
+                {
+                    if (!first_field) out += ',';
+                    first_field = false;
+                    char buf[32];
+                    std::snprintf(buf, sizeof(buf), "\"version\":%u", layer_msg.get_uint32());
+                    out += buf;
+                    break;
+                }
+                default:
+                    // LCOV_EXCL_START
+                    layer_msg.skip();
+                    break;
+                    // LCOV_EXCL_STOP
+            }
+        }
+        if (!first_field) out += ',';
+        out += "\"features\":[";
+        bool first_feature = true;
+        for (auto feature_msg : layer_features)
+        {
+            if (!first_feature) out += ',';
+            first_feature = false;
+            out += '{';
+            bool first_feature_field = true;
+            std::pair<protozero::pbf_reader::const_uint32_iterator, protozero::pbf_reader::const_uint32_iterator> geom_itr;
+            std::pair<protozero::pbf_reader::const_uint32_iterator, protozero::pbf_reader::const_uint32_iterator> tag_itr;
+            bool has_geom = false;
+            bool has_geom_type = false;
+            bool has_tags = false;
+            while (feature_msg.next())
+            {
+                switch (feature_msg.tag())
+                {
+                    case mapnik::vector_tile_impl::Feature_Encoding::ID:
+                    {
+                        if (!first_feature_field) out += ',';
+                        first_feature_field = false;
+                        char buf[40];
+                        std::snprintf(buf, sizeof(buf), "\"id\":%llu",
+                                      static_cast<unsigned long long>(feature_msg.get_uint64()));
+                        out += buf;
+                        break;
+                    }
+                    case mapnik::vector_tile_impl::Feature_Encoding::TAGS:
+                        tag_itr = feature_msg.get_packed_uint32();
+                        has_tags = true;
+                        break;
+                    case mapnik::vector_tile_impl::Feature_Encoding::TYPE:
+                    {
+                        if (!first_feature_field) out += ',';
+                        first_feature_field = false;
+                        char buf[32];
+                        std::snprintf(buf, sizeof(buf), "\"type\":%d", feature_msg.get_enum());
+                        out += buf;
+                        has_geom_type = true;
+                        break;
+                    }
+                    case mapnik::vector_tile_impl::Feature_Encoding::GEOMETRY:
+                        geom_itr = feature_msg.get_packed_uint32();
+                        has_geom = true;
+                        break;
+                    case mapnik::vector_tile_impl::Feature_Encoding::RASTER:
+                    {
+                        if (!first_feature_field) out += ',';
+                        first_feature_field = false;
+                        auto im_buffer = feature_msg.get_data();
+                        out += "\"raster\":\"";
+                        detail::base64_append(out, im_buffer.first, im_buffer.second);
+                        out += '"';
+                        break;
+                    }
+                    default:
+                        // LCOV_EXCL_START
+                        feature_msg.skip();
+                        break;
+                        // LCOV_EXCL_STOP
+                }
+            }
+            if (!first_feature_field) out += ',';
+            out += "\"properties\":{";
+            if (has_tags)
+            {
+                bool first_property = true;
+                for (auto _i = tag_itr.first; _i != tag_itr.second;)
+                {
+                    std::size_t key_name = *(_i++);
+                    if (_i == tag_itr.second)
+                    {
+                        break;
+                    }
+                    std::size_t key_value = *(_i++);
+                    if (key_name < layer_keys.size() &&
+                        key_value < layer_values.size())
+                    {
+                        if (!first_property) out += ',';
+                        first_property = false;
+                        detail::json_escape_append(out, layer_keys.at(key_name));
+                        out += ':';
+                        mapnik::vector_tile_impl::pbf_attr_value_type val = layer_values.at(key_value);
+                        detail::json_text_value_visitor vv(out);
+                        mapnik::util::apply_visitor(vv, val);
+                    }
+                }
+            }
+            out += '}';
+            if (has_geom && has_geom_type)
+            {
+                out += ",\"geometry\":[";
+                bool first_vertex = true;
+                for (auto _i = geom_itr.first; _i != geom_itr.second; ++_i)
+                {
+                    if (!first_vertex) out += ',';
+                    first_vertex = false;
+                    char buf[16];
+                    std::snprintf(buf, sizeof(buf), "%u", *_i);
+                    out += buf;
+                }
+                out += ']';
+            }
+            out += '}';
+        }
+        out += "]}";
+    }
+    out += ']';
+}
+
+struct to_json_buffer_baton_t
+{
+    uv_work_t request;
+    VectorTile* d;
+    std::string result;
+    bool error;
+    std::string error_name;
+    Nan::Persistent<v8::Function> cb;
+};
+
+void VectorTile::EIO_ToJSONBuffer(uv_work_t* req)
+{
+    to_json_buffer_baton_t *closure = static_cast<to_json_buffer_baton_t *>(req->data);
+    try
+    {
+        _toJSONBuffer(closure->d, closure->result);
+    }
+    catch (std::exception const& ex)
+    {
+        // LCOV_EXCL_START
+        closure->error = true;
+        closure->error_name = ex.what();
+        // LCOV_EXCL_STOP
+    }
+}
+
+void VectorTile::EIO_AfterToJSONBuffer(uv_work_t* req)
+{
+    Nan::HandleScope scope;
+    to_json_buffer_baton_t *closure = static_cast<to_json_buffer_baton_t *>(req->data);
+    if (closure->error)
+    {
+        // LCOV_EXCL_START
+        v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+        // LCOV_EXCL_STOP
+    }
+    else
+    {
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), node_mapnik::pooled_buffer_to_v8(std::move(closure->result)) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+    }
+    closure->d->Unref();
+    closure->cb.Reset();
+    delete closure;
+}
+
+/**
+ * Get a JSON representation of this tile
+ *
+ * @memberof VectorTile
+ * @instance
+ * @name toJSON
+ * @param {Object} [options]
+ * @param {boolean} [options.decode_geometry=false] return geometry as integers
+ * relative to the tile grid
+ * @returns {Object} json representation of this tile with name, extent,
+ * version, and feature properties
+ * @example
+ * var vt = mapnik.VectorTile(10,131,242);
+ * var buffer = fs.readFileSync('./path/to/data.mvt');
+ * vt.setData(buffer);
+ * var json = vectorTile.toJSON();
+ * console.log(json); 
+ * // { 
+ * //   name: 'layer-name',
+ * //   extent: 4096, 
+ * //   version: 2,
+ * //   features: [ ... ] // array of objects
+ * // }
+ */
+NAN_METHOD(VectorTile::toJSON)
+{
+    bool decode_geometry = false;
+    bool to_buffer = false;
+    if (info.Length() >= 1 && !info[0]->IsFunction())
+    {
+        if (!info[0]->IsObject())
+        {
+            Nan::ThrowError("The first argument must be an object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[0]->ToObject();
+
+        if (options->Has(Nan::New("decode_geometry").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("decode_geometry").ToLocalChecked());
+            if (!param_val->IsBoolean())
+            {
+                Nan::ThrowError("option 'decode_geometry' must be a boolean");
+                return;
+            }
+            decode_geometry = param_val->BooleanValue();
+        }
+
+        if (options->Has(Nan::New("buffer").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("buffer").ToLocalChecked());
+            if (!param_val->IsBoolean())
+            {
+                Nan::ThrowError("option 'buffer' must be a boolean");
+                return;
+            }
+            to_buffer = param_val->BooleanValue();
+        }
+    }
+
+    VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
+
+    // buffer mode serializes natively into UTF-8 JSON text - one Buffer
+    // instead of per-feature V8 objects. Geometries stay in packed form
+    // and raster fields become base64 strings in this mode.
+    bool has_callback = info.Length() >= 1 && info[info.Length()-1]->IsFunction();
+    if (to_buffer || has_callback)
+    {
+        if (decode_geometry)
+        {
+            Nan::ThrowError("options 'buffer' and 'decode_geometry' cannot be combined");
+            return;
+        }
+        if (has_callback)
+        {
+            v8::Local<v8::Value> callback = info[info.Length()-1];
+            to_json_buffer_baton_t *closure = new to_json_buffer_baton_t();
+            closure->request.data = closure;
+            closure->d = d;
+            closure->error = false;
+            closure->cb.Reset(callback.As<v8::Function>());
+            uv_queue_work(uv_default_loop(), &closure->request, EIO_ToJSONBuffer, (uv_after_work_cb)EIO_AfterToJSONBuffer);
+            d->Ref();
+            return;
+        }
+        try
+        {
+            std::string result = node_mapnik::output_buffer_pool::instance().acquire();
+            _toJSONBuffer(d, result);
+            info.GetReturnValue().Set(node_mapnik::pooled_buffer_to_v8(std::move(result)));
+        }
+        catch (std::exception const& ex)
+        {
+            // LCOV_EXCL_START
+            Nan::ThrowError(ex.what());
+            // LCOV_EXCL_STOP
+        }
+        return;
+    }
+    try
+    {
+        protozero::pbf_reader tile_msg = d->tile_->get_reader();
+        v8::Local<v8::Array> arr = Nan::New<v8::Array>(d->tile_->get_layers().size());
+        std::size_t l_idx = 0;
+        while (tile_msg.next(mapnik::vector_tile_impl::Tile_Encoding::LAYERS))
+        {
+            protozero::pbf_reader layer_msg = tile_msg.get_message();
+            v8::Local<v8::Object> layer_obj = Nan::New<v8::Object>();
+            std::vector<std::string> layer_keys;
+            mapnik::vector_tile_impl::layer_pbf_attr_type layer_values;
+            std::vector<protozero::pbf_reader> layer_features;
             protozero::pbf_reader val_msg;
             std::uint32_t version = 1;
             while (layer_msg.next())
@@ -2718,8 +3980,9 @@ NAN_METHOD(VectorTile::toJSON)
     }
 }
 
+template <typename Sink>
 bool layer_to_geojson(protozero::pbf_reader const& layer,
-                      std::string & result,
+                      Sink & result,
                       unsigned x,
                       unsigned y,
                       unsigned z)
@@ -2793,7 +4056,8 @@ NAN_METHOD(VectorTile::toGeoJSONSync)
     info.GetReturnValue().Set(_toGeoJSONSync(info));
 }
 
-void write_geojson_array(std::string & result,
+template <typename Sink>
+void write_geojson_array(Sink & result,
                          VectorTile * v)
 {
     protozero::pbf_reader tile_msg = v->get_tile()->get_reader();
@@ -2819,22 +4083,52 @@ void write_geojson_array(std::string & result,
         }
         result += "{\"type\":\"FeatureCollection\",";
         result += "\"name\":\"" + layer_name + "\",\"features\":[";
-        std::string features;
-        bool hit = layer_to_geojson(layer_msg,
-                                    features,
-                                    v->get_tile()->x(),
-                                    v->get_tile()->y(),
-                                    v->get_tile()->z());
-        if (hit)
-        {
-            result += features;
-        }
+        layer_to_geojson(layer_msg,
+                         result,
+                         v->get_tile()->x(),
+                         v->get_tile()->y(),
+                         v->get_tile()->z());
         result += "]}";
     }
     result += "]";
 }
 
-void write_geojson_all(std::string & result,
+namespace detail
+{
+
+// forwards appends to the wrapped sink, emitting a prefix before the
+// first append only - lets write_geojson_all place the between-layer
+// comma without buffering a whole layer to find out whether it is empty
+template <typename Sink>
+struct prefixed_sink
+{
+    prefixed_sink(Sink & sink, const char * prefix) :
+        sink_(sink), prefix_(prefix), wrote_(false) {}
+
+    template <typename T>
+    prefixed_sink& operator+=(T const& value)
+    {
+        if (!wrote_)
+        {
+            wrote_ = true;
+            if (*prefix_)
+            {
+                sink_ += prefix_;
+            }
+        }
+        sink_ += value;
+        return *this;
+    }
+
+    Sink & sink_;
+    const char * prefix_;
+    bool wrote_;
+};
+
+} // end ns detail
+
+template <typename Sink>
+void write_geojson_all(Sink & result,
                        VectorTile * v)
 {
     protozero::pbf_reader tile_msg = v->get_tile()->get_reader();
@@ -2843,29 +4137,22 @@ void write_geojson_all(std::string & result,
     while (tile_msg.next(mapnik::vector_tile_impl::Tile_Encoding::LAYERS))
     {
         protozero::pbf_reader layer_msg(tile_msg.get_message());
-        std::string features;
+        detail::prefixed_sink<Sink> layer_sink(result, first ? "" : ",");
         bool hit = layer_to_geojson(layer_msg,
-                                    features,
+                                    layer_sink,
                                     v->get_tile()->x(),
                                     v->get_tile()->y(),
                                     v->get_tile()->z());
         if (hit)
         {
-            if (first)
-            {
-                first = false;
-            }
-            else 
-            {
-                result += ",";
-            }
-            result += features;
+            first = false;
         }
     }
     result += "]}";
 }
 
-bool write_geojson_layer_index(std::string & result,
+template <typename Sink>
+bool write_geojson_layer_index(Sink & result,
                                std::size_t layer_idx,
                                VectorTile * v)
 {
@@ -2889,7 +4176,8 @@ bool write_geojson_layer_index(std::string & result,
     // LCOV_EXCL_STOP
 }
 
-bool write_geojson_layer_name(std::string & result,
+template <typename Sink>
+bool write_geojson_layer_name(Sink & result,
                               std::string const& name,
                               VectorTile * v)
 {
@@ -3147,6 +4435,335 @@ void VectorTile::after_to_geojson(uv_work_t* req)
     delete closure;
 }
 
+struct geojson_stream_baton_t
+{
+    uv_work_t request;
+    uv_async_t async;
+    VectorTile* v;
+    bool error;
+    std::string error_name;
+    geojson_write_type type;
+    int layer_idx;
+    std::string layer_name;
+    std::size_t chunk_size;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::string chunk;
+    bool chunk_ready;
+    Nan::Persistent<v8::Function> cb;
+};
+
+namespace detail
+{
+
+// sink used by toGeoJSONStream: accumulates appended GeoJSON text up to
+// chunk_size bytes, then hands the chunk to the event loop through the
+// baton's uv_async handle and blocks until it has been consumed, keeping
+// peak memory at O(chunk) instead of O(tile)
+struct geojson_chunk_sink
+{
+    explicit geojson_chunk_sink(geojson_stream_baton_t & baton) :
+        baton_(baton),
+        buffer_()
+    {
+        buffer_.reserve(baton.chunk_size + 1024);
+    }
+
+    template <typename T>
+    geojson_chunk_sink& operator+=(T const& value)
+    {
+        buffer_ += value;
+        if (buffer_.size() >= baton_.chunk_size)
+        {
+            flush();
+        }
+        return *this;
+    }
+
+    void flush()
+    {
+        if (buffer_.empty())
+        {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(baton_.mutex);
+        baton_.cond.wait(lock, [this] { return !baton_.chunk_ready; });
+        baton_.chunk = std::move(buffer_);
+        buffer_.clear();
+        baton_.chunk_ready = true;
+        uv_async_send(&baton_.async);
+    }
+
+    geojson_stream_baton_t & baton_;
+    std::string buffer_;
+};
+
+// runs on the event loop whenever the worker has a chunk ready
+void geojson_stream_deliver(uv_async_t* handle)
+{
+    Nan::HandleScope scope;
+    geojson_stream_baton_t *closure = static_cast<geojson_stream_baton_t *>(handle->data);
+    std::string chunk;
+    {
+        std::unique_lock<std::mutex> lock(closure->mutex);
+        if (closure->chunk_ready)
+        {
+            chunk = std::move(closure->chunk);
+            closure->chunk.clear();
+            closure->chunk_ready = false;
+        }
+        closure->cond.notify_one();
+    }
+    if (!chunk.empty())
+    {
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), node_mapnik::pooled_buffer_to_v8(std::move(chunk)) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+    }
+}
+
+void geojson_stream_close(uv_handle_t* handle)
+{
+    geojson_stream_baton_t *closure = static_cast<geojson_stream_baton_t *>(handle->data);
+    delete closure;
+}
+
+} // end ns detail
+
+/**
+ * Stream a [GeoJSON](http://geojson.org/) representation of this tile in
+ * bounded chunks. The serialization runs on the thread pool and the
+ * callback fires on the event loop once per chunk with a Buffer, then a
+ * final time with `null` when the tile is done, so peak memory stays at
+ * the chunk size instead of the full GeoJSON text.
+ *
+ * @memberof VectorTile
+ * @instance
+ * @name toGeoJSONStream
+ * @param {string | number} layer Can be a zero-index integer representing
+ * a layer or the string keywords `__array__` or `__all__` to get all layers in the form
+ * of an array of GeoJSON `FeatureCollection`s or in the form of a single GeoJSON
+ * `FeatureCollection` with all layers smooshed inside
+ * @param {Object} [options]
+ * @param {number} [options.chunk_size=262144] approximate chunk size in bytes
+ * @param {Function} callback - `function(err, chunk)`: called repeatedly with
+ * Buffer chunks and finally with `chunk === null` once the stream ends
+ * @example
+ * var chunks = [];
+ * vectorTile.toGeoJSONStream('__all__', function(err, chunk) {
+ *   if (err) throw err;
+ *   if (chunk === null) {
+ *     var geojson = JSON.parse(Buffer.concat(chunks));
+ *     return;
+ *   }
+ *   chunks.push(chunk);
+ * });
+ */
+NAN_METHOD(VectorTile::toGeoJSONStream)
+{
+    if ((info.Length() < 2) || !info[info.Length()-1]->IsFunction())
+    {
+        Nan::ThrowError("expects a layer argument, optional options and a callback function");
+        return;
+    }
+    geojson_stream_baton_t *closure = new geojson_stream_baton_t();
+    closure->request.data = closure;
+    closure->v = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
+    closure->error = false;
+    closure->layer_idx = 0;
+    closure->type = geojson_write_all;
+    closure->chunk_size = 262144;
+    closure->chunk_ready = false;
+
+    v8::Local<v8::Value> layer_id = info[0];
+    if (! (layer_id->IsString() || layer_id->IsNumber()) )
+    {
+        delete closure;
+        Nan::ThrowTypeError("'layer' argument must be either a layer name (string) or layer index (integer)");
+        return;
+    }
+
+    if (layer_id->IsString())
+    {
+        std::string layer_name = TOSTR(layer_id);
+        if (layer_name == "__array__")
+        {
+            closure->type = geojson_write_array;
+        }
+        else if (layer_name == "__all__")
+        {
+            closure->type = geojson_write_all;
+        }
+        else
+        {
+            if (!closure->v->get_tile()->has_layer(layer_name))
+            {
+                delete closure;
+                std::string error_msg("The layer does not contain the name: " + layer_name);
+                Nan::ThrowTypeError(error_msg.c_str());
+                return;
+            }
+            closure->layer_name = layer_name;
+            closure->type = geojson_write_layer_name;
+        }
+    }
+    else if (layer_id->IsNumber())
+    {
+        closure->layer_idx = layer_id->IntegerValue();
+        if (closure->layer_idx < 0)
+        {
+            delete closure;
+            Nan::ThrowTypeError("A layer index can not be negative");
+            return;
+        }
+        else if (closure->layer_idx >= static_cast<int>(closure->v->get_tile()->get_layers().size()))
+        {
+            delete closure;
+            Nan::ThrowTypeError("Layer index exceeds the number of layers in the vector tile.");
+            return;
+        }
+        closure->type = geojson_write_layer_index;
+    }
+
+    if (info.Length() > 2)
+    {
+        if (!info[1]->IsObject())
+        {
+            delete closure;
+            Nan::ThrowTypeError("optional second argument must be an options object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[1]->ToObject();
+        if (options->Has(Nan::New("chunk_size").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("chunk_size").ToLocalChecked());
+            if (!param_val->IsNumber() || param_val->IntegerValue() < 1024)
+            {
+                delete closure;
+                Nan::ThrowTypeError("option 'chunk_size' must be a number of at least 1024 bytes");
+                return;
+            }
+            closure->chunk_size = static_cast<std::size_t>(param_val->IntegerValue());
+        }
+    }
+
+    v8::Local<v8::Value> callback = info[info.Length()-1];
+    closure->cb.Reset(callback.As<v8::Function>());
+    uv_async_init(uv_default_loop(), &closure->async, detail::geojson_stream_deliver);
+    closure->async.data = closure;
+    uv_queue_work(uv_default_loop(), &closure->request, to_geojson_stream, (uv_after_work_cb)after_to_geojson_stream);
+    closure->v->Ref();
+    return;
+}
+
+void VectorTile::to_geojson_stream(uv_work_t* req)
+{
+    geojson_stream_baton_t *closure = static_cast<geojson_stream_baton_t *>(req->data);
+    detail::geojson_chunk_sink sink(*closure);
+    try
+    {
+        switch (closure->type)
+        {
+            default:
+            case geojson_write_all:
+                write_geojson_all(sink, closure->v);
+                break;
+            case geojson_write_array:
+                write_geojson_array(sink, closure->v);
+                break;
+            case geojson_write_layer_name:
+                write_geojson_layer_name(sink, closure->layer_name, closure->v);
+                break;
+            case geojson_write_layer_index:
+                write_geojson_layer_index(sink, closure->layer_idx, closure->v);
+                break;
+        }
+        sink.flush();
+    }
+    catch (std::exception const& ex)
+    {
+        // LCOV_EXCL_START
+        closure->error = true;
+        closure->error_name = ex.what();
+        // LCOV_EXCL_STOP
+    }
+    // wait for the loop to consume the last chunk so the end-of-stream
+    // callback from after_to_geojson_stream always fires after every chunk
+    std::unique_lock<std::mutex> lock(closure->mutex);
+    closure->cond.wait(lock, [closure] { return !closure->chunk_ready; });
+}
+
+void VectorTile::after_to_geojson_stream(uv_work_t* req)
+{
+    Nan::HandleScope scope;
+    geojson_stream_baton_t *closure = static_cast<geojson_stream_baton_t *>(req->data);
+    if (closure->error)
+    {
+        // LCOV_EXCL_START
+        v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+        // LCOV_EXCL_STOP
+    }
+    else
+    {
+        // end of stream sentinel
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::Null() };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+    }
+    closure->v->Unref();
+    closure->cb.Reset();
+    uv_close(reinterpret_cast<uv_handle_t*>(&closure->async), detail::geojson_stream_close);
+}
+
+struct add_geojson_tile_baton_t
+{
+    uv_work_t request;
+    VectorTile* d;
+    std::string geojson;
+    std::string layer_name;
+    double area_threshold;
+    double simplify_distance;
+    bool strictly_simple;
+    bool multi_polygon_union;
+    mapnik::vector_tile_impl::polygon_fill_type fill_type;
+    bool process_all_rings;
+    bool error;
+    std::string error_name;
+    Nan::Persistent<v8::Function> cb;
+};
+
+// parses the GeoJSON through the geojson datasource plugin and runs the
+// full clip/simplify/encode processor into the tile; shared by the sync
+// and thread-pool paths of addGeoJSON
+void VectorTile::_addGeoJSON(VectorTile* d,
+                             std::string const& geojson_string,
+                             std::string const& geojson_name,
+                             double area_threshold,
+                             double simplify_distance,
+                             bool strictly_simple,
+                             bool multi_polygon_union,
+                             mapnik::vector_tile_impl::polygon_fill_type fill_type,
+                             bool process_all_rings)
+{
+    // create map object
+    mapnik::Map map(d->tile_size(),d->tile_size(),"+init=epsg:3857");
+    node_mapnik::ensure_plugins_registered("geojson");
+    mapnik::parameters p;
+    p["type"]="geojson";
+    p["inline"]=geojson_string;
+    mapnik::layer lyr(geojson_name,"+init=epsg:4326");
+    lyr.set_datasource(mapnik::datasource_cache::instance().create(p));
+    map.add_layer(lyr);
+
+    mapnik::vector_tile_impl::processor ren(map);
+    ren.set_area_threshold(area_threshold);
+    ren.set_strictly_simple(strictly_simple);
+    ren.set_simplify_distance(simplify_distance);
+    ren.set_multi_polygon_union(multi_polygon_union);
+    ren.set_fill_type(fill_type);
+    ren.set_process_all_rings(process_all_rings);
+    ren.update_tile(*d->get_tile());
+}
+
 /**
  * Add features to this tile from a GeoJSON string
  *
@@ -3181,9 +4798,9 @@ void VectorTile::after_to_geojson(uv_work_t* req)
 NAN_METHOD(VectorTile::addGeoJSON)
 {
     VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
-    if (info.Length() < 1 || !info[0]->IsString())
+    if (info.Length() < 1 || !(info[0]->IsString() || node::Buffer::HasInstance(info[0])))
     {
-        Nan::ThrowError("first argument must be a GeoJSON string");
+        Nan::ThrowError("first argument must be a GeoJSON string or Buffer");
         return;
     }
     if (info.Length() < 2 || !info[1]->IsString())
@@ -3191,7 +4808,16 @@ NAN_METHOD(VectorTile::addGeoJSON)
         Nan::ThrowError("second argument must be a layer name (string)");
         return;
     }
-    std::string geojson_string = TOSTR(info[0]);
+    std::string geojson_string;
+    if (node::Buffer::HasInstance(info[0]))
+    {
+        v8::Local<v8::Object> obj = info[0].As<v8::Object>();
+        geojson_string.assign(node::Buffer::Data(obj), node::Buffer::Length(obj));
+    }
+    else
+    {
+        geojson_string = TOSTR(info[0]);
+    }
     std::string geojson_name = TOSTR(info[1]);
 
     v8::Local<v8::Object> options = Nan::New<v8::Object>();
@@ -3289,25 +4915,36 @@ NAN_METHOD(VectorTile::addGeoJSON)
         }
     }
 
+    // async form: parse, clip and encode on the thread pool instead of
+    // stalling the event loop for large collections
+    if (info[info.Length()-1]->IsFunction())
+    {
+        v8::Local<v8::Value> callback = info[info.Length()-1];
+        add_geojson_tile_baton_t *closure = new add_geojson_tile_baton_t();
+        closure->request.data = closure;
+        closure->d = d;
+        closure->geojson = std::move(geojson_string);
+        closure->layer_name = std::move(geojson_name);
+        closure->area_threshold = area_threshold;
+        closure->simplify_distance = simplify_distance;
+        closure->strictly_simple = strictly_simple;
+        closure->multi_polygon_union = multi_polygon_union;
+        closure->fill_type = fill_type;
+        closure->process_all_rings = process_all_rings;
+        closure->error = false;
+        closure->cb.Reset(callback.As<v8::Function>());
+        d->detach_tile();
+        uv_queue_work(uv_default_loop(), &closure->request, EIO_AddGeoJSON, (uv_after_work_cb)EIO_AfterAddGeoJSON);
+        d->Ref();
+        return;
+    }
+
     try
     {
-        // create map object
-        mapnik::Map map(d->tile_size(),d->tile_size(),"+init=epsg:3857");
-        mapnik::parameters p;
-        p["type"]="geojson";
-        p["inline"]=geojson_string;
-        mapnik::layer lyr(geojson_name,"+init=epsg:4326");
-        lyr.set_datasource(mapnik::datasource_cache::instance().create(p));
-        map.add_layer(lyr);
-        
-        mapnik::vector_tile_impl::processor ren(map);
-        ren.set_area_threshold(area_threshold);
-        ren.set_strictly_simple(strictly_simple);
-        ren.set_simplify_distance(simplify_distance);
-        ren.set_multi_polygon_union(multi_polygon_union);
-        ren.set_fill_type(fill_type);
-        ren.set_process_all_rings(process_all_rings);
-        ren.update_tile(*d->get_tile());
+        d->detach_tile();
+        _addGeoJSON(d, geojson_string, geojson_name, area_threshold, simplify_distance,
+                    strictly_simple, multi_polygon_union, fill_type, process_all_rings);
+        d->invalidate_query_index();
         info.GetReturnValue().Set(Nan::True());
     }
     catch (std::exception const& ex)
@@ -3317,26 +4954,63 @@ NAN_METHOD(VectorTile::addGeoJSON)
     }
 }
 
-/**
- * Add a {@link Image} as a tile layer (synchronous)
- *
- * @memberof VectorTile
- * @instance
- * @name addImageSync
- * @param {mapnik.Image} image
- * @param {string} name of the layer to be added
- * @param {Object} options
- * @param {string} [options.image_scaling=bilinear] can be any 
- * of the <mapnik.imageScaling> methods
- * @param {string} [options.image_format=webp] or `jpeg`, `png`, `tiff`
- * @example
- * var vt = new mapnik.VectorTile(1, 0, 0, {
- *   tile_size:256
- * });
- * var im = new mapnik.Image(256, 256);
- * vt.addImageSync(im, 'layer-name', {
- *   image_format: 'jpeg',
- *   image_scaling: 'gaussian'
+void VectorTile::EIO_AddGeoJSON(uv_work_t* req)
+{
+    add_geojson_tile_baton_t *closure = static_cast<add_geojson_tile_baton_t *>(req->data);
+    try
+    {
+        _addGeoJSON(closure->d, closure->geojson, closure->layer_name,
+                    closure->area_threshold, closure->simplify_distance,
+                    closure->strictly_simple, closure->multi_polygon_union,
+                    closure->fill_type, closure->process_all_rings);
+    }
+    catch (std::exception const& ex)
+    {
+        closure->error = true;
+        closure->error_name = ex.what();
+    }
+}
+
+void VectorTile::EIO_AfterAddGeoJSON(uv_work_t* req)
+{
+    Nan::HandleScope scope;
+    add_geojson_tile_baton_t *closure = static_cast<add_geojson_tile_baton_t *>(req->data);
+    if (closure->error)
+    {
+        v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+    }
+    else
+    {
+        closure->d->invalidate_query_index();
+        v8::Local<v8::Value> argv[1] = { Nan::Null() };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+    }
+    closure->d->Unref();
+    closure->cb.Reset();
+    delete closure;
+}
+
+/**
+ * Add a {@link Image} as a tile layer (synchronous)
+ *
+ * @memberof VectorTile
+ * @instance
+ * @name addImageSync
+ * @param {mapnik.Image} image
+ * @param {string} name of the layer to be added
+ * @param {Object} options
+ * @param {string} [options.image_scaling=bilinear] can be any 
+ * of the <mapnik.imageScaling> methods
+ * @param {string} [options.image_format=webp] or `jpeg`, `png`, `tiff`
+ * @example
+ * var vt = new mapnik.VectorTile(1, 0, 0, {
+ *   tile_size:256
+ * });
+ * var im = new mapnik.Image(256, 256);
+ * vt.addImageSync(im, 'layer-name', {
+ *   image_format: 'jpeg',
+ *   image_scaling: 'gaussian'
  * });
  */
 NAN_METHOD(VectorTile::addImageSync)
@@ -3427,6 +5101,7 @@ v8::Local<v8::Value> VectorTile::_addImageSync(Nan::NAN_METHOD_ARGS_TYPE info)
     ds->set_envelope(d->get_tile()->extent());
     try
     {
+        d->detach_tile();
         // create map object
         mapnik::Map map(d->tile_size(),d->tile_size(),"+init=epsg:3857");
         mapnik::layer lyr(layer_name,"+init=epsg:3857");
@@ -3437,6 +5112,7 @@ v8::Local<v8::Value> VectorTile::_addImageSync(Nan::NAN_METHOD_ARGS_TYPE info)
         ren.set_scaling_method(scaling_method);
         ren.set_image_format(image_format);
         ren.update_tile(*d->get_tile());
+        d->invalidate_query_index();
         info.GetReturnValue().Set(Nan::True());
     }
     catch (std::exception const& ex)
@@ -3577,6 +5253,7 @@ NAN_METHOD(VectorTile::addImage)
     closure->layer_name = layer_name;
     closure->error = false;
     closure->cb.Reset(callback.As<v8::Function>());
+    d->detach_tile();
     uv_queue_work(uv_default_loop(), &closure->request, EIO_AddImage, (uv_after_work_cb)EIO_AfterAddImage);
     d->Ref();
     im->_ref();
@@ -3627,6 +5304,7 @@ void VectorTile::EIO_AfterAddImage(uv_work_t* req)
     }
     else
     {
+        closure->d->invalidate_query_index();
         v8::Local<v8::Value> argv[1] = { Nan::Null() };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
     }
@@ -3686,7 +5364,9 @@ v8::Local<v8::Value> VectorTile::_addImageBufferSync(Nan::NAN_METHOD_ARGS_TYPE i
     }
     try
     {
+        d->detach_tile();
         add_image_buffer_as_tile_layer(*d->get_tile(), layer_name, node::Buffer::Data(obj), buffer_size); 
+        d->invalidate_query_index();
     }
     catch (std::exception const& ex)
     {
@@ -3778,6 +5458,7 @@ NAN_METHOD(VectorTile::addImageBuffer)
     closure->buffer.Reset(obj.As<v8::Object>());
     closure->data = node::Buffer::Data(obj);
     closure->dataLength = node::Buffer::Length(obj);
+    d->detach_tile();
     uv_queue_work(uv_default_loop(), &closure->request, EIO_AddImageBuffer, (uv_after_work_cb)EIO_AfterAddImageBuffer);
     d->Ref();
     return;
@@ -3813,6 +5494,7 @@ void VectorTile::EIO_AfterAddImageBuffer(uv_work_t* req)
     }
     else
     {
+        closure->d->invalidate_query_index();
         v8::Local<v8::Value> argv[1] = { Nan::Null() };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
     }
@@ -3823,6 +5505,76 @@ void VectorTile::EIO_AfterAddImageBuffer(uv_work_t* req)
     delete closure;
 }
 
+namespace {
+
+// Inflates compressed tile buffers through the pooled inflate contexts
+// before handing them to merge_from_compressed_buffer, which then sees
+// uncompressed data and skips its own per-call z_stream setup.
+// Uncompressed input passes straight through.
+// keeps only the named layers of an uncompressed tile buffer, copying
+// their raw layer messages so everything else is never even validated
+std::string filter_layers_buffer(const char * data,
+                                 std::size_t size,
+                                 std::vector<std::string> const& wanted)
+{
+    std::string filtered;
+    protozero::pbf_writer writer(filtered);
+    protozero::pbf_reader tile_msg(data, size);
+    while (tile_msg.next(mapnik::vector_tile_impl::Tile_Encoding::LAYERS))
+    {
+        auto data_pair = tile_msg.get_data();
+        protozero::pbf_reader name_msg(data_pair);
+        if (!name_msg.next(mapnik::vector_tile_impl::Layer_Encoding::NAME))
+        {
+            continue;
+        }
+        std::string name = name_msg.get_string();
+        if (std::find(wanted.begin(), wanted.end(), name) != wanted.end())
+        {
+            writer.add_message(mapnik::vector_tile_impl::Tile_Encoding::LAYERS,
+                               data_pair.first, data_pair.second);
+        }
+    }
+    return filtered;
+}
+
+void merge_buffer_pooled(mapnik::vector_tile_impl::merc_tile & tile,
+                         const char * data,
+                         std::size_t size,
+                         bool validate,
+                         bool upgrade,
+                         std::vector<std::string> const& layer_filter = std::vector<std::string>())
+{
+    if (size >= 2 &&
+        (mapnik::vector_tile_impl::is_gzip_compressed(data, size) ||
+         mapnik::vector_tile_impl::is_zlib_compressed(data, size)))
+    {
+        std::unique_ptr<node_mapnik::inflate_context> ctx =
+            node_mapnik::inflate_context_pool::instance().acquire();
+        std::string const& uncompressed = ctx->decompress(data, size);
+        if (!layer_filter.empty())
+        {
+            std::string filtered = filter_layers_buffer(uncompressed.data(), uncompressed.size(), layer_filter);
+            merge_from_compressed_buffer(tile, filtered.data(), filtered.size(), validate, upgrade);
+        }
+        else
+        {
+            merge_from_compressed_buffer(tile, uncompressed.data(), uncompressed.size(), validate, upgrade);
+        }
+        node_mapnik::inflate_context_pool::instance().release(std::move(ctx));
+        return;
+    }
+    if (!layer_filter.empty())
+    {
+        std::string filtered = filter_layers_buffer(data, size, layer_filter);
+        merge_from_compressed_buffer(tile, filtered.data(), filtered.size(), validate, upgrade);
+        return;
+    }
+    merge_from_compressed_buffer(tile, data, size, validate, upgrade);
+}
+
+} // anonymous namespace
+
 /**
  * Add raw data to this tile as a Buffer
  *
@@ -3868,6 +5620,7 @@ v8::Local<v8::Value> VectorTile::_addDataSync(Nan::NAN_METHOD_ARGS_TYPE info)
     }
     bool upgrade = false;
     bool validate = false;
+    std::vector<std::string> layer_filter;
     v8::Local<v8::Object> options = Nan::New<v8::Object>();
     if (info.Length() > 1)
     {
@@ -3897,10 +5650,32 @@ v8::Local<v8::Value> VectorTile::_addDataSync(Nan::NAN_METHOD_ARGS_TYPE info)
             }
             upgrade = param_val->BooleanValue();
         }
+        if (options->Has(Nan::New<v8::String>("layers").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("layers").ToLocalChecked());
+            if (!param_val->IsArray())
+            {
+                Nan::ThrowTypeError("option 'layers' must be an array of layer names");
+                return scope.Escape(Nan::Undefined());
+            }
+            v8::Local<v8::Array> arr = param_val.As<v8::Array>();
+            for (unsigned i = 0; i < arr->Length(); ++i)
+            {
+                v8::Local<v8::Value> name = arr->Get(i);
+                if (!name->IsString())
+                {
+                    Nan::ThrowTypeError("option 'layers' must be an array of layer names");
+                    return scope.Escape(Nan::Undefined());
+                }
+                layer_filter.push_back(TOSTR(name));
+            }
+        }
     }
     try
     {
-        merge_from_compressed_buffer(*d->get_tile(), node::Buffer::Data(obj), buffer_size, validate, upgrade);
+        d->detach_tile();
+        merge_buffer_pooled(*d->get_tile(), node::Buffer::Data(obj), buffer_size, validate, upgrade, layer_filter);
+        d->invalidate_query_index();
     }
     catch (std::exception const& ex)
     {
@@ -3917,6 +5692,8 @@ typedef struct
     const char *data;
     bool validate;
     bool upgrade;
+    std::vector<std::string> layer_filter;
+    node_mapnik::async_trace trace;
     size_t dataLength;
     bool error;
     std::string error_name;
@@ -3969,6 +5746,7 @@ NAN_METHOD(VectorTile::addData)
 
     bool upgrade = false;
     bool validate = false;
+    std::vector<std::string> layer_filter;
     v8::Local<v8::Object> options = Nan::New<v8::Object>();
     if (info.Length() > 1)
     {
@@ -3998,6 +5776,26 @@ NAN_METHOD(VectorTile::addData)
             }
             upgrade = param_val->BooleanValue();
         }
+        if (options->Has(Nan::New<v8::String>("layers").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("layers").ToLocalChecked());
+            if (!param_val->IsArray())
+            {
+                Nan::ThrowTypeError("option 'layers' must be an array of layer names");
+                return;
+            }
+            v8::Local<v8::Array> arr = param_val.As<v8::Array>();
+            for (unsigned i = 0; i < arr->Length(); ++i)
+            {
+                v8::Local<v8::Value> name = arr->Get(i);
+                if (!name->IsString())
+                {
+                    Nan::ThrowTypeError("option 'layers' must be an array of layer names");
+                    return;
+                }
+                layer_filter.push_back(TOSTR(name));
+            }
+        }
     }
 
     VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
@@ -4007,11 +5805,13 @@ NAN_METHOD(VectorTile::addData)
     closure->d = d;
     closure->validate = validate;
     closure->upgrade = upgrade;
+    closure->layer_filter = std::move(layer_filter);
     closure->error = false;
     closure->cb.Reset(callback.As<v8::Function>());
     closure->buffer.Reset(obj.As<v8::Object>());
     closure->data = node::Buffer::Data(obj);
     closure->dataLength = node::Buffer::Length(obj);
+    d->detach_tile();
     uv_queue_work(uv_default_loop(), &closure->request, EIO_AddData, (uv_after_work_cb)EIO_AfterAddData);
     d->Ref();
     return;
@@ -4020,6 +5820,7 @@ NAN_METHOD(VectorTile::addData)
 void VectorTile::EIO_AddData(uv_work_t* req)
 {
     vector_tile_adddata_baton_t *closure = static_cast<vector_tile_adddata_baton_t *>(req->data);
+    node_mapnik::trace_scope tracing(closure->trace, "vtile.adddata");
 
     if (closure->dataLength <= 0)
     {
@@ -4029,7 +5830,7 @@ void VectorTile::EIO_AddData(uv_work_t* req)
     }
     try
     {
-        merge_from_compressed_buffer(*closure->d->get_tile(), closure->data, closure->dataLength, closure->validate, closure->upgrade);
+        merge_buffer_pooled(*closure->d->get_tile(), closure->data, closure->dataLength, closure->validate, closure->upgrade, closure->layer_filter);
     }
     catch (std::exception const& ex)
     {
@@ -4049,6 +5850,7 @@ void VectorTile::EIO_AfterAddData(uv_work_t* req)
     }
     else
     {
+        closure->d->invalidate_query_index();
         v8::Local<v8::Value> argv[1] = { Nan::Null() };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
     }
@@ -4104,6 +5906,7 @@ v8::Local<v8::Value> VectorTile::_setDataSync(Nan::NAN_METHOD_ARGS_TYPE info)
     }
     bool upgrade = false;
     bool validate = false;
+    std::vector<std::string> layer_filter;
     v8::Local<v8::Object> options = Nan::New<v8::Object>();
     if (info.Length() > 1)
     {
@@ -4133,11 +5936,32 @@ v8::Local<v8::Value> VectorTile::_setDataSync(Nan::NAN_METHOD_ARGS_TYPE info)
             }
             upgrade = param_val->BooleanValue();
         }
+        if (options->Has(Nan::New<v8::String>("layers").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("layers").ToLocalChecked());
+            if (!param_val->IsArray())
+            {
+                Nan::ThrowTypeError("option 'layers' must be an array of layer names");
+                return scope.Escape(Nan::Undefined());
+            }
+            v8::Local<v8::Array> arr = param_val.As<v8::Array>();
+            for (unsigned i = 0; i < arr->Length(); ++i)
+            {
+                v8::Local<v8::Value> name = arr->Get(i);
+                if (!name->IsString())
+                {
+                    Nan::ThrowTypeError("option 'layers' must be an array of layer names");
+                    return scope.Escape(Nan::Undefined());
+                }
+                layer_filter.push_back(TOSTR(name));
+            }
+        }
     }
     try
     {
         d->clear();
-        merge_from_compressed_buffer(*d->get_tile(), node::Buffer::Data(obj), buffer_size, validate, upgrade);
+        merge_buffer_pooled(*d->get_tile(), node::Buffer::Data(obj), buffer_size, validate, upgrade, layer_filter);
+        d->invalidate_query_index();
     }
     catch (std::exception const& ex)
     {
@@ -4154,6 +5978,8 @@ typedef struct
     const char *data;
     bool validate;
     bool upgrade;
+    std::vector<std::string> layer_filter;
+    node_mapnik::async_trace trace;
     size_t dataLength;
     bool error;
     std::string error_name;
@@ -4205,6 +6031,7 @@ NAN_METHOD(VectorTile::setData)
 
     bool upgrade = false;
     bool validate = false;
+    std::vector<std::string> layer_filter;
     v8::Local<v8::Object> options = Nan::New<v8::Object>();
     if (info.Length() > 1)
     {
@@ -4234,6 +6061,26 @@ NAN_METHOD(VectorTile::setData)
             }
             upgrade = param_val->BooleanValue();
         }
+        if (options->Has(Nan::New<v8::String>("layers").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("layers").ToLocalChecked());
+            if (!param_val->IsArray())
+            {
+                Nan::ThrowTypeError("option 'layers' must be an array of layer names");
+                return;
+            }
+            v8::Local<v8::Array> arr = param_val.As<v8::Array>();
+            for (unsigned i = 0; i < arr->Length(); ++i)
+            {
+                v8::Local<v8::Value> name = arr->Get(i);
+                if (!name->IsString())
+                {
+                    Nan::ThrowTypeError("option 'layers' must be an array of layer names");
+                    return;
+                }
+                layer_filter.push_back(TOSTR(name));
+            }
+        }
     }
 
     VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
@@ -4242,12 +6089,14 @@ NAN_METHOD(VectorTile::setData)
     closure->request.data = closure;
     closure->validate = validate;
     closure->upgrade = upgrade;
+    closure->layer_filter = std::move(layer_filter);
     closure->d = d;
     closure->error = false;
     closure->cb.Reset(callback.As<v8::Function>());
     closure->buffer.Reset(obj.As<v8::Object>());
     closure->data = node::Buffer::Data(obj);
     closure->dataLength = node::Buffer::Length(obj);
+    d->detach_tile();
     uv_queue_work(uv_default_loop(), &closure->request, EIO_SetData, (uv_after_work_cb)EIO_AfterSetData);
     d->Ref();
     return;
@@ -4256,6 +6105,7 @@ NAN_METHOD(VectorTile::setData)
 void VectorTile::EIO_SetData(uv_work_t* req)
 {
     vector_tile_setdata_baton_t *closure = static_cast<vector_tile_setdata_baton_t *>(req->data);
+    node_mapnik::trace_scope tracing(closure->trace, "vtile.setdata");
     
     if (closure->dataLength <= 0)
     {
@@ -4267,7 +6117,7 @@ void VectorTile::EIO_SetData(uv_work_t* req)
     try
     {
         closure->d->clear();
-        merge_from_compressed_buffer(*closure->d->get_tile(), closure->data, closure->dataLength, closure->validate, closure->upgrade);
+        merge_buffer_pooled(*closure->d->get_tile(), closure->data, closure->dataLength, closure->validate, closure->upgrade, closure->layer_filter);
     }
     catch (std::exception const& ex)
     {
@@ -4287,6 +6137,7 @@ void VectorTile::EIO_AfterSetData(uv_work_t* req)
     }
     else
     {
+        closure->d->invalidate_query_index();
         v8::Local<v8::Value> argv[1] = { Nan::Null() };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
     }
@@ -4305,6 +6156,9 @@ void VectorTile::EIO_AfterSetData(uv_work_t* req)
  * @name getDataSync
  * @param {Object} [options]
  * @param {string} [options.compression=none] - can also be `gzip`
+ * @param {boolean} [options.alias=false] - if true the returned buffer aliases
+ * the tile's internal storage instead of copying it; see `getData` for the
+ * validity rules. Cannot be combined with compression.
  * @param {int} [options.level=0] a number `0` (no compression) to `9` (best compression)
  * @param {string} options.strategy must be `FILTERED`, `HUFFMAN_ONLY`, `RLE`, `FIXED`, `DEFAULT`
  * @returns {Buffer} raw data
@@ -4320,12 +6174,26 @@ NAN_METHOD(VectorTile::getDataSync)
     info.GetReturnValue().Set(_getDataSync(info));
 }
 
+namespace detail
+{
+
+// free callback for buffers handed out by getData({alias: true}); the
+// hint keeps the underlying tile storage alive until v8 collects the
+// buffer, see the getData docs for the aliasing rules
+void release_aliased_tile(char*, void* hint)
+{
+    delete static_cast<mapnik::vector_tile_impl::merc_tile_ptr*>(hint);
+}
+
+} // end ns detail
+
 v8::Local<v8::Value> VectorTile::_getDataSync(Nan::NAN_METHOD_ARGS_TYPE info)
 {
     Nan::EscapableHandleScope scope;
     VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
 
     bool compress = false;
+    bool alias = false;
     int level = Z_DEFAULT_COMPRESSION;
     int strategy = Z_DEFAULT_STRATEGY;
 
@@ -4352,6 +6220,17 @@ v8::Local<v8::Value> VectorTile::_getDataSync(Nan::NAN_METHOD_ARGS_TYPE info)
             compress = std::string("gzip") == (TOSTR(param_val->ToString()));
         }
 
+        if (options->Has(Nan::New<v8::String>("alias").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("alias").ToLocalChecked());
+            if (!param_val->IsBoolean())
+            {
+                Nan::ThrowTypeError("option 'alias' must be a boolean");
+                return scope.Escape(Nan::Undefined());
+            }
+            alias = param_val->BooleanValue();
+        }
+
         if (options->Has(Nan::New<v8::String>("level").ToLocalChecked()))
         {
             v8::Local<v8::Value> param_val = options->Get(Nan::New("level").ToLocalChecked());
@@ -4403,6 +6282,12 @@ v8::Local<v8::Value> VectorTile::_getDataSync(Nan::NAN_METHOD_ARGS_TYPE info)
         }
     }
 
+    if (alias && compress)
+    {
+        Nan::ThrowTypeError("option 'alias' cannot be combined with gzip compression");
+        return scope.Escape(Nan::Undefined());
+    }
+
     try
     {
         std::size_t raw_size = d->tile_->size();
@@ -4425,13 +6310,27 @@ v8::Local<v8::Value> VectorTile::_getDataSync(Nan::NAN_METHOD_ARGS_TYPE info)
             }
             if (!compress)
             {
+                if (alias)
+                {
+                    // zero-copy: the buffer aliases the tile's internal
+                    // storage; mutations detach the tile onto fresh
+                    // storage so this stays a valid snapshot
+                    auto * tile_ref = new mapnik::vector_tile_impl::merc_tile_ptr(d->get_tile());
+                    return scope.Escape(Nan::NewBuffer((char*)d->tile_->data(),
+                                                       raw_size,
+                                                       detail::release_aliased_tile,
+                                                       tile_ref).ToLocalChecked());
+                }
                 return scope.Escape(Nan::CopyBuffer((char*)d->tile_->data(),raw_size).ToLocalChecked());
             }
             else
             {
-                std::string compressed;
-                mapnik::vector_tile_impl::zlib_compress(d->tile_->data(), raw_size, compressed, true, level, strategy);
-                return scope.Escape(Nan::CopyBuffer((char*)compressed.data(),compressed.size()).ToLocalChecked());
+                std::string compressed = node_mapnik::output_buffer_pool::instance().acquire();
+                std::unique_ptr<node_mapnik::deflate_context> ctx =
+                    node_mapnik::deflate_context_pool::instance().acquire();
+                ctx->compress(d->tile_->data(), raw_size, compressed, level, strategy);
+                node_mapnik::deflate_context_pool::instance().release(std::move(ctx));
+                return scope.Escape(node_mapnik::pooled_buffer_to_v8(std::move(compressed)));
             }
         }
     }
@@ -4455,8 +6354,10 @@ typedef struct
     bool error;
     std::string data;
     bool compress;
+    bool alias;
     int level;
     int strategy;
+    node_mapnik::async_trace trace;
     std::string error_name;
     Nan::Persistent<v8::Function> cb;
 } vector_tile_get_data_baton_t;
@@ -4468,6 +6369,11 @@ typedef struct
  * @name getData
  * @param {Object} [options]
  * @param {string} [options.compression=none] compression type can also be `gzip`
+ * @param {boolean} [options.alias=false] - if true the returned buffer aliases
+ * the tile's internal storage instead of copying it. Much cheaper for large
+ * tiles. Mutating the tile afterwards detaches it onto fresh storage, so
+ * the buffer keeps the bytes as of when it was created; writing to the
+ * buffer corrupts those bytes. Cannot be combined with compression.
  * @param {int} [options.level=0] a number `0` (no compression) to `9` (best compression)
  * @param {string} options.strategy must be `FILTERED`, `HUFFMAN_ONLY`, `RLE`, `FIXED`, `DEFAULT`
  * @param {Function} callback
@@ -4491,6 +6397,7 @@ NAN_METHOD(VectorTile::getData)
 
     v8::Local<v8::Value> callback = info[info.Length()-1];
     bool compress = false;
+    bool alias = false;
     int level = Z_DEFAULT_COMPRESSION;
     int strategy = Z_DEFAULT_STRATEGY;
 
@@ -4517,6 +6424,17 @@ NAN_METHOD(VectorTile::getData)
             compress = std::string("gzip") == (TOSTR(param_val->ToString()));
         }
 
+        if (options->Has(Nan::New("alias").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("alias").ToLocalChecked());
+            if (!param_val->IsBoolean())
+            {
+                Nan::ThrowTypeError("option 'alias' must be a boolean");
+                return;
+            }
+            alias = param_val->BooleanValue();
+        }
+
         if (options->Has(Nan::New("level").ToLocalChecked()))
         {
             v8::Local<v8::Value> param_val = options->Get(Nan::New("level").ToLocalChecked());
@@ -4568,11 +6486,18 @@ NAN_METHOD(VectorTile::getData)
         }
     }
 
+    if (alias && compress)
+    {
+        Nan::ThrowTypeError("option 'alias' cannot be combined with gzip compression");
+        return;
+    }
+
     VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
     vector_tile_get_data_baton_t *closure = new vector_tile_get_data_baton_t();
     closure->request.data = closure;
     closure->d = d;
     closure->compress = compress;
+    closure->alias = alias;
     closure->level = level;
     closure->strategy = strategy;
     closure->error = false;
@@ -4585,12 +6510,17 @@ NAN_METHOD(VectorTile::getData)
 void VectorTile::get_data(uv_work_t* req)
 {
     vector_tile_get_data_baton_t *closure = static_cast<vector_tile_get_data_baton_t *>(req->data);
+    node_mapnik::trace_scope tracing(closure->trace, "vtile.getdata");
     try
     {
-        // compress if requested
+        // compress if requested, always here on the thread pool and with
+        // a pooled deflate context so repeated calls reuse z_stream state
         if (closure->compress)
         {
-            mapnik::vector_tile_impl::zlib_compress(closure->d->tile_->data(), closure->d->tile_->size(), closure->data, true, closure->level, closure->strategy);
+            std::unique_ptr<node_mapnik::deflate_context> ctx =
+                node_mapnik::deflate_context_pool::instance().acquire();
+            ctx->compress(closure->d->tile_->data(), closure->d->tile_->size(), closure->data, closure->level, closure->strategy);
+            node_mapnik::deflate_context_pool::instance().release(std::move(ctx));
         }
     }
     catch (std::exception const& ex)
@@ -4621,7 +6551,7 @@ void VectorTile::after_get_data(uv_work_t* req)
     }
     else if (!closure->data.empty())
     {
-        v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::CopyBuffer((char*)closure->data.data(),closure->data.size()).ToLocalChecked() };
+        v8::Local<v8::Value> argv[2] = { Nan::Null(), node_mapnik::pooled_buffer_to_v8(std::move(closure->data)) };
         Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
     }
     else
@@ -4644,6 +6574,17 @@ void VectorTile::after_get_data(uv_work_t* req)
             Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
             // LCOV_EXCL_STOP
         }
+        else if (closure->alias)
+        {
+            // zero-copy: aliases the tile's storage; mutations detach
+            // the tile onto fresh storage so this stays a valid snapshot
+            auto * tile_ref = new mapnik::vector_tile_impl::merc_tile_ptr(closure->d->get_tile());
+            v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::NewBuffer((char*)closure->d->tile_->data(),
+                                                                         raw_size,
+                                                                         detail::release_aliased_tile,
+                                                                         tile_ref).ToLocalChecked() };
+            Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+        }
         else
         {
             v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::CopyBuffer((char*)closure->d->tile_->data(),raw_size).ToLocalChecked() };
@@ -4701,6 +6642,10 @@ struct vector_tile_render_baton_t
     double scale_denominator;
     bool use_cairo;
     bool zxy_override;
+    node_mapnik::async_trace trace;
+    bool collect_stats;
+    double render_ms;
+    std::vector<std::pair<std::string, double> > layer_stats;
     bool error;
     vector_tile_render_baton_t() :
         request(),
@@ -4721,6 +6666,9 @@ struct vector_tile_render_baton_t
         scale_factor(1.0),
         scale_denominator(0.0),
         use_cairo(true),
+        collect_stats(false),
+        render_ms(0.0),
+        layer_stats(),
         zxy_override(false),
         error(false)
         {}
@@ -4826,6 +6774,7 @@ NAN_METHOD(VectorTile::render)
 
     vector_tile_render_baton_t *closure = new vector_tile_render_baton_t();
     baton_guard guard(closure);
+    node_mapnik::job_scheduler::priority job_priority = node_mapnik::job_scheduler::priority_normal;
     v8::Local<v8::Object> options = Nan::New<v8::Object>();
 
     if (info.Length() > 2)
@@ -4941,6 +6890,26 @@ NAN_METHOD(VectorTile::render)
             }
             object_to_container(closure->variables,bind_opt->ToObject());
         }
+        if (options->Has(Nan::New("stats").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> bind_opt = options->Get(Nan::New("stats").ToLocalChecked());
+            if (!bind_opt->IsBoolean())
+            {
+                Nan::ThrowTypeError("optional arg 'stats' must be a boolean");
+                return;
+            }
+            closure->collect_stats = bind_opt->BooleanValue();
+        }
+        if (options->Has(Nan::New("priority").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> bind_opt = options->Get(Nan::New("priority").ToLocalChecked());
+            if (!bind_opt->IsString() ||
+                !node_mapnik::job_scheduler::priority_from_string(TOSTR(bind_opt), job_priority))
+            {
+                Nan::ThrowTypeError("optional arg 'priority' must be 'low', 'normal' or 'high'");
+                return;
+            }
+        }
     }
 
     closure->layer_idx = 0;
@@ -5087,7 +7056,7 @@ NAN_METHOD(VectorTile::render)
     closure->m = m;
     closure->error = false;
     closure->cb.Reset(callback.As<v8::Function>());
-    uv_queue_work(uv_default_loop(), &closure->request, EIO_RenderTile, (uv_after_work_cb)EIO_AfterRenderTile);
+    node_mapnik::job_scheduler::instance().queue(&closure->request, EIO_RenderTile, (uv_after_work_cb)EIO_AfterRenderTile, job_priority);
     m->_ref();
     d->Ref();
     guard.release();
@@ -5100,23 +7069,25 @@ template <typename Renderer> void process_layers(Renderer & ren,
                                             std::vector<mapnik::layer> const& layers,
                                             double scale_denom,
                                             std::string const& map_srs,
-                                            vector_tile_render_baton_t *closure)
+                                            VectorTile * d,
+                                            std::vector<std::pair<std::string, double> > * layer_stats = nullptr)
 {
     for (auto const& lyr : layers)
     {
         if (lyr.visible(scale_denom))
         {
             protozero::pbf_reader layer_msg;
-            if (closure->d->get_tile()->layer_reader(lyr.name(), layer_msg))
+            if (d->get_tile()->layer_reader(lyr.name(), layer_msg))
             {
+                std::chrono::steady_clock::time_point layer_start = std::chrono::steady_clock::now();
                 mapnik::layer lyr_copy(lyr);
                 lyr_copy.set_srs(map_srs);
                 std::shared_ptr<mapnik::vector_tile_impl::tile_datasource_pbf> ds = std::make_shared<
                                                 mapnik::vector_tile_impl::tile_datasource_pbf>(
                                                     layer_msg,
-                                                    closure->d->get_tile()->x(),
-                                                    closure->d->get_tile()->y(),
-                                                    closure->d->get_tile()->z());
+                                                    d->get_tile()->x(),
+                                                    d->get_tile()->y(),
+                                                    d->get_tile()->z());
                 ds->set_envelope(m_req.get_buffered_extent());
                 lyr_copy.set_datasource(ds);
                 std::set<std::string> names;
@@ -5130,31 +7101,497 @@ template <typename Renderer> void process_layers(Renderer & ren,
                                    m_req.extent(),
                                    m_req.buffer_size(),
                                    names);
+                if (layer_stats)
+                {
+                    layer_stats->emplace_back(lyr.name(), std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - layer_start).count());
+                }
+            }
+        }
+    }
+}
+
+void VectorTile::EIO_RenderTile(uv_work_t* req)
+{
+    vector_tile_render_baton_t *closure = static_cast<vector_tile_render_baton_t *>(req->data);
+    node_mapnik::trace_scope tracing(closure->trace, "vtile.render");
+
+    try
+    {
+        mapnik::Map const& map_in = *closure->m->get();
+        mapnik::vector_tile_impl::spherical_mercator merc(closure->d->tile_size());
+        double minx,miny,maxx,maxy;
+        if (closure->zxy_override)
+        {
+            merc.xyz(closure->x,closure->y,closure->z,minx,miny,maxx,maxy);
+        } 
+        else 
+        {
+            merc.xyz(closure->d->get_tile()->x(),
+                     closure->d->get_tile()->y(),
+                     closure->d->get_tile()->z(),
+                     minx,miny,maxx,maxy);
+        }
+        mapnik::box2d<double> map_extent(minx,miny,maxx,maxy);
+        mapnik::request m_req(closure->width, closure->height, map_extent);
+        m_req.set_buffer_size(closure->buffer_size);
+        mapnik::projection map_proj(map_in.srs(),true);
+        double scale_denom = closure->scale_denominator;
+        if (scale_denom <= 0.0)
+        {
+            scale_denom = mapnik::scale_denominator(m_req.scale(),map_proj.is_geographic());
+        }
+        scale_denom *= closure->scale_factor;
+        std::vector<mapnik::layer> const& layers = map_in.layers();
+#if defined(GRID_RENDERER)
+        // render grid for layer
+        if (closure->surface.is<Grid *>())
+        {
+            Grid * g = mapnik::util::get<Grid *>(closure->surface);
+            mapnik::grid_renderer<mapnik::grid> ren(map_in,
+                                                    m_req,
+                                                    closure->variables,
+                                                    *(g->get()),
+                                                    closure->scale_factor);
+            ren.start_map_processing(map_in);
+
+            mapnik::layer const& lyr = layers[closure->layer_idx];
+            if (lyr.visible(scale_denom))
+            {
+                protozero::pbf_reader layer_msg;
+                if (closure->d->get_tile()->layer_reader(lyr.name(),layer_msg))
+                {
+                    // copy field names
+                    std::set<std::string> attributes = g->get()->get_fields();
+
+                    // todo - make this a static constant
+                    std::string known_id_key = "__id__";
+                    if (attributes.find(known_id_key) != attributes.end())
+                    {
+                        attributes.erase(known_id_key);
+                    }
+                    std::string join_field = g->get()->get_key();
+                    if (known_id_key != join_field &&
+                        attributes.find(join_field) == attributes.end())
+                    {
+                        attributes.insert(join_field);
+                    }
+
+                    mapnik::layer lyr_copy(lyr);
+                    lyr_copy.set_srs(map_in.srs());
+                    std::shared_ptr<mapnik::vector_tile_impl::tile_datasource_pbf> ds = std::make_shared<
+                                                    mapnik::vector_tile_impl::tile_datasource_pbf>(
+                                                        layer_msg,
+                                                        closure->d->get_tile()->x(),
+                                                        closure->d->get_tile()->y(),
+                                                        closure->d->get_tile()->z());
+                    ds->set_envelope(m_req.get_buffered_extent());
+                    lyr_copy.set_datasource(ds);
+                    ren.apply_to_layer(lyr_copy,
+                                       ren,
+                                       map_proj,
+                                       m_req.scale(),
+                                       scale_denom,
+                                       m_req.width(),
+                                       m_req.height(),
+                                       m_req.extent(),
+                                       m_req.buffer_size(),
+                                       attributes);
+                }
+                ren.end_map_processing(map_in);
+            }
+        }
+        else
+#endif
+        if (closure->surface.is<CairoSurface *>())
+        {
+            CairoSurface * c = mapnik::util::get<CairoSurface *>(closure->surface);
+            if (closure->use_cairo)
+            {
+#if defined(HAVE_CAIRO)
+                mapnik::cairo_surface_ptr surface;
+                // TODO - support any surface type
+                surface = mapnik::cairo_surface_ptr(cairo_svg_surface_create_for_stream(
+                                                       (cairo_write_func_t)c->write_callback,
+                                                       (void*)(&c->ss_),
+                                                       static_cast<double>(c->width()),
+                                                       static_cast<double>(c->height())
+                                                    ),mapnik::cairo_surface_closer());
+                mapnik::cairo_ptr c_context = mapnik::create_context(surface);
+                mapnik::cairo_renderer<mapnik::cairo_ptr> ren(map_in,m_req,
+                                                                closure->variables,
+                                                                c_context,closure->scale_factor);
+                ren.start_map_processing(map_in);
+                process_layers(ren,m_req,map_proj,layers,scale_denom,map_in.srs(),closure->d);
+                ren.end_map_processing(map_in);
+#else
+                closure->error = true;
+                closure->error_name = "no support for rendering svg with cairo backend";
+#endif
+            }
+            else
+            {
+#if defined(SVG_RENDERER)
+                typedef mapnik::svg_renderer<std::ostream_iterator<char> > svg_ren;
+                std::ostream_iterator<char> output_stream_iterator(c->ss_);
+                svg_ren ren(map_in, m_req,
+                            closure->variables,
+                            output_stream_iterator, closure->scale_factor);
+                ren.start_map_processing(map_in);
+                process_layers(ren,m_req,map_proj,layers,scale_denom,map_in.srs(),closure->d);
+                ren.end_map_processing(map_in);
+#else
+                closure->error = true;
+                closure->error_name = "no support for rendering svg with native svg backend (-DSVG_RENDERER)";
+#endif
+            }
+        }
+        // render all layers with agg
+        else if (closure->surface.is<Image *>())
+        {
+            Image * js_image = mapnik::util::get<Image *>(closure->surface);
+            mapnik::image_any & im = *(js_image->get());
+            if (im.is<mapnik::image_rgba8>())
+            {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                mapnik::image_rgba8 & im_data = mapnik::util::get<mapnik::image_rgba8>(im);
+                mapnik::agg_renderer<mapnik::image_rgba8> ren(map_in,m_req,
+                                                        closure->variables,
+                                                        im_data,closure->scale_factor);
+                ren.start_map_processing(map_in);
+                process_layers(ren,m_req,map_proj,layers,scale_denom,map_in.srs(),closure->d,
+                               closure->collect_stats ? &closure->layer_stats : nullptr);
+                ren.end_map_processing(map_in);
+                if (closure->collect_stats)
+                {
+                    closure->render_ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+                }
+            }
+            else
+            {
+                throw std::runtime_error("This image type is not currently supported for rendering.");
+            }
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        closure->error = true;
+        closure->error_name = ex.what();
+    }
+}
+
+void VectorTile::EIO_AfterRenderTile(uv_work_t* req)
+{
+    Nan::HandleScope scope;
+    vector_tile_render_baton_t *closure = static_cast<vector_tile_render_baton_t *>(req->data);
+    if (closure->error)
+    {
+        v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 1, argv);
+    }
+    else
+    {
+        if (closure->surface.is<Image *>())
+        {
+            if (closure->collect_stats)
+            {
+                // per-call render telemetry requested with {stats: true}
+                v8::Local<v8::Object> stats = Nan::New<v8::Object>();
+                stats->Set(Nan::New("render_ms").ToLocalChecked(), Nan::New<v8::Number>(closure->render_ms));
+                v8::Local<v8::Object> layers_obj = Nan::New<v8::Object>();
+                for (auto const& layer_stat : closure->layer_stats)
+                {
+                    layers_obj->Set(Nan::New<v8::String>(layer_stat.first).ToLocalChecked(),
+                                    Nan::New<v8::Number>(layer_stat.second));
+                }
+                stats->Set(Nan::New("layers").ToLocalChecked(), layers_obj);
+                v8::Local<v8::Value> argv[3] = { Nan::Null(), mapnik::util::get<Image *>(closure->surface)->handle(), stats };
+                Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 3, argv);
+            }
+            else
+            {
+                v8::Local<v8::Value> argv[2] = { Nan::Null(), mapnik::util::get<Image *>(closure->surface)->handle() };
+                Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+            }
+        }
+#if defined(GRID_RENDERER)
+        else if (closure->surface.is<Grid *>())
+        {
+            v8::Local<v8::Value> argv[2] = { Nan::Null(), mapnik::util::get<Grid *>(closure->surface)->handle() };
+            Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+        }
+#endif
+        else if (closure->surface.is<CairoSurface *>())
+        {
+            v8::Local<v8::Value> argv[2] = { Nan::Null(), mapnik::util::get<CairoSurface *>(closure->surface)->handle() };
+            Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+        }
+    }
+
+    closure->m->_unref();
+    closure->d->Unref();
+    closure->cb.Reset();
+    delete closure;
+}
+
+struct render_to_buffer_baton_t
+{
+    uv_work_t request;
+    Map* m;
+    VectorTile* d;
+    std::vector<VectorTile*> sources;
+    std::string format;
+    unsigned width;
+    unsigned height;
+    int buffer_size;
+    double scale_factor;
+    double scale_denominator;
+    mapnik::attributes variables;
+    std::string result;
+    bool error;
+    std::string error_name;
+    Nan::Persistent<v8::Function> cb;
+    render_to_buffer_baton_t() :
+        request(),
+        m(nullptr),
+        d(nullptr),
+        sources(),
+        format("png"),
+        width(0),
+        height(0),
+        buffer_size(0),
+        scale_factor(1.0),
+        scale_denominator(0.0),
+        variables(),
+        result(),
+        error(false),
+        error_name(),
+        cb() {}
+};
+
+/**
+ * Composite, render and encode in one thread-pool job: optionally merge
+ * an array of source tiles into this tile, render the result with the
+ * given map into an image and encode it, delivering the final Buffer to
+ * the callback. Fusing the pipeline saves the two intermediate event
+ * loop round trips and the Image handle that chaining composite(),
+ * render() and encode() costs per request.
+ *
+ * @memberof VectorTile
+ * @instance
+ * @name renderToBuffer
+ * @param {mapnik.Map} map loaded map to render with
+ * @param {Object} [options]
+ * @param {Array<mapnik.VectorTile>} [options.sources] source tiles to
+ * composite into this tile before rendering (with composite defaults)
+ * @param {string} [options.format=png] image format for the final encode
+ * @param {number} [options.width=256] output image width
+ * @param {number} [options.height=256] output image height
+ * @param {number} [options.buffer_size=0]
+ * @param {number} [options.scale=1.0]
+ * @param {number} [options.scale_denominator=0.0]
+ * @param {Object} [options.variables]
+ * @param {Function} callback - `function(err, buffer)`
+ * @example
+ * vt.renderToBuffer(map, {sources: [vt2], format: 'png'}, function(err, buffer) {
+ *   if (err) throw err;
+ *   // final encoded tile bytes
+ * });
+ */
+NAN_METHOD(VectorTile::renderToBuffer)
+{
+    VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
+    if (info.Length() < 2)
+    {
+        Nan::ThrowTypeError("expects a mapnik.Map, optional options and a callback");
+        return;
+    }
+    if (!info[0]->IsObject())
+    {
+        Nan::ThrowTypeError("mapnik.Map expected as first arg");
+        return;
+    }
+    v8::Local<v8::Object> obj = info[0]->ToObject();
+    if (obj->IsNull() || obj->IsUndefined() || !Nan::New(Map::constructor)->HasInstance(obj))
+    {
+        Nan::ThrowTypeError("mapnik.Map expected as first arg");
+        return;
+    }
+    Map *m = Nan::ObjectWrap::Unwrap<Map>(obj);
+
+    v8::Local<v8::Value> callback = info[info.Length()-1];
+    if (!callback->IsFunction())
+    {
+        Nan::ThrowTypeError("last argument must be a callback function");
+        return;
+    }
+
+    std::unique_ptr<render_to_buffer_baton_t> closure(new render_to_buffer_baton_t());
+    closure->request.data = closure.get();
+    closure->m = m;
+    closure->d = d;
+    closure->width = 256;
+    closure->height = 256;
+
+    if (info.Length() > 2)
+    {
+        if (!info[1]->IsObject())
+        {
+            Nan::ThrowTypeError("optional second argument must be an options object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[1]->ToObject();
+        if (options->Has(Nan::New("sources").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("sources").ToLocalChecked());
+            if (!param_val->IsArray())
+            {
+                Nan::ThrowTypeError("option 'sources' must be an array of VectorTile objects");
+                return;
+            }
+            v8::Local<v8::Array> sources = param_val.As<v8::Array>();
+            for (unsigned i = 0; i < sources->Length(); ++i)
+            {
+                v8::Local<v8::Value> tile_val = sources->Get(i);
+                if (!tile_val->IsObject())
+                {
+                    Nan::ThrowTypeError("option 'sources' must be an array of VectorTile objects");
+                    return;
+                }
+                v8::Local<v8::Object> tile_obj = tile_val->ToObject();
+                if (tile_obj->IsNull() || tile_obj->IsUndefined() ||
+                    !Nan::New(VectorTile::constructor)->HasInstance(tile_obj))
+                {
+                    Nan::ThrowTypeError("option 'sources' must be an array of VectorTile objects");
+                    return;
+                }
+                closure->sources.push_back(Nan::ObjectWrap::Unwrap<VectorTile>(tile_obj));
+            }
+        }
+        if (options->Has(Nan::New("format").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("format").ToLocalChecked());
+            if (!param_val->IsString())
+            {
+                Nan::ThrowTypeError("option 'format' must be a string");
+                return;
+            }
+            closure->format = TOSTR(param_val);
+        }
+        if (options->Has(Nan::New("width").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("width").ToLocalChecked());
+            if (!param_val->IsNumber() || param_val->IntegerValue() <= 0)
+            {
+                Nan::ThrowTypeError("option 'width' must be a positive integer");
+                return;
+            }
+            closure->width = static_cast<unsigned>(param_val->IntegerValue());
+        }
+        if (options->Has(Nan::New("height").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("height").ToLocalChecked());
+            if (!param_val->IsNumber() || param_val->IntegerValue() <= 0)
+            {
+                Nan::ThrowTypeError("option 'height' must be a positive integer");
+                return;
+            }
+            closure->height = static_cast<unsigned>(param_val->IntegerValue());
+        }
+        if (options->Has(Nan::New("buffer_size").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("buffer_size").ToLocalChecked());
+            if (!param_val->IsNumber())
+            {
+                Nan::ThrowTypeError("optional arg 'buffer_size' must be a number");
+                return;
+            }
+            closure->buffer_size = param_val->IntegerValue();
+        }
+        if (options->Has(Nan::New("scale").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("scale").ToLocalChecked());
+            if (!param_val->IsNumber())
+            {
+                Nan::ThrowTypeError("optional arg 'scale' must be a number");
+                return;
+            }
+            closure->scale_factor = param_val->NumberValue();
+        }
+        if (options->Has(Nan::New("scale_denominator").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("scale_denominator").ToLocalChecked());
+            if (!param_val->IsNumber())
+            {
+                Nan::ThrowTypeError("optional arg 'scale_denominator' must be a number");
+                return;
+            }
+            closure->scale_denominator = param_val->NumberValue();
+        }
+        if (options->Has(Nan::New("variables").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("variables").ToLocalChecked());
+            if (!param_val->IsObject())
+            {
+                Nan::ThrowTypeError("optional arg 'variables' must be an object");
+                return;
             }
+            object_to_container(closure->variables,param_val->ToObject());
         }
     }
+
+    closure->cb.Reset(callback.As<v8::Function>());
+    d->detach_tile();
+    uv_queue_work(uv_default_loop(), &closure->request, EIO_RenderToBuffer, (uv_after_work_cb)EIO_AfterRenderToBuffer);
+    m->_ref();
+    d->Ref();
+    for (VectorTile* source : closure->sources)
+    {
+        source->Ref();
+    }
+    closure.release();
+    return;
 }
 
-void VectorTile::EIO_RenderTile(uv_work_t* req)
+void VectorTile::EIO_RenderToBuffer(uv_work_t* req)
 {
-    vector_tile_render_baton_t *closure = static_cast<vector_tile_render_baton_t *>(req->data);
-
+    render_to_buffer_baton_t *closure = static_cast<render_to_buffer_baton_t *>(req->data);
     try
     {
+        // stage 1: composite the source tiles into this tile
+        if (!closure->sources.empty())
+        {
+            std::vector<VectorTile*> sources = closure->sources;
+            boost::optional<mapnik::box2d<double>> max_extent;
+            _composite(closure->d,
+                       sources,
+                       1.0,            // scale_factor
+                       0,              // offset_x
+                       0,              // offset_y
+                       0.1,            // area_threshold
+                       true,           // strictly_simple
+                       false,          // multi_polygon_union
+                       mapnik::vector_tile_impl::positive_fill,
+                       0.0,            // scale_denominator
+                       false,          // reencode
+                       max_extent,
+                       0.0,            // simplify_distance
+                       false,          // process_all_rings
+                       "webp",
+                       mapnik::SCALING_BILINEAR,
+                       std::launch::deferred,
+                       false);         // parallel_sources
+        }
+
+        // stage 2: render the composited tile with the map
         mapnik::Map const& map_in = *closure->m->get();
         mapnik::vector_tile_impl::spherical_mercator merc(closure->d->tile_size());
         double minx,miny,maxx,maxy;
-        if (closure->zxy_override)
-        {
-            merc.xyz(closure->x,closure->y,closure->z,minx,miny,maxx,maxy);
-        } 
-        else 
-        {
-            merc.xyz(closure->d->get_tile()->x(),
-                     closure->d->get_tile()->y(),
-                     closure->d->get_tile()->z(),
-                     minx,miny,maxx,maxy);
-        }
+        merc.xyz(closure->d->get_tile()->x(),
+                 closure->d->get_tile()->y(),
+                 closure->d->get_tile()->z(),
+                 minx,miny,maxx,maxy);
         mapnik::box2d<double> map_extent(minx,miny,maxx,maxy);
         mapnik::request m_req(closure->width, closure->height, map_extent);
         m_req.set_buffer_size(closure->buffer_size);
@@ -5166,129 +7603,16 @@ void VectorTile::EIO_RenderTile(uv_work_t* req)
         }
         scale_denom *= closure->scale_factor;
         std::vector<mapnik::layer> const& layers = map_in.layers();
-#if defined(GRID_RENDERER)
-        // render grid for layer
-        if (closure->surface.is<Grid *>())
-        {
-            Grid * g = mapnik::util::get<Grid *>(closure->surface);
-            mapnik::grid_renderer<mapnik::grid> ren(map_in,
-                                                    m_req,
-                                                    closure->variables,
-                                                    *(g->get()),
-                                                    closure->scale_factor);
-            ren.start_map_processing(map_in);
-
-            mapnik::layer const& lyr = layers[closure->layer_idx];
-            if (lyr.visible(scale_denom))
-            {
-                protozero::pbf_reader layer_msg;
-                if (closure->d->get_tile()->layer_reader(lyr.name(),layer_msg))
-                {
-                    // copy field names
-                    std::set<std::string> attributes = g->get()->get_fields();
-
-                    // todo - make this a static constant
-                    std::string known_id_key = "__id__";
-                    if (attributes.find(known_id_key) != attributes.end())
-                    {
-                        attributes.erase(known_id_key);
-                    }
-                    std::string join_field = g->get()->get_key();
-                    if (known_id_key != join_field &&
-                        attributes.find(join_field) == attributes.end())
-                    {
-                        attributes.insert(join_field);
-                    }
+        mapnik::image_rgba8 im_data(closure->width, closure->height);
+        mapnik::agg_renderer<mapnik::image_rgba8> ren(map_in,m_req,
+                                                closure->variables,
+                                                im_data,closure->scale_factor);
+        ren.start_map_processing(map_in);
+        process_layers(ren,m_req,map_proj,layers,scale_denom,map_in.srs(),closure->d);
+        ren.end_map_processing(map_in);
 
-                    mapnik::layer lyr_copy(lyr);
-                    lyr_copy.set_srs(map_in.srs());
-                    std::shared_ptr<mapnik::vector_tile_impl::tile_datasource_pbf> ds = std::make_shared<
-                                                    mapnik::vector_tile_impl::tile_datasource_pbf>(
-                                                        layer_msg,
-                                                        closure->d->get_tile()->x(),
-                                                        closure->d->get_tile()->y(),
-                                                        closure->d->get_tile()->z());
-                    ds->set_envelope(m_req.get_buffered_extent());
-                    lyr_copy.set_datasource(ds);
-                    ren.apply_to_layer(lyr_copy,
-                                       ren,
-                                       map_proj,
-                                       m_req.scale(),
-                                       scale_denom,
-                                       m_req.width(),
-                                       m_req.height(),
-                                       m_req.extent(),
-                                       m_req.buffer_size(),
-                                       attributes);
-                }
-                ren.end_map_processing(map_in);
-            }
-        }
-        else
-#endif
-        if (closure->surface.is<CairoSurface *>())
-        {
-            CairoSurface * c = mapnik::util::get<CairoSurface *>(closure->surface);
-            if (closure->use_cairo)
-            {
-#if defined(HAVE_CAIRO)
-                mapnik::cairo_surface_ptr surface;
-                // TODO - support any surface type
-                surface = mapnik::cairo_surface_ptr(cairo_svg_surface_create_for_stream(
-                                                       (cairo_write_func_t)c->write_callback,
-                                                       (void*)(&c->ss_),
-                                                       static_cast<double>(c->width()),
-                                                       static_cast<double>(c->height())
-                                                    ),mapnik::cairo_surface_closer());
-                mapnik::cairo_ptr c_context = mapnik::create_context(surface);
-                mapnik::cairo_renderer<mapnik::cairo_ptr> ren(map_in,m_req,
-                                                                closure->variables,
-                                                                c_context,closure->scale_factor);
-                ren.start_map_processing(map_in);
-                process_layers(ren,m_req,map_proj,layers,scale_denom,map_in.srs(),closure);
-                ren.end_map_processing(map_in);
-#else
-                closure->error = true;
-                closure->error_name = "no support for rendering svg with cairo backend";
-#endif
-            }
-            else
-            {
-#if defined(SVG_RENDERER)
-                typedef mapnik::svg_renderer<std::ostream_iterator<char> > svg_ren;
-                std::ostream_iterator<char> output_stream_iterator(c->ss_);
-                svg_ren ren(map_in, m_req,
-                            closure->variables,
-                            output_stream_iterator, closure->scale_factor);
-                ren.start_map_processing(map_in);
-                process_layers(ren,m_req,map_proj,layers,scale_denom,map_in.srs(),closure);
-                ren.end_map_processing(map_in);
-#else
-                closure->error = true;
-                closure->error_name = "no support for rendering svg with native svg backend (-DSVG_RENDERER)";
-#endif
-            }
-        }
-        // render all layers with agg
-        else if (closure->surface.is<Image *>())
-        {
-            Image * js_image = mapnik::util::get<Image *>(closure->surface);
-            mapnik::image_any & im = *(js_image->get());
-            if (im.is<mapnik::image_rgba8>())
-            {
-                mapnik::image_rgba8 & im_data = mapnik::util::get<mapnik::image_rgba8>(im);
-                mapnik::agg_renderer<mapnik::image_rgba8> ren(map_in,m_req,
-                                                        closure->variables,
-                                                        im_data,closure->scale_factor);
-                ren.start_map_processing(map_in);
-                process_layers(ren,m_req,map_proj,layers,scale_denom,map_in.srs(),closure);
-                ren.end_map_processing(map_in);
-            }
-            else
-            {
-                throw std::runtime_error("This image type is not currently supported for rendering.");
-            }
-        }
+        // stage 3: encode straight from the render target
+        closure->result = mapnik::save_to_string(im_data, closure->format);
     }
     catch (std::exception const& ex)
     {
@@ -5297,10 +7621,10 @@ void VectorTile::EIO_RenderTile(uv_work_t* req)
     }
 }
 
-void VectorTile::EIO_AfterRenderTile(uv_work_t* req)
+void VectorTile::EIO_AfterRenderToBuffer(uv_work_t* req)
 {
     Nan::HandleScope scope;
-    vector_tile_render_baton_t *closure = static_cast<vector_tile_render_baton_t *>(req->data);
+    render_to_buffer_baton_t *closure = static_cast<render_to_buffer_baton_t *>(req->data);
     if (closure->error)
     {
         v8::Local<v8::Value> argv[1] = { Nan::Error(closure->error_name.c_str()) };
@@ -5308,25 +7632,15 @@ void VectorTile::EIO_AfterRenderTile(uv_work_t* req)
     }
     else
     {
-        if (closure->surface.is<Image *>())
-        {
-            v8::Local<v8::Value> argv[2] = { Nan::Null(), mapnik::util::get<Image *>(closure->surface)->handle() };
-            Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
-        }
-#if defined(GRID_RENDERER)
-        else if (closure->surface.is<Grid *>())
-        {
-            v8::Local<v8::Value> argv[2] = { Nan::Null(), mapnik::util::get<Grid *>(closure->surface)->handle() };
-            Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
-        }
-#endif
-        else if (closure->surface.is<CairoSurface *>())
-        {
-            v8::Local<v8::Value> argv[2] = { Nan::Null(), mapnik::util::get<CairoSurface *>(closure->surface)->handle() };
-            Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
-        }
+        closure->d->invalidate_query_index();
+        v8::Local<v8::Value> argv[2] = { Nan::Null(),
+            node_mapnik::pooled_buffer_to_v8(std::move(closure->result)) };
+        Nan::MakeCallback(Nan::GetCurrentContext()->Global(), Nan::New(closure->cb), 2, argv);
+    }
+    for (VectorTile* source : closure->sources)
+    {
+        source->Unref();
     }
-
     closure->m->_unref();
     closure->d->Unref();
     closure->cb.Reset();
@@ -5886,17 +8200,63 @@ void layer_not_valid(protozero::pbf_reader & layer_msg,
 }
 
 void vector_tile_not_simple(VectorTile * v,
-                            std::vector<not_simple_feature> & errors)
+                            std::vector<not_simple_feature> & errors,
+                            std::string const& layer_name = "")
 {
+    if (!layer_name.empty())
+    {
+        protozero::pbf_reader layer_msg;
+        if (v->get_tile()->layer_reader(layer_name, layer_msg))
+        {
+            layer_not_simple(layer_msg,
+                             v->get_tile()->x(),
+                             v->get_tile()->y(),
+                             v->get_tile()->z(),
+                             errors);
+        }
+        return;
+    }
+    // scan the layers in parallel - the pbf readers are read-only views
+    // into the tile buffer - and merge per-layer results in layer order
+    std::vector<protozero::pbf_reader> layers;
     protozero::pbf_reader tile_msg(v->get_tile()->get_reader());
     while (tile_msg.next(mapnik::vector_tile_impl::Tile_Encoding::LAYERS))
     {
-        protozero::pbf_reader layer_msg(tile_msg.get_message());
-        layer_not_simple(layer_msg,
-                         v->get_tile()->x(),
-                         v->get_tile()->y(),
-                         v->get_tile()->z(),
-                         errors);
+        layers.emplace_back(tile_msg.get_message());
+    }
+    if (layers.size() <= 1)
+    {
+        for (protozero::pbf_reader & layer_msg : layers)
+        {
+            layer_not_simple(layer_msg,
+                             v->get_tile()->x(),
+                             v->get_tile()->y(),
+                             v->get_tile()->z(),
+                             errors);
+        }
+        return;
+    }
+    std::vector<std::vector<not_simple_feature> > results(layers.size());
+    std::vector<std::future<void> > futures;
+    futures.reserve(layers.size());
+    for (std::size_t i = 0; i < layers.size(); ++i)
+    {
+        futures.push_back(std::async(std::launch::async, [v, &layers, &results, i]()
+        {
+            layer_not_simple(layers[i],
+                             v->get_tile()->x(),
+                             v->get_tile()->y(),
+                             v->get_tile()->z(),
+                             results[i]);
+        }));
+    }
+    for (auto & future : futures)
+    {
+        future.get();
+    }
+    for (auto & result : results)
+    {
+        errors.insert(errors.end(), result.begin(), result.end());
     }
 }
 
@@ -5923,20 +8283,73 @@ void vector_tile_not_valid(VectorTile * v,
                            std::vector<not_valid_feature> & errors,
                            bool split_multi_features = false,
                            bool lat_lon = false,
-                           bool web_merc = false)
+                           bool web_merc = false,
+                           std::string const& layer_name = "")
 {
+    if (!layer_name.empty())
+    {
+        protozero::pbf_reader layer_msg;
+        if (v->get_tile()->layer_reader(layer_name, layer_msg))
+        {
+            layer_not_valid(layer_msg,
+                            v->get_tile()->x(),
+                            v->get_tile()->y(),
+                            v->get_tile()->z(),
+                            errors,
+                            split_multi_features,
+                            lat_lon,
+                            web_merc);
+        }
+        return;
+    }
+    // scan the layers in parallel - the pbf readers are read-only views
+    // into the tile buffer - and merge per-layer results in layer order
+    std::vector<protozero::pbf_reader> layers;
     protozero::pbf_reader tile_msg(v->get_tile()->get_reader());
     while (tile_msg.next(mapnik::vector_tile_impl::Tile_Encoding::LAYERS))
     {
-        protozero::pbf_reader layer_msg(tile_msg.get_message());
-        layer_not_valid(layer_msg,
-                        v->get_tile()->x(),
-                        v->get_tile()->y(),
-                        v->get_tile()->z(),
-                        errors,
-                        split_multi_features,
-                        lat_lon,
-                        web_merc);
+        layers.emplace_back(tile_msg.get_message());
+    }
+    if (layers.size() <= 1)
+    {
+        for (protozero::pbf_reader & layer_msg : layers)
+        {
+            layer_not_valid(layer_msg,
+                            v->get_tile()->x(),
+                            v->get_tile()->y(),
+                            v->get_tile()->z(),
+                            errors,
+                            split_multi_features,
+                            lat_lon,
+                            web_merc);
+        }
+        return;
+    }
+    std::vector<std::vector<not_valid_feature> > results(layers.size());
+    std::vector<std::future<void> > futures;
+    futures.reserve(layers.size());
+    for (std::size_t i = 0; i < layers.size(); ++i)
+    {
+        futures.push_back(std::async(std::launch::async,
+                                     [v, &layers, &results, i, split_multi_features, lat_lon, web_merc]()
+        {
+            layer_not_valid(layers[i],
+                            v->get_tile()->x(),
+                            v->get_tile()->y(),
+                            v->get_tile()->z(),
+                            results[i],
+                            split_multi_features,
+                            lat_lon,
+                            web_merc);
+        }));
+    }
+    for (auto & future : futures)
+    {
+        future.get();
+    }
+    for (auto & result : results)
+    {
+        errors.insert(errors.end(), result.begin(), result.end());
     }
 }
 
@@ -5967,6 +8380,7 @@ struct not_simple_baton
     uv_work_t request;
     VectorTile* v;
     bool error;
+    std::string layer_name;
     std::vector<not_simple_feature> result;
     std::string err_msg;
     Nan::Persistent<v8::Function> cb;
@@ -5980,11 +8394,33 @@ struct not_valid_baton
     bool split_multi_features;
     bool lat_lon;
     bool web_merc;
+    std::string layer_name;
     std::vector<not_valid_feature> result;
     std::string err_msg;
     Nan::Persistent<v8::Function> cb;
 };
 
+namespace {
+
+// parses the optional {layer: name} filter shared by the geometry
+// report methods; returns false after throwing on invalid input
+bool parse_layer_filter_option(v8::Local<v8::Object> const& options, std::string & layer_name)
+{
+    if (options->Has(Nan::New("layer").ToLocalChecked()))
+    {
+        v8::Local<v8::Value> param_val = options->Get(Nan::New("layer").ToLocalChecked());
+        if (!param_val->IsString())
+        {
+            Nan::ThrowError("option 'layer' must be a layer name (string)");
+            return false;
+        }
+        layer_name = TOSTR(param_val);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
 /**
  * Count the number of geometries that are not [OGC simple]{@link http://www.iso.org/iso/catalogue_detail.htm?csnumber=40114}
  *
@@ -6006,10 +8442,23 @@ v8::Local<v8::Value> VectorTile::_reportGeometrySimplicitySync(Nan::NAN_METHOD_A
 {
     Nan::EscapableHandleScope scope;
     VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
+    std::string layer_name;
+    if (info.Length() >= 1 && !info[0]->IsFunction())
+    {
+        if (!info[0]->IsObject())
+        {
+            Nan::ThrowError("The first argument must be an object");
+            return scope.Escape(Nan::Undefined());
+        }
+        if (!parse_layer_filter_option(info[0]->ToObject(), layer_name))
+        {
+            return scope.Escape(Nan::Undefined());
+        }
+    }
     try
     {
         std::vector<not_simple_feature> errors;
-        vector_tile_not_simple(d, errors);
+        vector_tile_not_simple(d, errors, layer_name);
         return scope.Escape(make_not_simple_array(errors));
     }
     catch (std::exception const& ex)
@@ -6053,6 +8502,7 @@ v8::Local<v8::Value> VectorTile::_reportGeometryValiditySync(Nan::NAN_METHOD_ARG
     bool split_multi_features = false;
     bool lat_lon = false;
     bool web_merc = false;
+    std::string layer_name;
     if (info.Length() >= 1)
     {
         if (!info[0]->IsObject())
@@ -6094,12 +8544,17 @@ v8::Local<v8::Value> VectorTile::_reportGeometryValiditySync(Nan::NAN_METHOD_ARG
             }
             web_merc = param_val->BooleanValue();
         }
+
+        if (!parse_layer_filter_option(options, layer_name))
+        {
+            return scope.Escape(Nan::Undefined());
+        }
     }
     VectorTile* d = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
     try
     {
         std::vector<not_valid_feature> errors;
-        vector_tile_not_valid(d, errors, split_multi_features, lat_lon, web_merc);
+        vector_tile_not_valid(d, errors, split_multi_features, lat_lon, web_merc, layer_name);
         return scope.Escape(make_not_valid_array(errors));
     }
     catch (std::exception const& ex)
@@ -6129,23 +8584,32 @@ v8::Local<v8::Value> VectorTile::_reportGeometryValiditySync(Nan::NAN_METHOD_ARG
  */
 NAN_METHOD(VectorTile::reportGeometrySimplicity)
 {
-    if (info.Length() == 0)
+    if (info.Length() == 0 || !info[info.Length() - 1]->IsFunction())
     {
         info.GetReturnValue().Set(_reportGeometrySimplicitySync(info));
         return;
     }
-    // ensure callback is a function
     v8::Local<v8::Value> callback = info[info.Length() - 1];
-    if (!callback->IsFunction())
+
+    std::string layer_name;
+    if (info.Length() > 1)
     {
-        Nan::ThrowTypeError("last argument must be a callback function");
-        return;
+        if (!info[0]->IsObject())
+        {
+            Nan::ThrowError("The first argument must be an object");
+            return;
+        }
+        if (!parse_layer_filter_option(info[0]->ToObject(), layer_name))
+        {
+            return;
+        }
     }
 
     not_simple_baton *closure = new not_simple_baton();
     closure->request.data = closure;
     closure->v = Nan::ObjectWrap::Unwrap<VectorTile>(info.Holder());
     closure->error = false;
+    closure->layer_name = layer_name;
     closure->cb.Reset(callback.As<v8::Function>());
     uv_queue_work(uv_default_loop(), &closure->request, EIO_ReportGeometrySimplicity, (uv_after_work_cb)EIO_AfterReportGeometrySimplicity);
     closure->v->Ref();
@@ -6157,7 +8621,7 @@ void VectorTile::EIO_ReportGeometrySimplicity(uv_work_t* req)
     not_simple_baton *closure = static_cast<not_simple_baton *>(req->data);
     try
     {
-        vector_tile_not_simple(closure->v, closure->result);
+        vector_tile_not_simple(closure->v, closure->result, closure->layer_name);
     }
     catch (std::exception const& ex)
     {
@@ -6220,6 +8684,7 @@ NAN_METHOD(VectorTile::reportGeometryValidity)
     bool split_multi_features = false;
     bool lat_lon = false;
     bool web_merc = false;
+    std::string layer_name;
     if (info.Length() >= 2)
     {
         if (!info[0]->IsObject())
@@ -6261,6 +8726,11 @@ NAN_METHOD(VectorTile::reportGeometryValidity)
             }
             web_merc = param_val->BooleanValue();
         }
+
+        if (!parse_layer_filter_option(options, layer_name))
+        {
+            return;
+        }
     }
     // ensure callback is a function
     v8::Local<v8::Value> callback = info[info.Length() - 1];
@@ -6277,6 +8747,7 @@ NAN_METHOD(VectorTile::reportGeometryValidity)
     closure->split_multi_features = split_multi_features;
     closure->lat_lon = lat_lon;
     closure->web_merc = web_merc;
+    closure->layer_name = layer_name;
     closure->cb.Reset(callback.As<v8::Function>());
     uv_queue_work(uv_default_loop(), &closure->request, EIO_ReportGeometryValidity, (uv_after_work_cb)EIO_AfterReportGeometryValidity);
     closure->v->Ref();
@@ -6288,7 +8759,7 @@ void VectorTile::EIO_ReportGeometryValidity(uv_work_t* req)
     not_valid_baton *closure = static_cast<not_valid_baton *>(req->data);
     try
     {
-        vector_tile_not_valid(closure->v, closure->result, closure->split_multi_features, closure->lat_lon, closure->web_merc);
+        vector_tile_not_valid(closure->v, closure->result, closure->split_multi_features, closure->lat_lon, closure->web_merc, closure->layer_name);
     }
     catch (std::exception const& ex)
     {
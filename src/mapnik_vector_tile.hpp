@@ -8,9 +8,14 @@
 #pragma GCC diagnostic pop
 
 // mapnik-vector-tile
+#include "vector_tile_config.hpp"
 #include "vector_tile_merc_tile.hpp"
 
 // std
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <string>
 #include <set>
 #include <vector>
@@ -18,10 +23,16 @@
 // mapnik
 #include <mapnik/feature.hpp>
 
+// node-mapnik
+#include "memory_stats.hpp"
+
+
 // boost
 #include <boost/version.hpp>
 
-struct query_lonlat 
+namespace detail { struct tile_query_index; }
+
+struct query_lonlat
 {
     double lon;
     double lat;
@@ -65,11 +76,18 @@ public:
     static void get_data(uv_work_t* req);
     static void after_get_data(uv_work_t* req);
     static NAN_METHOD(render);
+    static NAN_METHOD(renderToBuffer);
+    static void EIO_RenderToBuffer(uv_work_t* req);
+    static void EIO_AfterRenderToBuffer(uv_work_t* req);
     static NAN_METHOD(toJSON);
+    static void _toJSONBuffer(VectorTile* d, std::string & out);
+    static void EIO_ToJSONBuffer(uv_work_t* req);
+    static void EIO_AfterToJSONBuffer(uv_work_t* req);
     static NAN_METHOD(query);
+    static NAN_METHOD(hitTest);
     static void EIO_Query(uv_work_t* req);
     static void EIO_AfterQuery(uv_work_t* req);
-    static std::vector<query_result> _query(VectorTile* d, double lon, double lat, double tolerance, std::string const& layer_name);
+    static std::vector<query_result> _query(VectorTile* d, double lon, double lat, double tolerance, std::string const& layer_name, bool use_index);
     static bool _querySort(query_result const& a, query_result const& b);
     static v8::Local<v8::Array> _queryResultToV8(std::vector<query_result> const& result);
     static NAN_METHOD(queryMany);
@@ -89,7 +107,21 @@ public:
     static NAN_METHOD(toGeoJSONSync);
     static void to_geojson(uv_work_t* req);
     static void after_to_geojson(uv_work_t* req);
+    static NAN_METHOD(toGeoJSONStream);
+    static void to_geojson_stream(uv_work_t* req);
+    static void after_to_geojson_stream(uv_work_t* req);
     static NAN_METHOD(addGeoJSON);
+    static void _addGeoJSON(VectorTile* d,
+                            std::string const& geojson_string,
+                            std::string const& geojson_name,
+                            double area_threshold,
+                            double simplify_distance,
+                            bool strictly_simple,
+                            bool multi_polygon_union,
+                            mapnik::vector_tile_impl::polygon_fill_type fill_type,
+                            bool process_all_rings);
+    static void EIO_AddGeoJSON(uv_work_t* req);
+    static void EIO_AfterAddGeoJSON(uv_work_t* req);
     static NAN_METHOD(addImage);
     static void EIO_AddImage(uv_work_t* req);
     static void EIO_AfterAddImage(uv_work_t* req);
@@ -113,11 +145,16 @@ public:
     static v8::Local<v8::Value> _addDataSync(Nan::NAN_METHOD_ARGS_TYPE info);
     static NAN_METHOD(addDataSync);
     static NAN_METHOD(composite);
+    static NAN_METHOD(generatePyramid);
+    static void EIO_GeneratePyramid(uv_work_t* req);
+    static void EIO_AfterGeneratePyramid(uv_work_t* req);
     static NAN_METHOD(compositeSync);
     static v8::Local<v8::Value> _compositeSync(Nan::NAN_METHOD_ARGS_TYPE info);
     static void EIO_Composite(uv_work_t* req);
     static void EIO_AfterComposite(uv_work_t* req);
     static NAN_METHOD(painted);
+    static NAN_METHOD(release);
+    static NAN_METHOD(pool);
     static NAN_METHOD(clearSync);
     static v8::Local<v8::Value> _clearSync(Nan::NAN_METHOD_ARGS_TYPE info);
     static NAN_METHOD(clear);
@@ -155,9 +192,46 @@ public:
                std::uint32_t tile_size,
                std::int32_t buffer_size);
 
-    void clear() 
+    void clear()
     {
+        detach_tile();
         tile_->clear();
+        invalidate_query_index();
+    }
+
+    // called before any in-place mutation: when aliased getData buffers
+    // (or other holders) still reference the tile's storage, swap in a
+    // copy so the outstanding buffers keep co-owning the old storage
+    // instead of dangling when the mutation reallocates it
+    void detach_tile()
+    {
+        if (tile_.use_count() > 1)
+        {
+            tile_ = std::make_shared<mapnik::vector_tile_impl::merc_tile>(*tile_);
+        }
+    }
+
+    // lazily built r-tree over the tile's decoded features, used by
+    // query({index: true}); built once in the thread pool and reused
+    // until the tile data changes
+    std::shared_ptr<detail::tile_query_index> ensure_query_index();
+
+    // lazily built name -> byte-range directory over the tile's layers,
+    // so layer() does not rescan the protobuf per call; rebuilt after
+    // any mutation through the same invalidation funnel
+    bool layer_bytes(std::string const& name, const char *& data, std::size_t & size);
+
+    void invalidate_query_index()
+    {
+        {
+            std::lock_guard<std::mutex> lock(query_index_mutex_);
+            query_index_.reset();
+            layer_directory_.clear();
+            layer_directory_valid_ = false;
+        }
+        // every tile mutation funnels through here, so it doubles as the
+        // refresh point for the native memory accounting
+        tracker_.update(static_cast<std::int64_t>(tile_->size()));
     }
     
     std::uint32_t tile_size() const
@@ -202,6 +276,11 @@ public:
 
 private:
     mapnik::vector_tile_impl::merc_tile_ptr tile_;
+    std::shared_ptr<detail::tile_query_index> query_index_;
+    std::map<std::string, std::pair<const char *, std::size_t> > layer_directory_;
+    bool layer_directory_valid_ = false;
+    std::mutex query_index_mutex_;
+    node_mapnik::object_tracker tracker_;
     ~VectorTile();
 };
 
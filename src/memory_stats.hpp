@@ -0,0 +1,99 @@
+#ifndef __NODE_MAPNIK_MEMORY_STATS_H__
+#define __NODE_MAPNIK_MEMORY_STATS_H__
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wshadow"
+#include <nan.h>
+#pragma GCC diagnostic pop
+
+// stl
+#include <atomic>
+#include <cstdint>
+
+namespace node_mapnik {
+
+// Live object count and native byte total for one wrapper class,
+// readable from JS through mapnik.memoryStats(). The native buffers
+// behind VectorTile/Image/Grid are invisible to V8's heap statistics,
+// so these counters are the only way to attribute RSS to them.
+struct wrapper_stats
+{
+    std::atomic<std::int64_t> count;
+    std::atomic<std::int64_t> bytes;
+    wrapper_stats() : count(0), bytes(0) {}
+};
+
+inline wrapper_stats & vector_tile_stats()
+{
+    static wrapper_stats stats;
+    return stats;
+}
+
+inline wrapper_stats & image_stats()
+{
+    static wrapper_stats stats;
+    return stats;
+}
+
+inline wrapper_stats & grid_stats()
+{
+    static wrapper_stats stats;
+    return stats;
+}
+
+// Per-object tracker owned by a wrapper: bumps the class counters over
+// the object's lifetime and mirrors the byte total into V8's external
+// memory accounting so GC pressure reflects the native footprint.
+// update() may be called from worker threads - the atomics are always
+// kept accurate, while AdjustExternalMemory only runs when a V8 isolate
+// is entered on the calling thread, with the unreported remainder
+// settled by the next on-loop update or the destructor.
+class object_tracker
+{
+public:
+    explicit object_tracker(wrapper_stats & stats) :
+        stats_(stats),
+        bytes_(0),
+        external_(0)
+    {
+        stats_.count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~object_tracker()
+    {
+        stats_.bytes.fetch_sub(bytes_, std::memory_order_relaxed);
+        stats_.count.fetch_sub(1, std::memory_order_relaxed);
+        if (external_ != 0 && v8::Isolate::GetCurrent() != nullptr)
+        {
+            Nan::AdjustExternalMemory(static_cast<int>(-external_));
+        }
+    }
+
+    object_tracker(object_tracker const&) = delete;
+    object_tracker& operator=(object_tracker const&) = delete;
+
+    void update(std::int64_t bytes)
+    {
+        std::int64_t delta = bytes - bytes_;
+        if (delta != 0)
+        {
+            bytes_ = bytes;
+            stats_.bytes.fetch_add(delta, std::memory_order_relaxed);
+        }
+        if (bytes_ != external_ && v8::Isolate::GetCurrent() != nullptr)
+        {
+            Nan::AdjustExternalMemory(static_cast<int>(bytes_ - external_));
+            external_ = bytes_;
+        }
+    }
+
+private:
+    wrapper_stats & stats_;
+    std::int64_t bytes_;
+    std::int64_t external_;
+};
+
+} // end ns
+
+#endif // __NODE_MAPNIK_MEMORY_STATS_H__
@@ -4,6 +4,7 @@
 // node-mapnik
 #include "mapnik_vector_tile.hpp"
 #include "mapnik_map.hpp"
+#include "mapnik_map_pool.hpp"
 #include "mapnik_color.hpp"
 #include "mapnik_geometry.hpp"
 #include "mapnik_logger.hpp"
@@ -26,6 +27,10 @@
 #include "mapnik_expression.hpp"
 #include "utils.hpp"
 #include "blend.hpp"
+#include "memory_stats.hpp"
+#include "mapnik_shared_store.hpp"
+#include "async_metrics.hpp"
+#include "job_scheduler.hpp"
 
 // mapnik
 #include <mapnik/config.hpp> // for MAPNIK_DECL
@@ -45,9 +50,115 @@
 
 // std
 #include <future>
+#include <mutex>
+
+#if !defined(_WIN32)
+#include <dirent.h>
+#endif
+#include <sys/stat.h>
 
 namespace node_mapnik {
 
+namespace {
+
+std::mutex plugin_defer_mutex;
+
+std::vector<std::string> & pending_plugin_dirs()
+{
+    static std::vector<std::string> dirs;
+    return dirs;
+}
+
+// enumerates <name>.input files in a directory without loading them
+std::vector<std::string> scan_plugin_names(std::string const& dir)
+{
+    std::vector<std::string> names;
+#if defined(_WIN32)
+    // deferred registration is primarily a unix cold-start optimization;
+    // on windows fall back to enumerating nothing so callers register
+    // eagerly instead of reporting stale availability
+    (void)dir;
+#else
+    DIR * handle = opendir(dir.c_str());
+    if (handle == nullptr) return names;
+    const std::string suffix = ".input";
+    struct dirent * entry;
+    while ((entry = readdir(handle)) != nullptr)
+    {
+        std::string name = entry->d_name;
+        if (name.size() > suffix.size() &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+        {
+            names.push_back(name.substr(0, name.size() - suffix.size()));
+        }
+    }
+    closedir(handle);
+#endif
+    return names;
+}
+
+} // anonymous namespace
+
+bool defer_plugin_dir(std::string const& path)
+{
+    std::vector<std::string> names = scan_plugin_names(path);
+    if (names.empty())
+    {
+        // nothing to defer - register eagerly so behavior matches the
+        // non-deferred call for missing or empty directories
+        std::size_t before = mapnik::datasource_cache::instance().plugin_names().size();
+        mapnik::datasource_cache::instance().register_datasources(path);
+        return mapnik::datasource_cache::instance().plugin_names().size() > before;
+    }
+    std::lock_guard<std::mutex> lock(plugin_defer_mutex);
+    pending_plugin_dirs().push_back(path);
+    return true;
+}
+
+void ensure_plugins_registered(std::string const& type_hint)
+{
+    std::vector<std::string> dirs;
+    {
+        std::lock_guard<std::mutex> lock(plugin_defer_mutex);
+        if (pending_plugin_dirs().empty()) return;
+        if (!type_hint.empty())
+        {
+            // load just the hinted plugin when one of the deferred
+            // directories provides it; the directory stays deferred for
+            // the plugins that were not needed yet
+            for (std::string const& dir : pending_plugin_dirs())
+            {
+                std::string file = dir + "/" + type_hint + ".input";
+                struct stat st;
+                if (stat(file.c_str(), &st) == 0)
+                {
+                    mapnik::datasource_cache::instance().register_datasource(file);
+                    return;
+                }
+            }
+        }
+        dirs.swap(pending_plugin_dirs());
+    }
+    for (std::string const& dir : dirs)
+    {
+        mapnik::datasource_cache::instance().register_datasources(dir);
+    }
+}
+
+std::vector<std::string> pending_plugin_names()
+{
+    std::vector<std::string> names;
+    std::lock_guard<std::mutex> lock(plugin_defer_mutex);
+    for (std::string const& dir : pending_plugin_dirs())
+    {
+        for (std::string const& name : scan_plugin_names(dir))
+        {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
 
 
 
@@ -58,6 +169,132 @@ static std::string format_version(int version)
     return s.str();
 }
 
+/**
+ * Report live wrapper object counts and native byte totals that are
+ * invisible to V8's heap statistics: vector tile buffers, image pixel
+ * data and grid arrays. Byte totals for tiles refresh on every tile
+ * mutation; images and grids are measured at construction.
+ *
+ * @name memoryStats
+ * @memberof mapnik
+ * @returns {Object} per-class {count, bytes} totals
+ */
+/**
+ * Aggregate queue and execution timing for the addon's async operations
+ * (renders, tile ingest, getData, query, composite, image encode),
+ * stamped with monotonic clocks in the work batons. Queue time is how
+ * long a job waited for a threadpool slot; execution time is the worker
+ * body. Pass {reset: true} to drain the aggregates after reading.
+ *
+ * @name metrics
+ * @memberof mapnik
+ * @param {Object} [options] options with a `reset` key
+ * @returns {Object} per-operation {count, queue_ms_total, queue_ms_max,
+ * exec_ms_total, exec_ms_max}
+ */
+static NAN_METHOD(metrics)
+{
+    bool reset = false;
+    if (info.Length() > 0)
+    {
+        if (!info[0]->IsObject())
+        {
+            Nan::ThrowTypeError("optional first argument must be an options object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[0]->ToObject();
+        if (options->Has(Nan::New("reset").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("reset").ToLocalChecked());
+            if (!param_val->IsBoolean())
+            {
+                Nan::ThrowTypeError("'reset' must be a Boolean");
+                return;
+            }
+            reset = param_val->BooleanValue();
+        }
+    }
+    std::map<std::string, node_mapnik::async_metrics::op_stats> snapshot =
+        node_mapnik::async_metrics::instance().snapshot(reset);
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    for (auto const& entry : snapshot)
+    {
+        v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+        obj->Set(Nan::New("count").ToLocalChecked(),
+                 Nan::New<v8::Number>(static_cast<double>(entry.second.count)));
+        obj->Set(Nan::New("queue_ms_total").ToLocalChecked(),
+                 Nan::New<v8::Number>(entry.second.queue_ns_total / 1e6));
+        obj->Set(Nan::New("queue_ms_max").ToLocalChecked(),
+                 Nan::New<v8::Number>(entry.second.queue_ns_max / 1e6));
+        obj->Set(Nan::New("exec_ms_total").ToLocalChecked(),
+                 Nan::New<v8::Number>(entry.second.exec_ns_total / 1e6));
+        obj->Set(Nan::New("exec_ms_max").ToLocalChecked(),
+                 Nan::New<v8::Number>(entry.second.exec_ns_max / 1e6));
+        result->Set(Nan::New<v8::String>(entry.first).ToLocalChecked(), obj);
+    }
+    info.GetReturnValue().Set(result);
+}
+
+static NAN_METHOD(memoryStats)
+{
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    struct { const char * name; node_mapnik::wrapper_stats & stats; } entries[] = {
+        { "vectorTile", node_mapnik::vector_tile_stats() },
+        { "image", node_mapnik::image_stats() },
+        { "grid", node_mapnik::grid_stats() },
+    };
+    for (auto const& entry : entries)
+    {
+        v8::Local<v8::Object> obj = Nan::New<v8::Object>();
+        obj->Set(Nan::New("count").ToLocalChecked(),
+                 Nan::New<v8::Number>(static_cast<double>(entry.stats.count.load(std::memory_order_relaxed))));
+        obj->Set(Nan::New("bytes").ToLocalChecked(),
+                 Nan::New<v8::Number>(static_cast<double>(entry.stats.bytes.load(std::memory_order_relaxed))));
+        result->Set(Nan::New(entry.name).ToLocalChecked(), obj);
+    }
+    info.GetReturnValue().Set(result);
+}
+
+/**
+ * Configure or inspect the scheduler that dispatches render jobs onto
+ * the libuv threadpool. Operations tagged with a `priority` option
+ * occupy at most `concurrency` threadpool slots; work beyond that is
+ * parked and released highest priority first. The threadpool size
+ * itself is controlled by libuv's UV_THREADPOOL_SIZE.
+ *
+ * @name threadPool
+ * @memberof mapnik
+ * @param {Object} [options] options with a `concurrency` key
+ * @returns {Object} the current configuration
+ */
+static NAN_METHOD(threadPool)
+{
+    if (info.Length() > 0)
+    {
+        if (!info[0]->IsObject())
+        {
+            Nan::ThrowTypeError("optional first argument must be an options object");
+            return;
+        }
+        v8::Local<v8::Object> options = info[0]->ToObject();
+        if (options->Has(Nan::New("concurrency").ToLocalChecked()))
+        {
+            v8::Local<v8::Value> param_val = options->Get(Nan::New("concurrency").ToLocalChecked());
+            if (!param_val->IsNumber() || param_val->IntegerValue() < 1)
+            {
+                Nan::ThrowTypeError("option 'concurrency' must be a positive integer");
+                return;
+            }
+            node_mapnik::job_scheduler::instance().set_concurrency(
+                static_cast<unsigned>(param_val->IntegerValue()));
+        }
+    }
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    result->Set(Nan::New("concurrency").ToLocalChecked(),
+                Nan::New<v8::Integer>(static_cast<int>(node_mapnik::job_scheduler::instance().get_concurrency())));
+    info.GetReturnValue().Set(result);
+}
+
 static NAN_METHOD(clearCache)
 {
     Nan::HandleScope scope;
@@ -65,6 +302,8 @@ static NAN_METHOD(clearCache)
     mapnik::marker_cache::instance().clear();
     mapnik::mapped_memory_cache::instance().clear();
 #endif
+    Map::clear_style_cache();
+    Image::clear_image_cache();
     return;
 }
 
@@ -105,10 +344,17 @@ extern "C" {
         Nan::SetMethod(target, "fontFiles", node_mapnik::available_font_files);
         Nan::SetMethod(target, "memoryFonts", node_mapnik::memory_fonts);
         Nan::SetMethod(target, "clearCache", clearCache);
+        Nan::SetMethod(target, "memoryStats", memoryStats);
+        Nan::SetMethod(target, "metrics", metrics);
+        Nan::SetMethod(target, "threadPool", threadPool);
+        Nan::SetMethod(target, "publishSharedTile", node_mapnik::publish_shared_tile);
+        Nan::SetMethod(target, "readSharedTile", node_mapnik::read_shared_tile);
+        Nan::SetMethod(target, "removeSharedTile", node_mapnik::remove_shared_tile);
 
         // Classes
         VectorTile::Initialize(target);
         Map::Initialize(target);
+        MapPool::Initialize(target);
         Color::Initialize(target);
         Geometry::Initialize(target);
         Feature::Initialize(target);
@@ -0,0 +1,115 @@
+#ifndef __NODE_MAPNIK_OUTPUT_BUFFER_POOL_H__
+#define __NODE_MAPNIK_OUTPUT_BUFFER_POOL_H__
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wshadow"
+#include <nan.h>
+#pragma GCC diagnostic pop
+
+// stl
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace node_mapnik {
+
+// Recycles encode output buffers across calls. Encoders write into a
+// string acquired from the pool (keeping the capacity a previous encode
+// grew), the finished string is handed to v8 zero-copy, and the buffer's
+// free callback returns the storage here once v8 collects it - so a
+// steady encode workload stops paying a fresh allocation and a full
+// output copy per tile.
+class output_buffer_pool
+{
+public:
+    static output_buffer_pool& instance()
+    {
+        static output_buffer_pool pool;
+        return pool;
+    }
+
+    std::string acquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty())
+        {
+            std::string buffer = std::move(idle_.back());
+            idle_.pop_back();
+            buffer.clear();
+            return buffer;
+        }
+        return std::string();
+    }
+
+    void release(std::string && buffer)
+    {
+        // don't hoard unusually large slabs
+        if (buffer.capacity() > max_retained_capacity) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() < max_idle)
+        {
+            idle_.push_back(std::move(buffer));
+        }
+    }
+
+private:
+    output_buffer_pool() = default;
+    static const std::size_t max_idle = 16;
+    static const std::size_t max_retained_capacity = 8 * 1024 * 1024;
+    std::mutex mutex_;
+    std::vector<std::string> idle_;
+};
+
+// minimal streambuf appending to a caller-owned string, so encoders that
+// write through std::ostream land directly in a pooled buffer
+struct string_sink_buf : public std::streambuf
+{
+    explicit string_sink_buf(std::string & out) :
+        out_(out) {}
+
+    std::streamsize xsputn(const char* s, std::streamsize n)
+    {
+        out_.append(s, static_cast<std::size_t>(n));
+        return n;
+    }
+
+    int overflow(int c)
+    {
+        if (c != EOF)
+        {
+            out_.push_back(static_cast<char>(c));
+        }
+        return c;
+    }
+
+    std::string & out_;
+};
+
+namespace detail {
+
+inline void release_pooled_buffer(char*, void* hint)
+{
+    std::string * buffer = static_cast<std::string*>(hint);
+    output_buffer_pool::instance().release(std::move(*buffer));
+    delete buffer;
+}
+
+} // end ns detail
+
+// hands encoded bytes to v8 without copying; the storage goes back to
+// the pool when v8 collects the Buffer
+inline v8::Local<v8::Object> pooled_buffer_to_v8(std::string && encoded)
+{
+    std::string * result = new std::string(std::move(encoded));
+    return Nan::NewBuffer(const_cast<char*>(result->data()),
+                          result->size(),
+                          detail::release_pooled_buffer,
+                          result).ToLocalChecked();
+}
+
+} // end ns
+
+#endif // __NODE_MAPNIK_OUTPUT_BUFFER_POOL_H__
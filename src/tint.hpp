@@ -2,7 +2,10 @@
 #define NODE_BLEND_SRC_TINT_H
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 static inline void rgb_to_hsl(unsigned red, unsigned green, unsigned blue,
              double & h, double & s, double & l) {
@@ -84,5 +87,93 @@ struct Tinter {
     }
 };
 
+static inline void TintPixel(unsigned & r,
+                             unsigned & g,
+                             unsigned & b,
+                             Tinter const& tint) {
+    double h;
+    double s;
+    double l;
+    rgb_to_hsl(r,g,b,h,s,l);
+    double h2 = tint.h0 + (h * (tint.h1 - tint.h0));
+    double s2 = tint.s0 + (s * (tint.s1 - tint.s0));
+    double l2 = tint.l0 + (l * (tint.l1 - tint.l0));
+    if (h2 > 1) h2 = 1;
+    if (h2 < 0) h2 = 0;
+    if (s2 > 1) s2 = 1;
+    if (s2 < 0) s2 = 0;
+    if (l2 > 1) l2 = 1;
+    if (l2 < 0) l2 = 0;
+    hsl_to_rgb(h2,s2,l2,r,g,b);
+}
+
+// full per-pixel tint transform: alpha rescale plus hsl adjustment,
+// matching the per-pixel path in Blend_Composite exactly
+static inline unsigned int tint_one_pixel(unsigned int source_pixel,
+                                          Tinter const& tint,
+                                          bool tinting,
+                                          bool set_alpha) {
+    unsigned a = (source_pixel >> 24) & 0xff;
+    if (set_alpha) {
+        double a2 = tint.a0 + (a/255.0 * (tint.a1 - tint.a0));
+        if (a2 < 0) a2 = 0;
+        a = static_cast<unsigned>(std::floor((a2 * 255.0)+.5));
+        if (a > 255) a = 255;
+    }
+    unsigned r = source_pixel & 0xff;
+    unsigned g = (source_pixel >> 8 ) & 0xff;
+    unsigned b = (source_pixel >> 16) & 0xff;
+    if (a > 1 && tinting) {
+        TintPixel(r,g,b,tint);
+    }
+    return (a << 24) | (b << 16) | (g << 8) | (r);
+}
+
+// Batch tinting kernel. The transform is a pure function of the source
+// pixel, and typical tinted inputs (hillshades, monochrome rasters) only
+// contain a few hundred distinct colors, so results are memoized in a
+// small open-addressing table and the double-precision hsl round trip
+// runs once per distinct color instead of once per pixel. An identity
+// Tinter returns immediately without touching the pixels.
+static inline void tint_image_pixels(unsigned int * pixels,
+                                     std::size_t count,
+                                     Tinter const& tint) {
+    bool tinting = !tint.is_identity();
+    bool set_alpha = !tint.is_alpha_identity();
+    if (!tinting && !set_alpha) return;
+    static const std::size_t table_size = 1 << 13;
+    static const std::size_t max_probes = 4;
+    // slot layout: source pixel in the high half, result in the low half;
+    // all-ones marks an empty slot (one source value aliases it and is
+    // simply recomputed each time)
+    static const std::uint64_t empty = ~0ull;
+    std::vector<std::uint64_t> slots(table_size, empty);
+    for (std::size_t i = 0; i < count; ++i) {
+        unsigned int const src = pixels[i];
+        std::size_t slot = static_cast<std::size_t>(
+            (static_cast<std::uint64_t>(src) * 0x9E3779B97F4A7C15ULL) >> 51) & (table_size - 1);
+        bool done = false;
+        for (std::size_t probe = 0; probe < max_probes; ++probe) {
+            std::uint64_t const entry = slots[slot];
+            if (entry == empty) {
+                unsigned int const out = tint_one_pixel(src, tint, tinting, set_alpha);
+                slots[slot] = (static_cast<std::uint64_t>(src) << 32) | out;
+                pixels[i] = out;
+                done = true;
+                break;
+            }
+            if ((entry >> 32) == src) {
+                pixels[i] = static_cast<unsigned int>(entry & 0xFFFFFFFFULL);
+                done = true;
+                break;
+            }
+            slot = (slot + 1) & (table_size - 1);
+        }
+        if (!done) {
+            pixels[i] = tint_one_pixel(src, tint, tinting, set_alpha);
+        }
+    }
+}
+
 
 #endif
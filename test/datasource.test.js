@@ -28,6 +28,35 @@ describe('mapnik.Datasource', function() {
             /Shape Plugin: missing <file> parameter/);
     });
 
+    it('should pull features in batches', function(done) {
+        var options = {
+            type: 'shape',
+            file: './test/data/world_merc.shp'
+        };
+        var ds = new mapnik.Datasource(options);
+        var featureset = ds.featureset();
+        assert.throws(function() { featureset.nextBatch(); });
+        assert.throws(function() { featureset.nextBatch(0); });
+        assert.throws(function() { featureset.nextBatch('many'); });
+        var first = featureset.nextBatch(100);
+        assert.equal(first.length, 100);
+        assert.equal(typeof first[0].id, 'number');
+        assert.equal(first[0].attributes.NAME, 'Antigua and Barbuda');
+        var total = first.length;
+        function drain() {
+            featureset.nextBatch(100, function(err, batch) {
+                assert.ifError(err);
+                total += batch.length;
+                if (batch.length === 0) {
+                    assert.equal(total, 245);
+                    return done();
+                }
+                drain();
+            });
+        }
+        drain();
+    });
+
     it('should validate with known shapefile - ogr', function() {
         var options = {
             type: 'ogr',
@@ -174,6 +203,51 @@ describe('mapnik.Datasource', function() {
         assert.equal(false, ds.add({}));
     });
 
+    it('should cache describe results until invalidated', function() {
+        var options = {
+            type: 'shape',
+            file: './test/data/world_merc.shp'
+        };
+        var ds = new mapnik.Datasource(options);
+        var first = ds.describe();
+        // second call is served from the cached native snapshot
+        assert.deepEqual(ds.describe(), first);
+        assert.deepEqual(ds.fields(), first.fields);
+        ds.invalidate();
+        assert.deepEqual(ds.describe(), first);
+    });
+
+    it('test bulk loading geojson into a memory datasource', function(done) {
+        var ds = new mapnik.MemoryDatasource({'extent': '-180,-90,180,90'});
+        assert.throws(function() { ds.addGeoJSON(); });
+        assert.throws(function() { ds.addGeoJSON(null); });
+        assert.throws(function() { ds.addGeoJSON('not geojson'); });
+        var collection = {
+            type: 'FeatureCollection',
+            features: [
+                { type: 'Feature', geometry: { type: 'Point', coordinates: [0, 0] }, properties: { name: 'a' } },
+                { type: 'Feature', geometry: { type: 'Point', coordinates: [1, 1] }, properties: { name: 'b' } },
+                { type: 'Feature', geometry: { type: 'Point', coordinates: [2, 2] }, properties: { name: 'c' } }
+            ]
+        };
+        assert.equal(3, ds.addGeoJSON(JSON.stringify(collection)));
+        var featureset = ds.featureset();
+        var count = 0;
+        var feature;
+        while ((feature = featureset.next())) ++count;
+        assert.equal(count, 3);
+        // async form from a Buffer, appending to the same datasource
+        ds.addGeoJSON(new Buffer(JSON.stringify(collection)), function(err, added) {
+            assert.ifError(err);
+            assert.equal(added, 3);
+            var fs2 = ds.featureset();
+            var total = 0;
+            while ((feature = fs2.next())) ++total;
+            assert.equal(total, 6);
+            done();
+        });
+    });
+
     it('test valid use of memory datasource', function() {
         var ds = new mapnik.MemoryDatasource({'extent': '-180,-90,180,90'});
         assert.equal(true, ds.add({ 'x': 0, 'y': 0 }));
@@ -47,5 +47,23 @@ describe('mapnik.Expression', function() {
         assert.equal(expr.evaluate(feature, options), true);
         assert.equal(expr.evaluate(feature, options).toString(), 'true');
     });
-});
 
+    it('should cache parsed expressions by source string', function() {
+        mapnik.Expression.clearCache();
+        assert.equal(mapnik.Expression.cacheSize(), 0);
+        var expr1 = new mapnik.Expression('[cached_attr]>1');
+        assert.equal(mapnik.Expression.cacheSize(), 1);
+        // repeat construction reuses the compiled tree
+        var expr2 = new mapnik.Expression('[cached_attr]>1');
+        assert.equal(mapnik.Expression.cacheSize(), 1);
+        assert.equal(expr1.toString(), expr2.toString());
+        var feature = new mapnik.Feature.fromJSON('{"type":"Feature","properties":{"cached_attr":2},"geometry":null}');
+        assert.equal(expr1.evaluate(feature), true);
+        assert.equal(expr2.evaluate(feature), true);
+        // parse failures must not be cached
+        assert.throws(function() { new mapnik.Expression('[unclosed'); });
+        assert.equal(mapnik.Expression.cacheSize(), 1);
+        mapnik.Expression.clearCache();
+        assert.equal(mapnik.Expression.cacheSize(), 0);
+    });
+});
@@ -80,6 +80,21 @@ describe('mapnik.Feature ', function() {
         assert.equal(count, 245);
     });
 
+    it('should lazily get single attributes', function() {
+        var options = {
+            type: 'shape',
+            file: './test/data/world_merc.shp'
+        };
+        var ds = new mapnik.Datasource(options);
+        var feature = ds.featureset().next();
+        assert.throws(function() { feature.get(); });
+        assert.throws(function() { feature.get(1); });
+        assert.equal(feature.get('NAME'), 'Antigua and Barbuda');
+        assert.equal(feature.get('POP2005'), 83039);
+        assert.equal(feature.get('LAT'), 17.078);
+        assert.equal(feature.get('doesnotexist'), undefined);
+    });
+
     it('should report null values as js null',function() {
         var extent = '-180,-60,180,60';
         var ds = new mapnik.MemoryDatasource({'extent': extent});
@@ -31,6 +31,17 @@ describe('map local fonts ', function() {
         assert.equal(map.fonts().indexOf('DejaVu Serif Condensed Bold Italic'),0);
         done();
     });
+    it('repeated registration of a directory reuses the first scan', function(done) {
+        var map1 = new mapnik.Map(4, 4);
+        assert.equal(map1.registerFonts('./test/data/map-b/', {recurse:false}), true);
+        // a second map registering the same directory merges the cached
+        // mapping without rescanning the filesystem
+        var map2 = new mapnik.Map(4, 4);
+        assert.equal(map2.registerFonts('./test/data/map-b/', {recurse:false}), true);
+        assert.deepEqual(map2.fonts(), map1.fonts());
+        assert.deepEqual(map2.fontFiles(), map1.fontFiles());
+        done();
+    });
 });
 
 describe('font scope', function() {
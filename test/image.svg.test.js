@@ -114,6 +114,28 @@ describe('mapnik.Image SVG', function() {
       });
     });
 
+    it('should serve repeated svg rasterizations from the cache', function(done) {
+        var fs = require('fs');
+        var buffer = fs.readFileSync('./test/data/vector_tile/tile0.expected-svg.svg');
+        var cold = mapnik.Image.fromSVGBytesSync(buffer);
+        // second rasterization of the same bytes and scale is a cache hit
+        var warm = mapnik.Image.fromSVGBytesSync(buffer);
+        assert.equal(cold.compare(warm), 0);
+        // cached copies are independent
+        warm.fill(new mapnik.Color('red'));
+        var warm2 = mapnik.Image.fromSVGBytesSync(buffer);
+        assert.equal(cold.compare(warm2), 0);
+        // a different scale is a different cache entry
+        var scaled = mapnik.Image.fromSVGBytesSync(buffer, {scale: 2});
+        assert.equal(scaled.width(), cold.width() * 2);
+        mapnik.Image.fromSVGBytes(buffer, function(err, img) {
+            assert.ifError(err);
+            assert.equal(cold.compare(img), 0);
+            mapnik.clearCache();
+            done();
+        });
+    });
+
     it('#fromSVGSync load from SVG file', function() {
         var img = mapnik.Image.fromSVGSync('./test/data/vector_tile/tile0.expected-svg.svg');
         assert.ok(img);
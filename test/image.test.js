@@ -596,7 +596,7 @@ describe('mapnik.Image ', function() {
         assert.throws(function() { var im = new mapnik.Image.openSync('./test/data/markers.xml'); });
         assert.throws(function() { var im = new mapnik.Image.openSync('./test/images/corrupt-10x10.png'); });
         assert.throws(function() { var im = new mapnik.Image.open(null, function(err, result) {}); });
-        assert.throws(function() { var im = new mapnik.Image.open('./test/images/10x10.png', null); });
+        assert.throws(function() { var im = new mapnik.Image.open('./test/data/images/10x10.png', null); });
         mapnik.Image.open('./PATH/FILE_DOES_NOT_EXIST.tiff', function(err, result) {
             assert.throws(function() { if (err) throw err; });
             mapnik.Image.open('./test/data/markers.xml', function(err, result) {
@@ -609,6 +609,78 @@ describe('mapnik.Image ', function() {
         });
     });
 
+    it('should resize in parallel row bands', function(done) {
+        var im = new mapnik.Image(512, 512);
+        im.fill(new mapnik.Color('rgba(0,255,0,1)'));
+        im.premultiplySync();
+        assert.throws(function() { im.resize(64, 64, {threads: 0}, function(err, result) {}); });
+        im.resize(64, 64, function(err, single) {
+            assert.ifError(err);
+            im.resize(64, 64, {threads: 4}, function(err, banded) {
+                assert.ifError(err);
+                // banded output must match the single-pass resize exactly
+                assert.equal(single.compare(banded), 0);
+                assert.equal(banded.width(), 64);
+                assert.equal(banded.height(), 64);
+                done();
+            });
+        });
+    });
+
+    it('should alias pixel data with data({alias: true})', function() {
+        var im = new mapnik.Image(4, 4);
+        im.fill(new mapnik.Color('blue'));
+        assert.throws(function() { im.data(null); });
+        assert.throws(function() { im.data({alias: 1}); });
+        var copy = im.data();
+        var aliased = im.data({alias: true});
+        assert.equal(aliased.length, copy.length);
+        assert.equal(aliased.toString('hex'), copy.toString('hex'));
+        // writes through the alias land in the image itself
+        var view = new Uint32Array(aliased.buffer, aliased.byteOffset, aliased.length / 4);
+        view[0] = 0xff0000ff; // ABGR: opaque red
+        var px = im.getPixel(0, 0, {get_color: true});
+        assert.equal(px.r, 255);
+        assert.equal(px.g, 0);
+        assert.equal(px.b, 0);
+        // the plain form stays a copy
+        copy.fill(0);
+        assert.equal(im.getPixel(0, 0, {get_color: true}).r, 255);
+    });
+
+    it('should account for native image memory in memoryStats', function() {
+        var before = mapnik.memoryStats();
+        assert.equal(typeof before.image.count, 'number');
+        assert.equal(typeof before.image.bytes, 'number');
+        assert.equal(typeof before.vectorTile.count, 'number');
+        assert.equal(typeof before.grid.count, 'number');
+        var im = new mapnik.Image(256, 256);
+        var after = mapnik.memoryStats();
+        assert.equal(after.image.count, before.image.count + 1);
+        // rgba8 256x256 = 256KB of pixel data
+        assert.equal(after.image.bytes - before.image.bytes, 256 * 256 * 4);
+        assert.ok(im);
+    });
+
+    it('should open through the decoded image cache', function(done) {
+        assert.throws(function() { mapnik.Image.openSync('./test/data/images/10x10.png', {cache: 1}); });
+        // first open decodes and populates the cache, second is a copy
+        var im1 = mapnik.Image.openSync('./test/data/images/10x10.png', {cache: true});
+        var im2 = mapnik.Image.openSync('./test/data/images/10x10.png', {cache: true});
+        assert.equal(im1.compare(im2), 0);
+        // cached opens must be independent copies
+        im2.fill(new mapnik.Color('red'));
+        var im3 = mapnik.Image.openSync('./test/data/images/10x10.png', {cache: true});
+        assert.equal(im1.compare(im3), 0);
+        assert.ok(im2.compare(im3) > 0);
+        mapnik.Image.open('./test/data/images/10x10.png', {cache: true}, function(err, im4) {
+            assert.ifError(err);
+            assert.equal(im1.compare(im4), 0);
+            mapnik.clearCache();
+            done();
+        });
+    });
+
     it('should be able to open and save jpeg', function(done) {
         var im = new mapnik.Image(10,10);
         im.fill(new mapnik.Color('green'));
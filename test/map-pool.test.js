@@ -0,0 +1,94 @@
+"use strict";
+
+var mapnik = require('../');
+var assert = require('assert');
+var path = require('path');
+
+mapnik.register_datasource(path.join(mapnik.settings.paths.input_plugins,'shape.input'));
+
+describe('mapnik.MapPool', function() {
+    it('should throw with invalid usage', function() {
+        // no 'new' keyword
+        assert.throws(function() { mapnik.MapPool(); });  // jshint ignore:line
+
+        // invalid args
+        assert.throws(function() { new mapnik.MapPool(); });
+        assert.throws(function() { new mapnik.MapPool('foo'); });
+        assert.throws(function() { new mapnik.MapPool({}); });
+        assert.throws(function() { new mapnik.MapPool(new mapnik.Map(256, 256), 'baz'); });
+        assert.throws(function() { new mapnik.MapPool(new mapnik.Map(256, 256), {size: 0}); });
+        assert.throws(function() { new mapnik.MapPool(new mapnik.Map(256, 256), {size: 'many'}); });
+        var pool = new mapnik.MapPool(new mapnik.Map(256, 256));
+        assert.throws(function() { pool.acquire(); });
+        assert.throws(function() { pool.release(); });
+        assert.throws(function() { pool.release('foo'); });
+    });
+
+    it('should report size and availability', function() {
+        var map = new mapnik.Map(256, 256);
+        var pool = new mapnik.MapPool(map, {size: 3});
+        assert.equal(pool.size, 3);
+        assert.equal(pool.available, 3);
+    });
+
+    it('should acquire and release a map clone', function(done) {
+        var map = new mapnik.Map(256, 256);
+        map.loadSync('./test/stylesheet.xml');
+        map.zoomAll();
+        var pool = new mapnik.MapPool(map, {size: 2});
+        pool.acquire(function(err, m) {
+            assert.ifError(err);
+            assert.ok(m instanceof mapnik.Map);
+            // clone carries the master's layers and can render independently
+            assert.equal(m.layers().length, map.layers().length);
+            assert.equal(pool.available, 1);
+            pool.release(m);
+            assert.equal(pool.available, 2);
+            // releasing the same map twice is an error
+            assert.throws(function() { pool.release(m); });
+            done();
+        });
+    });
+
+    it('should queue acquires beyond pool size until release', function(done) {
+        var map = new mapnik.Map(256, 256);
+        var pool = new mapnik.MapPool(map, {size: 1});
+        pool.acquire(function(err, m1) {
+            assert.ifError(err);
+            var waited = false;
+            pool.acquire(function(err, m2) {
+                assert.ifError(err);
+                waited = true;
+                pool.release(m2);
+                assert.equal(pool.available, 1);
+                done();
+            });
+            setImmediate(function() {
+                assert.equal(waited, false);
+                pool.release(m1);
+            });
+        });
+    });
+
+    it('should render concurrently from separate clones', function(done) {
+        var map = new mapnik.Map(256, 256);
+        map.loadSync('./test/stylesheet.xml');
+        map.zoomAll();
+        var pool = new mapnik.MapPool(map, {size: 2});
+        var remaining = 2;
+        function render_one() {
+            pool.acquire(function(err, m) {
+                assert.ifError(err);
+                m.zoomAll();
+                m.render(new mapnik.Image(256, 256), function(err, im) {
+                    assert.ifError(err);
+                    assert.ok(im instanceof mapnik.Image);
+                    pool.release(m);
+                    if (--remaining === 0) done();
+                });
+            });
+        }
+        render_one();
+        render_one();
+    });
+});
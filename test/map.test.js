@@ -220,6 +220,64 @@ describe('mapnik.Map', function() {
         assert.equal(layers2.length, 0);
     });
 
+    it('should load a stylesheet sync from the style cache', function() {
+        var map = new mapnik.Map(600, 400);
+        assert.throws(function() { map.loadSync('./test/stylesheet.xml', {cache: 12 }); });
+
+        // first load parses and populates the cache, second load copies
+        map.loadSync('./test/stylesheet.xml', {cache: true});
+        var map2 = new mapnik.Map(512, 512);
+        map2.loadSync('./test/stylesheet.xml', {cache: true});
+        assert.equal(map.toXML(), map2.toXML());
+
+        // a cached load keeps the target's own dimensions
+        assert.equal(map2.width, 512);
+        assert.equal(map2.height, 512);
+
+        // cached loads must be independent copies
+        map2.clear();
+        assert.equal(map2.layers().length, 0);
+        assert.equal(map.layers().length, 1);
+
+        // a fresh uncached load is unaffected by the cache
+        var map3 = new mapnik.Map(600, 400);
+        map3.loadSync('./test/stylesheet.xml');
+        assert.equal(map.toXML(), map3.toXML());
+
+        // loading through a map that already carries other layers must
+        // not leak those layers into the cached stylesheet entry
+        mapnik.clearCache();
+        var dirty = new mapnik.Map(600, 400);
+        dirty.loadSync('./test/data/roads.xml', {cache: true});
+        dirty.loadSync('./test/stylesheet.xml', {cache: true});
+        assert.ok(dirty.layers().length > map3.layers().length);
+        var map4 = new mapnik.Map(600, 400);
+        map4.loadSync('./test/stylesheet.xml', {cache: true});
+        assert.equal(map4.toXML(), map3.toXML());
+
+        // warm cached loads append like load_map does
+        var map5 = new mapnik.Map(600, 400);
+        map5.loadSync('./test/data/roads.xml', {cache: true});
+        map5.loadSync('./test/stylesheet.xml', {cache: true});
+        assert.equal(map5.toXML(), dirty.toXML());
+        mapnik.clearCache();
+    });
+
+    it('should load a stylesheet async from the style cache', function(done) {
+        var map = new mapnik.Map(600, 400);
+        assert.throws(function() { map.load('./test/stylesheet.xml', {cache: 12}, function(err,map) {}); });
+        map.load('./test/stylesheet.xml', {cache: true}, function(err, m) {
+            assert.ifError(err);
+            var map2 = new mapnik.Map(600, 400);
+            map2.load('./test/stylesheet.xml', {cache: true}, function(err, m2) {
+                assert.ifError(err);
+                assert.equal(m.toXML(), m2.toXML());
+                mapnik.clearCache();
+                done();
+            });
+        });
+    });
+
     it('should load fromString sync', function() {
         var map = new mapnik.Map(4, 4);
         var s = '<Map>';
@@ -22,6 +22,52 @@ describe('mapnik rendering ', function() {
         });
     });
 
+    it('should render to file in streamed bands', function(done) {
+        var filename = './test/tmp/renderFileBanded.png';
+        var map = new mapnik.Map(600, 400);
+        map.loadSync('./test/stylesheet.xml');
+        map.zoomAll();
+        assert.throws(function() { map.renderFile(filename, {bands: 0}, function(err) {}); });
+        assert.throws(function() { map.renderFile(filename, {bands: 4, format: 'jpeg'}, function(err) {}); });
+        map.renderFile(filename, {bands: 4}, function(err) {
+            assert.ok(!err);
+            assert.ok(exists(filename));
+            // banded output decodes to the full canvas
+            var banded = mapnik.Image.openSync(filename);
+            assert.equal(banded.width(), 600);
+            assert.equal(banded.height(), 400);
+            done();
+        });
+    });
+
+    it('should render a metatile and slice it into encoded tiles', function(done) {
+        var map = new mapnik.Map(512, 512);
+        map.loadSync('./test/stylesheet.xml');
+        map.zoomAll();
+        assert.throws(function() { map.renderMetatile(); });
+        assert.throws(function() { map.renderMetatile({tile_size: 0}, function(err, buffers) {}); });
+        assert.throws(function() { map.renderMetatile({tile_size: 100}, function(err, buffers) {}); });
+        assert.throws(function() { map.renderMetatile({format: 1}, function(err, buffers) {}); });
+        map.renderMetatile({tile_size: 256, format: 'png'}, function(err, buffers) {
+            assert.ok(!err);
+            assert.equal(buffers.length, 4);
+            buffers.forEach(function(buffer) {
+                assert.ok(Buffer.isBuffer(buffer));
+                var im = new mapnik.Image.fromBytesSync(buffer);
+                assert.equal(im.width(), 256);
+                assert.equal(im.height(), 256);
+            });
+            // sub-tiles must match views of a full render
+            map.render(new mapnik.Image(512, 512), function(err, full) {
+                assert.ok(!err);
+                var view_tile = new mapnik.Image.fromBytesSync(buffers[0]);
+                var view = full.view(0, 0, 256, 256);
+                assert.equal(view_tile.compare(new mapnik.Image.fromBytesSync(view.encodeSync('png'))), 0);
+                done();
+            });
+        });
+    });
+
     it('should render async (real data)', function(done) {
         var filename = './test/tmp/renderFile2.png';
         var map = new mapnik.Map(600, 400);
@@ -62,6 +62,20 @@ describe('plugin testing', function() {
         });
     });
     
+    it('test deferred registering of datasources', function() {
+        assert.throws(function() { mapnik.register_datasources(mapnik.settings.paths.input_plugins, null); });
+        assert.throws(function() { mapnik.register_datasources(mapnik.settings.paths.input_plugins, {defer: 1}); });
+        // recording the directory must succeed and the plugin names must
+        // be enumerable without loading anything
+        assert.equal(true, mapnik.register_datasources(mapnik.settings.paths.input_plugins, {defer: true}));
+        var ds_list = mapnik.datasources();
+        assert.ok(ds_list.indexOf('shape') != -1);
+        // instantiating a datasource triggers the actual registration
+        var ds = new mapnik.Datasource({type: 'shape', file: './test/data/world_merc.shp'});
+        assert.ok(ds);
+        assert.equal(ds.type, 'vector');
+    });
+
     it('test registering of multiple datasources', function() {
         // Should register fine the first time
         // ensure shape input is registered
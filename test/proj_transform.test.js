@@ -126,6 +126,37 @@ describe('mapnik.ProjTransform ', function() {
         assert.throws(function() { trans.backward(long_lat_box); });
     });
 
-});
 
+    it('should forward many coords in place', function(done) {
+        var from = new mapnik.Projection('+init=epsg:4326');
+        var to = new mapnik.Projection('+init=epsg:3857');
+        var trans = new mapnik.ProjTransform(from,to);
+        assert.throws(function() { trans.forwardMany(); });
+        assert.throws(function() { trans.forwardMany([1,2]); });
+        assert.throws(function() { trans.forwardMany(new Float64Array([1,2,3])); });
+        var expected = trans.forward([-122.33517, 47.63752]);
+        var pairs = new Float64Array([-122.33517, 47.63752, -122.33517, 47.63752]);
+        var result = trans.forwardMany(pairs);
+        assert.strictEqual(result, pairs);
+        assert.ok(Math.abs(pairs[0] - expected[0]) < 1e-6);
+        assert.ok(Math.abs(pairs[1] - expected[1]) < 1e-6);
+        assert.ok(Math.abs(pairs[2] - expected[0]) < 1e-6);
+        assert.ok(Math.abs(pairs[3] - expected[1]) < 1e-6);
+        // round trip back, async
+        trans.backwardMany(pairs, function(err, result2) {
+            assert.ifError(err);
+            assert.ok(Math.abs(result2[0] - -122.33517) < 1e-6);
+            assert.ok(Math.abs(result2[1] - 47.63752) < 1e-6);
+            done();
+        });
+    });
 
+    it('should reuse cached transforms across instances', function() {
+        var from = new mapnik.Projection('+init=epsg:4326');
+        var to = new mapnik.Projection('+init=epsg:3857');
+        var trans1 = new mapnik.ProjTransform(from,to);
+        var trans2 = new mapnik.ProjTransform(from,to);
+        var coords = [-122.33517, 47.63752];
+        assert.deepEqual(trans1.forward(coords),trans2.forward(coords));
+    });
+});
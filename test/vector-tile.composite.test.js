@@ -418,6 +418,30 @@ describe('mapnik.VectorTile.composite', function() {
         });
     });
 
+    it('should composite with parallel sources', function(done) {
+        var coords = [0,0,0];
+        var vtile1 = new mapnik.VectorTile(coords[0],coords[1],coords[2]);
+        var vtile2 = new mapnik.VectorTile(coords[0],coords[1],coords[2]);
+        assert.throws(function() { vtile1.compositeSync([vtile2], {parallel_sources:null}); });
+        assert.throws(function() { vtile1.composite([vtile2], {parallel_sources:null}, function(err, result) {}); });
+        var vtiles = [get_tile_at('lines',coords),get_tile_at('points',coords)];
+        var expected_length = get_data_at('lines',coords).length + get_data_at('points',coords).length;
+        // same-tile sources concatenate in input order on both paths, so
+        // the parallel output must match the sequential one exactly
+        var sequential = new mapnik.VectorTile(coords[0],coords[1],coords[2]);
+        sequential.composite(vtiles,{});
+        vtile1.compositeSync(vtiles,{parallel_sources:true});
+        assert.equal(vtile1.getData().length,expected_length);
+        assert.deepEqual(vtile1.names(),sequential.names());
+        assert.equal(vtile1.getData().toString('hex'),sequential.getData().toString('hex'));
+        vtile2.composite(vtiles,{parallel_sources:true},function(err) {
+            if (err) throw err;
+            assert.deepEqual(vtile2.names(),sequential.names());
+            assert.equal(vtile2.getData().toString('hex'),sequential.getData().toString('hex'));
+            done();
+        });
+    });
+
     it('should render with image concatenation', function(done) {
         var coords = [0,0,0];
         var vtile = new mapnik.VectorTile(coords[0],coords[1],coords[2]);
@@ -75,6 +75,74 @@ describe('mapnik.VectorTile query polygon', function() {
         }
     });
 
+    it('query polygon with spatial index', function(done) {
+        assert.throws(function() { vtile.query(1,2,{index:null}); });
+        // first indexed query builds the index, second reuses it
+        check(vtile.query(139.6142578125,37.17782559332976,{tolerance:0,index:true}));
+        check(vtile.query(139.6142578125,37.17782559332976,{tolerance:0,index:true}));
+        // indexed + layer restriction
+        var layered = vtile.query(139.6142578125,37.17782559332976,{tolerance:0,index:true,layer:'world'});
+        assert.equal(layered.length,1);
+        assert.equal(layered[0].layer,'world');
+        assert.equal(layered[0].id(),89);
+        // a miss far away from any feature
+        assert.equal(vtile.query(-100,-80,{tolerance:0,index:true}).length,0);
+        vtile.query(139.6142578125,37.17782559332976,{tolerance:0,index:true}, function(err, features) {
+            assert.ifError(err);
+            check(features);
+            done();
+        });
+        function check(features) {
+            assert.equal(features.length,2);
+            assert.equal(features[0].id(),89);
+            assert.equal(features[0].distance,0);
+            assert.equal(features[0].layer,'world');
+            assert.equal(features[1].id(),89);
+            assert.equal(features[1].layer,'world2');
+        }
+    });
+
+    it('hitTest resolves pixel positions against the hit index', function(done) {
+        assert.throws(function() { vtile.hitTest(); });
+        assert.throws(function() { vtile.hitTest(1); });
+        assert.throws(function() { vtile.hitTest(1, 2, null); });
+        assert.throws(function() { vtile.hitTest(1, 2, {size: 0}); });
+        assert.throws(function() { vtile.hitTest(1, 2, {tolerance: -1}); });
+        assert.throws(function() { vtile.hitTest(1, 2, {layer: 4}); });
+        // pixel position of a known query hit: lon/lat 139.61,37.18 in
+        // tile 5/28/12 rendered at 256px
+        var merc = 20037508.342789244;
+        var tile_span = (2 * merc) / Math.pow(2, 5);
+        var tile_minx = -merc + 28 * tile_span;
+        var tile_maxy = merc - 12 * tile_span;
+        var mx = 139.6142578125 * merc / 180;
+        var lat = 37.17782559332976;
+        var my = Math.log(Math.tan((90 + lat) * Math.PI / 360)) / (Math.PI / 180) * merc / 180;
+        var px = (mx - tile_minx) / tile_span * 256;
+        var py = (tile_maxy - my) / tile_span * 256;
+        var hit = vtile.hitTest(px, py);
+        assert.ok(hit);
+        assert.equal(hit.layer, 'world');
+        assert.equal(hit.feature.id(), 89);
+        assert.equal(hit.distance, 0);
+        var layered = vtile.hitTest(px, py, {layer: 'world2'});
+        assert.equal(layered.layer, 'world2');
+        // far off the land: no hit
+        assert.equal(vtile.hitTest(0, 0), undefined);
+        done();
+    });
+
+    it('indexed query sees new data after setData', function(done) {
+        var data = fs.readFileSync(path.resolve(__dirname + "/data/vector_tile/tile3.mvt"));
+        var vtile2 = new mapnik.VectorTile(5,28,12);
+        vtile2.setData(data);
+        assert.equal(vtile2.query(139.6142578125,37.17782559332976,{tolerance:0,index:true}).length,2);
+        // replacing the data must drop the stale index
+        vtile2.setData(data);
+        assert.equal(vtile2.query(139.6142578125,37.17782559332976,{tolerance:0,index:true}).length,2);
+        done();
+    });
+
     it('query polygon + tolerance (noop)', function(done) {
         // tolerance only applies to points and lines currently in mapnik::hit_test
         check(vtile.query(142.3388671875,39.52099229357195,{tolerance:100000000000000}));
@@ -178,6 +178,44 @@ describe('mapnik.VectorTile ', function() {
         assert.throws(function() { vtile.addGeoJSON(geo_str, "layer", {simplify_distance:-0.5}); });
     });
 
+    it('should stream geojson in bounded chunks', function(done) {
+        var vtile = new mapnik.VectorTile(9,112,195);
+        vtile.setData(fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf"));
+        assert.throws(function() { vtile.toGeoJSONStream(); });
+        assert.throws(function() { vtile.toGeoJSONStream(0); });
+        assert.throws(function() { vtile.toGeoJSONStream(null, function(err,chunk) {}); });
+        assert.throws(function() { vtile.toGeoJSONStream('foo', function(err,chunk) {}); });
+        assert.throws(function() { vtile.toGeoJSONStream(-1, function(err,chunk) {}); });
+        assert.throws(function() { vtile.toGeoJSONStream(99, function(err,chunk) {}); });
+        assert.throws(function() { vtile.toGeoJSONStream(0, null, function(err,chunk) {}); });
+        assert.throws(function() { vtile.toGeoJSONStream(0, {chunk_size:1}, function(err,chunk) {}); });
+        var expected = vtile.toGeoJSONSync('__all__');
+        var chunks = [];
+        // tiny chunk size forces many chunks
+        vtile.toGeoJSONStream('__all__', {chunk_size: 1024}, function(err, chunk) {
+            assert.ifError(err);
+            if (chunk !== null) {
+                assert.ok(Buffer.isBuffer(chunk));
+                chunks.push(chunk);
+                return;
+            }
+            assert.ok(chunks.length > 1);
+            assert.equal(Buffer.concat(chunks).toString(), expected);
+            // __array__ mode streams too
+            var expected_array = vtile.toGeoJSONSync('__array__');
+            var array_chunks = [];
+            vtile.toGeoJSONStream('__array__', {chunk_size: 1024}, function(err, chunk2) {
+                assert.ifError(err);
+                if (chunk2 !== null) {
+                    array_chunks.push(chunk2);
+                    return;
+                }
+                assert.equal(Buffer.concat(array_chunks).toString(), expected_array);
+                done();
+            });
+        });
+    });
+
     it('should be able to create a vector tile from geojson', function(done) {
         var vtile = new mapnik.VectorTile(0,0,0);
         var geojson = {
@@ -989,6 +1027,46 @@ describe('mapnik.VectorTile ', function() {
         gzip.end();
     });
     
+    it('should reuse deflate contexts across getData calls with different levels', function(done) {
+        var vtile = new mapnik.VectorTile(9,112,195);
+        var data = fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf");
+        vtile.setData(data);
+        var uncompressed = vtile.getData();
+        // repeated compressions with changing parameters exercise the
+        // pooled z_stream reset/params path and must all round-trip
+        [1, 9, 1, 6].forEach(function(level) {
+            var compressed = vtile.getData({compression:'gzip', level:level});
+            assert.equal(zlib.gunzipSync(compressed).toString('hex'), uncompressed.toString('hex'));
+        });
+        vtile.getData({compression:'gzip', level:9}, function(err, compressed) {
+            assert.ifError(err);
+            assert.equal(zlib.gunzipSync(compressed).toString('hex'), uncompressed.toString('hex'));
+            done();
+        });
+    });
+
+    it('should be able to getData with alias (zero-copy)', function(done) {
+        var vtile = new mapnik.VectorTile(9,112,195);
+        var data = fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf");
+        vtile.setData(data);
+        assert.throws(function() { vtile.getData({alias:null}); });
+        assert.throws(function() { vtile.getData({alias:true, compression:'gzip'}); });
+        assert.throws(function() { vtile.getData({alias:true, compression:'gzip'}, function(err, data) {}); });
+        var aliased = vtile.getData({alias:true});
+        assert.equal(aliased.toString('hex'), vtile.getData().toString('hex'));
+        var snapshot = aliased.toString('hex');
+        // mutating the tile detaches it; the aliased buffer keeps the
+        // bytes it was created with instead of dangling
+        vtile.setData(fs.readFileSync("./test/data/vector_tile/tile3.mvt"));
+        assert.equal(aliased.toString('hex'), snapshot);
+        vtile.setData(data);
+        vtile.getData({alias:true}, function(err, aliased2) {
+            assert.ifError(err);
+            assert.equal(aliased2.toString('hex'), vtile.getData().toString('hex'));
+            done();
+        });
+    });
+
     it('should be able to getData with a FILTERED', function(done) {
         var vtile = new mapnik.VectorTile(9,112,195);
         var data = fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf");
@@ -2115,6 +2193,8 @@ describe('mapnik.VectorTile ', function() {
         assert.throws(function() { map.render(vtile, {variables:null}, function(err, vtile) {}); });
         assert.throws(function() { map.render(vtile, {threading_mode:99}, function(err, vtile) {}); });
         assert.throws(function() { map.render(vtile, {threading_mode:null}, function(err, vtile) {}); });
+        assert.throws(function() { map.render(vtile, {threads:0}, function(err, vtile) {}); });
+        assert.throws(function() { map.render(vtile, {threads:null}, function(err, vtile) {}); });
         map.render(vtile, {}, function(err, vtile) {
             assert.throws(function() { if (err) throw err; });
             done();
@@ -2163,6 +2243,307 @@ describe('mapnik.VectorTile ', function() {
         });
     });
     
+    it('should generate a tile pyramid in one native pass', function(done) {
+        var vtile = new mapnik.VectorTile(0, 0, 0);
+        vtile.setData(fs.readFileSync('./test/data/vector_tile/tile0.mvt'));
+        assert.throws(function() { vtile.generatePyramid(); });
+        assert.throws(function() { vtile.generatePyramid(0, 1, function(err, tiles) {}); });
+        assert.throws(function() { vtile.generatePyramid(2, 1, function(err, tiles) {}); });
+        assert.throws(function() { vtile.generatePyramid(1, 9, function(err, tiles) {}); });
+        assert.throws(function() { vtile.generatePyramid(1, 2, {concurrency: 0}, function(err, tiles) {}); });
+        vtile.generatePyramid(1, 2, function(err, tiles) {
+            assert.ifError(err);
+            assert.equal(tiles.length, 4 + 16);
+            var z1 = tiles.filter(function(t) { return t.z === 1; });
+            assert.equal(z1.length, 4);
+            // each child buffer must equal the per-child composite result
+            var reference = new mapnik.VectorTile(1, 0, 0);
+            reference.composite([vtile], {});
+            var child = tiles.filter(function(t) { return t.z === 1 && t.x === 0 && t.y === 0; })[0];
+            assert.equal(child.buffer.toString('hex'), reference.getData().toString('hex'));
+            done();
+        });
+    });
+
+    it('should aggregate async timing in mapnik.metrics', function(done) {
+        assert.throws(function() { mapnik.metrics(null); });
+        assert.throws(function() { mapnik.metrics({reset: 1}); });
+        mapnik.metrics({reset: true});
+        var vtile = new mapnik.VectorTile(9,112,195);
+        vtile.setData(fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf"), function(err) {
+            assert.ifError(err);
+            var stats = mapnik.metrics();
+            assert.ok(stats['vtile.setdata']);
+            assert.equal(stats['vtile.setdata'].count, 1);
+            assert.ok(stats['vtile.setdata'].exec_ms_total >= 0);
+            assert.ok(stats['vtile.setdata'].queue_ms_max >= 0);
+            // reset drains the aggregates
+            mapnik.metrics({reset: true});
+            assert.deepEqual(mapnik.metrics(), {});
+            done();
+        });
+    });
+
+    it('should restrict setData to a layer subset', function(done) {
+        var data = fs.readFileSync(path.resolve(__dirname + "/data/vector_tile/tile3.mvt"));
+        var vtile = new mapnik.VectorTile(5,28,12);
+        assert.throws(function() { vtile.setData(data, {layers: 'world'}); });
+        assert.throws(function() { vtile.setData(data, {layers: [1]}); });
+        vtile.setData(data, {layers: ['world']});
+        assert.deepEqual(vtile.names(), ['world']);
+        // unmentioned layers are dropped without being decoded
+        var reference = new mapnik.VectorTile(5,28,12);
+        reference.setData(data);
+        assert.ok(reference.names().length > 1);
+        assert.equal(vtile.layer('world').getData().toString('hex'),
+                     reference.layer('world').getData().toString('hex'));
+        vtile.setData(data, {layers: ['world', 'world2']}, function(err) {
+            assert.ifError(err);
+            assert.deepEqual(vtile.names(), ['world', 'world2']);
+            done();
+        });
+    });
+
+    it('should ingest compressed data through pooled inflate contexts', function(done) {
+        var raw = fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf");
+        var gzipped = zlib.gzipSync(raw);
+        var deflated = zlib.deflateSync(raw);
+        var reference = new mapnik.VectorTile(9,112,195);
+        reference.setData(raw);
+        // repeated compressed ingests reuse pooled z_stream state
+        var vtile = new mapnik.VectorTile(9,112,195);
+        [gzipped, deflated, gzipped].forEach(function(data) {
+            vtile.setData(data);
+            assert.equal(vtile.getData().toString('hex'), reference.getData().toString('hex'));
+        });
+        vtile.setData(gzipped, function(err) {
+            assert.ifError(err);
+            assert.equal(vtile.getData().toString('hex'), reference.getData().toString('hex'));
+            // corrupt compressed input still errors cleanly
+            var truncated = gzipped.slice(0, 20);
+            vtile.setData(truncated, function(err) {
+                assert.ok(err);
+                done();
+            });
+        });
+    });
+
+    it('should serialize toJSON natively into a buffer', function(done) {
+        var vtile = new mapnik.VectorTile(9,112,195);
+        vtile.setData(fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf"));
+        assert.throws(function() { vtile.toJSON({buffer: 1}); });
+        assert.throws(function() { vtile.toJSON({buffer: true, decode_geometry: true}); });
+        var expected = vtile.toJSON();
+        var buf = vtile.toJSON({buffer: true});
+        assert.ok(Buffer.isBuffer(buf));
+        assert.deepEqual(JSON.parse(buf.toString()), JSON.parse(JSON.stringify(expected)));
+        // async form serializes off the event loop
+        vtile.toJSON(function(err, buf2) {
+            assert.ifError(err);
+            assert.deepEqual(JSON.parse(buf2.toString()), JSON.parse(JSON.stringify(expected)));
+            done();
+        });
+    });
+
+    it('should share tile blobs through the shared store', function(done) {
+        if (process.platform === 'win32') return done();
+        assert.throws(function() { mapnik.publishSharedTile(); });
+        assert.throws(function() { mapnik.publishSharedTile('name'); });
+        assert.throws(function() { mapnik.publishSharedTile('bad/name', new Buffer(1)); });
+        assert.throws(function() { mapnik.readSharedTile(12); });
+        var data = fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf");
+        var name = 'test-tile-' + process.pid;
+        assert.equal(mapnik.readSharedTile(name), undefined);
+        assert.equal(mapnik.publishSharedTile(name, data), true);
+        var shared = mapnik.readSharedTile(name);
+        assert.ok(Buffer.isBuffer(shared));
+        assert.equal(shared.toString('hex'), data.toString('hex'));
+        // read paths work unchanged from the mapped bytes
+        var vtile = new mapnik.VectorTile(9,112,195);
+        vtile.setData(shared);
+        assert.ok(vtile.names().length > 0);
+        assert.equal(mapnik.removeSharedTile(name), true);
+        assert.equal(mapnik.removeSharedTile(name), false);
+        assert.equal(mapnik.readSharedTile(name), undefined);
+        done();
+    });
+
+    it('should recycle tile objects through the pool', function(done) {
+        assert.throws(function() { mapnik.VectorTile.pool(null); });
+        assert.throws(function() { mapnik.VectorTile.pool({size: -1}); });
+        // disabled by default: release clears but does not park
+        mapnik.VectorTile.pool({size: 0});
+        var vtile = new mapnik.VectorTile(9,112,195);
+        vtile.setData(fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf"));
+        assert.equal(vtile.release(), false);
+        var config = mapnik.VectorTile.pool({size: 4});
+        assert.equal(config.size, 4);
+        vtile.setData(fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf"));
+        assert.equal(vtile.release(), true);
+        // the wrapper stays usable as an empty tile at the same coords
+        assert.equal(vtile.getData().length, 0);
+        assert.equal(vtile.x, 112);
+        assert.equal(mapnik.VectorTile.pool().available, 1);
+        // the next construction reuses the parked tile
+        var vtile2 = new mapnik.VectorTile(1, 0, 0);
+        assert.equal(mapnik.VectorTile.pool().available, 0);
+        assert.equal(vtile2.z, 1);
+        assert.equal(vtile2.getData().length, 0);
+        vtile2.setData(fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf"));
+        assert.ok(vtile2.names().length > 0);
+        // aliased storage blocks recycling
+        var vtile3 = new mapnik.VectorTile(9,112,195);
+        vtile3.setData(fs.readFileSync("./test/data/vector_tile/tile1.vector.pbf"));
+        var aliased = vtile3.getData({alias: true});
+        assert.equal(vtile3.release(), false);
+        assert.ok(aliased.length > 0);
+        mapnik.VectorTile.pool({size: 0});
+        done();
+    });
+
+    it('should add geojson asynchronously', function(done) {
+        var geojson = {
+            "type": "FeatureCollection",
+            "features": [
+                { "type": "Feature", "geometry": { "type": "Point", "coordinates": [-122, 48] }, "properties": { "name": "geojson data" } }
+            ]
+        };
+        var sync_tile = new mapnik.VectorTile(0,0,0);
+        sync_tile.addGeoJSON(JSON.stringify(geojson), "layer-name");
+        var vtile = new mapnik.VectorTile(0,0,0);
+        assert.throws(function() { vtile.addGeoJSON(12, "layer-name", function(err) {}); });
+        // Buffer input and callback form run the parse and encode off loop
+        vtile.addGeoJSON(new Buffer(JSON.stringify(geojson)), "layer-name", function(err) {
+            assert.ifError(err);
+            assert.equal(vtile.getData().toString('hex'), sync_tile.getData().toString('hex'));
+            vtile.addGeoJSON('not geojson', "layer-name", function(err) {
+                assert.ok(err);
+                done();
+            });
+        });
+    });
+
+    it('should report geometry validity with a layer filter', function(done) {
+        if (!hasBoostSimple) return done();
+        var vtile = new mapnik.VectorTile(5,28,12);
+        vtile.setData(fs.readFileSync(path.resolve(__dirname + "/data/vector_tile/tile3.mvt")));
+        assert.throws(function() { vtile.reportGeometryValiditySync({layer: 12}); });
+        assert.throws(function() { vtile.reportGeometrySimplicitySync({layer: 12}); });
+        var all = vtile.reportGeometryValiditySync();
+        var world = vtile.reportGeometryValiditySync({layer: 'world'});
+        var none = vtile.reportGeometryValiditySync({layer: 'doesnotexist'});
+        assert.equal(none.length, 0);
+        assert.ok(world.length <= all.length);
+        world.forEach(function(err) { assert.equal(err.layer, 'world'); });
+        assert.deepEqual(vtile.reportGeometrySimplicitySync({layer: 'doesnotexist'}), []);
+        vtile.reportGeometryValidity({layer: 'world'}, function(err, report) {
+            assert.ifError(err);
+            assert.equal(report.length, world.length);
+            vtile.reportGeometrySimplicity({layer: 'world'}, function(err, simple) {
+                assert.ifError(err);
+                assert.ok(Array.isArray(simple));
+                done();
+            });
+        });
+    });
+
+    it('should accept render priorities and threadPool configuration', function(done) {
+        assert.throws(function() { mapnik.threadPool(null); });
+        assert.throws(function() { mapnik.threadPool({concurrency: 0}); });
+        var config = mapnik.threadPool({concurrency: 2});
+        assert.equal(config.concurrency, 2);
+        assert.equal(mapnik.threadPool().concurrency, 2);
+        var vtile = new mapnik.VectorTile(0, 0, 0);
+        vtile.setData(fs.readFileSync('./test/data/vector_tile/tile0.mvt'));
+        var map = new mapnik.Map(256, 256);
+        map.loadSync('./test/stylesheet.xml');
+        map.extent = [-20037508.34, -20037508.34, 20037508.34, 20037508.34];
+        assert.throws(function() { vtile.render(map, new mapnik.Image(256,256), {priority: 'urgent'}, function(err, im) {}); });
+        assert.throws(function() { vtile.render(map, new mapnik.Image(256,256), {priority: 1}, function(err, im) {}); });
+        var remaining = 3;
+        ['high', 'normal', 'low'].forEach(function(priority) {
+            vtile.render(map, new mapnik.Image(256, 256), {priority: priority}, function(err, im) {
+                if (err) throw err;
+                assert.ok(im instanceof mapnik.Image);
+                if (--remaining === 0) {
+                    mapnik.threadPool({concurrency: 4});
+                    done();
+                }
+            });
+        });
+    });
+
+    it('should report render stats when requested', function(done) {
+        var vtile = new mapnik.VectorTile(0, 0, 0);
+        vtile.setData(fs.readFileSync('./test/data/vector_tile/tile0.mvt'));
+        var map = new mapnik.Map(256, 256);
+        map.loadSync('./test/stylesheet.xml');
+        map.extent = [-20037508.34, -20037508.34, 20037508.34, 20037508.34];
+        assert.throws(function() { vtile.render(map, new mapnik.Image(256,256), {stats: 1}, function(err, im) {}); });
+        vtile.render(map, new mapnik.Image(256, 256), {stats: true}, function(err, im, stats) {
+            if (err) throw err;
+            assert.ok(stats);
+            assert.equal(typeof stats.render_ms, 'number');
+            assert.ok(stats.render_ms >= 0);
+            assert.equal(typeof stats.layers, 'object');
+            assert.ok(Object.keys(stats.layers).length >= 1);
+            // without the option the callback keeps its historical arity
+            vtile.render(map, new mapnik.Image(256, 256), {}, function(err, im2, stats2) {
+                if (err) throw err;
+                assert.equal(stats2, undefined);
+                done();
+            });
+        });
+    });
+
+    it('should composite, render and encode in one fused call', function(done) {
+        var vtile = new mapnik.VectorTile(0, 0, 0);
+        vtile.setData(fs.readFileSync('./test/data/vector_tile/tile0.mvt'));
+        var map = new mapnik.Map(256, 256);
+        map.loadSync('./test/stylesheet.xml');
+        map.extent = [-20037508.34, -20037508.34, 20037508.34, 20037508.34];
+        assert.throws(function() { vtile.renderToBuffer(); });
+        assert.throws(function() { vtile.renderToBuffer(map); });
+        assert.throws(function() { vtile.renderToBuffer({}, function(err, buffer) {}); });
+        assert.throws(function() { vtile.renderToBuffer(map, {format: 1}, function(err, buffer) {}); });
+        assert.throws(function() { vtile.renderToBuffer(map, {sources: 'nope'}, function(err, buffer) {}); });
+        assert.throws(function() { vtile.renderToBuffer(map, {width: 0}, function(err, buffer) {}); });
+        // the fused output must match the chained render + encode path
+        vtile.render(map, new mapnik.Image(256, 256), function(err, im) {
+            if (err) throw err;
+            var expected = im.encodeSync('png');
+            vtile.renderToBuffer(map, {format: 'png'}, function(err, buffer) {
+                assert.ifError(err);
+                assert.ok(Buffer.isBuffer(buffer));
+                var a = new mapnik.Image.fromBytesSync(buffer);
+                var b = new mapnik.Image.fromBytesSync(expected);
+                assert.equal(a.compare(b), 0);
+                // empty target + sources composites first, then renders
+                var target = new mapnik.VectorTile(0, 0, 0);
+                target.renderToBuffer(map, {sources: [vtile], format: 'png'}, function(err, buffer2) {
+                    assert.ifError(err);
+                    var c = new mapnik.Image.fromBytesSync(buffer2);
+                    assert.equal(c.compare(b), 0);
+                    done();
+                });
+            });
+        });
+    });
+
+    it('should render a vector_tile of the whole world with threads option', function(done) {
+        var vtile = new mapnik.VectorTile(0, 0, 0);
+        var map = new mapnik.Map(256, 256);
+        map.loadSync('./test/stylesheet.xml');
+        map.extent = [-20037508.34, -20037508.34, 20037508.34, 20037508.34];
+        map.render(vtile, {threads: 4}, function(err, vtile) {
+            if (err) throw err;
+            var reference = new mapnik.VectorTile(0, 0, 0);
+            reference.setData(fs.readFileSync('./test/data/vector_tile/tile0.mvt'));
+            assert.equal(JSON.stringify(vtile.toJSON({decode_geometry:true})) == JSON.stringify(reference.toJSON({decode_geometry:true})), true);
+            done();
+        });
+    });
+
     it('should render a vector_tile of the whole world with threading auto', function(done) {
         var vtile = new mapnik.VectorTile(0, 0, 0);
         var map = new mapnik.Map(256, 256);